@@ -34,6 +34,9 @@
 #include <servicelog-1/servicelog.h>
 #include "config.h"
 #include "platform.h"
+#include "slog_index.h"
+#include "slog_recent.h"
+#include "slog_subscriber.h"
 
 #define BUF_SIZE	512
 
@@ -77,6 +80,71 @@ print_usage(char *command) {
 	return;
 }
 
+/**
+ * log_repair
+ * @brief Log a repair action and count the events it closed
+ *
+ * libservicelog returns the closed events as a list; it is published
+ * to the ring of recent events, printed to fp if one is given, and
+ * always freed here rather than left until exit.  The repair action is
+ * then pushed to the socket subscribers, which libservicelog does not
+ * notify, and the indexes of slog_index.c are created if they are
+ * missing.
+ *
+ * @param cmd the name of the command (argv[0] in main)
+ * @param servlog open servicelog
+ * @param ra repair action to log
+ * @param id returned id of the repair action
+ * @param count returned number of events closed
+ * @param fp stream to print the closed events to, or NULL
+ * @return 0 on success, non-zero on failure (see servicelog_error())
+ */
+static int
+log_repair(char *cmd, struct servicelog *servlog,
+	   struct sl_repair_action *ra, uint64_t *id, uint64_t *count,
+	   FILE *fp)
+{
+	struct sl_event *events = NULL, *e;
+	struct slog_notify_result result;
+	char err[SL_MAX_ERR];
+	int64_t committed;
+	int rc;
+
+	*count = 0;
+	/* committed inside the call, before it runs the notification tools */
+	committed = slog_notify_stats_usec();
+	rc = servicelog_repair_log(servlog, ra, id, &events);
+	if (rc != 0)
+		return rc;
+
+	for (e = events; e; e = e->next) {
+		e->closed = 1;
+		e->repair = *id;
+		(*count)++;
+	}
+	slog_recent_publish(events);
+	if (fp) {
+		fprintf(fp, "%s: servicelog record ID =""%" PRIu64 ".\n",
+			cmd, *id);
+		fprintf(fp, "\nThe following events were repaired:\n\n");
+		servicelog_event_print(fp, events, 0);
+	}
+	if (events)
+		servicelog_event_free(events);
+
+	if (slog_subscriber_logged(servlog, SL_NOTIFY_REPAIRS, *id, committed,
+				   &result) != 0 && fp)
+		fprintf(stderr, "%s: %s\n", cmd, result.error);
+
+	/* the servicelog may not have existed when the package installed */
+	if (slog_index_present(servlog) == 0 &&
+	    slog_index_ensure(servlog, err, sizeof(err)) != 0 && fp)
+		fprintf(stderr, "%s: Could not create the indexes: %s\n",
+			cmd, err);
+
+	return 0;
+}
+
 /**
  * main
  * @brief parse cmd line options and log repair action
@@ -91,10 +159,9 @@ main(int argc, char *argv[])
 	int option_index, quiet=0;
 	char *date = NULL, *dummy;
 	char buf[BUF_SIZE], tmp_system_arg[(BUF_SIZE/2)];
-	uint64_t id;
+	uint64_t id, count;
 	struct servicelog *servlog;
 	struct sl_repair_action repair_action, *ra = &repair_action;
-	struct sl_event *events = NULL;
 	time_t epoch;
 	pid_t cpid;	/* Pid of child		*/
 	int rc;		/* Holds return value	*/
@@ -325,16 +392,12 @@ main(int argc, char *argv[])
 		return 2;
 	}
 
-	rc = servicelog_repair_log(servlog, ra, &id, &events);
+	rc = log_repair(argv[0], servlog, ra, &id, &count,
+			quiet ? NULL : stdout);
 	if (rc == 0) {
-		if (!quiet) {
-			fprintf(stdout, "%s: servicelog record ID =""%" PRIu64 ".\n",
-				argv[0], id);
-			fprintf(stdout, "\nThe following events were "
-				"repaired:\n\n");
-			servicelog_event_print(stdout, events, 0);
-			servicelog_event_free(events);
-		}
+		if (!quiet)
+			fprintf(stdout, "\n%s: %" PRIu64 " events were "
+				"repaired.\n", argv[0], count);
 	} else {
 		if (!quiet)
 			fprintf(stderr, "%s: Could not log the repair action."
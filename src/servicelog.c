@@ -23,18 +23,58 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <limits.h>
 #define _GNU_SOURCE
 #include <getopt.h>
 #include <inttypes.h>
+#include <time.h>
+#include <unistd.h>
 #include <servicelog-1/servicelog.h>
 #include "config.h"
 #include "platform.h"
+#include "slog_stats.h"
+#include "slog_snapshot.h"
+#include "slog_cursor.h"
+#include "slog_output.h"
+#include "slog_pipeline.h"
+#include "slog_diff.h"
+#include "slog_budget.h"
+#include "slog_query.h"
+#include "slog_incident.h"
+#include "slog_index.h"
+#include "slog_recent.h"
+#include "slog_filter.h"
+#include "slog_bitmap.h"
+#include "slog_select.h"
+#include "slog_hot.h"
 
 static char *cmd;
 
+#define DAY		(24 * 60 * 60)
+
+/* Entries in each most-frequent list of --analyze */
+#define ANALYZE_TOP	10
+
 static struct option long_options[] = {
 	{"query",	    required_argument, NULL, 'q'},
 	{"dump",	    no_argument,       NULL, 'd'},
+	{"export-snapshot", required_argument, NULL, 'x'},
+	{"snapshot",	    required_argument, NULL, 'n'},
+	{"export",	    no_argument,       NULL, 'X'},
+	{"cursor-file",	    required_argument, NULL, 'C'},
+	{"compress",	    required_argument, NULL, 'z'},
+	{"jobs",	    required_argument, NULL, 'j'},
+	{"diff",	    no_argument,       NULL, 'D'},
+	{"timeout",	    required_argument, NULL, 'T'},
+	{"max-rows",	    required_argument, NULL, 'M'},
+	{"incidents",	    no_argument,       NULL, 'I'},
+	{"open",	    no_argument,       NULL, 'O'},
+	{"location",	    required_argument, NULL, 'L'},
+	{"ids",		    required_argument, NULL, 'N'},
+	{"ids-from",	    required_argument, NULL, 'F'},
+	{"recent",	    optional_argument, NULL, 'W'},
+	{"analyze",	    required_argument, NULL, 'A'},
 	{"help",	    no_argument,       NULL, 'h'},
 	{"verbose",	    no_argument,       NULL, 'v'},
 	{"version",	    no_argument,       NULL, 'V'},
@@ -50,7 +90,21 @@ static struct option long_options[] = {
 static void
 print_usage(char *cmd) 
 {
-	printf("Usage: %s {[--dump] | [--query='<query>']} [-vVh]\n", cmd);
+	printf("Usage: %s {[--dump] | [--query='<query>'] | [--open]} [-vVh]\n",
+	       cmd);
+	printf("       %s {--dump | --query='<query>'} [--timeout=<ms>] "
+	       "[--max-rows=<n>]\n", cmd);
+	printf("       %s [--query='<query>'] --export-snapshot=<file>\n", cmd);
+	printf("       %s --snapshot=<file> [--query='<filter>' | --open]\n",
+	       cmd);
+	printf("       %s --export [--cursor-file=<file>]\n", cmd);
+	printf("       %s --diff {<snapshot> <snapshot> | "
+	       "--cursor-file=<file>}\n", cmd);
+	printf("       %s --incidents\n", cmd);
+	printf("       %s --location=<prefix>\n", cmd);
+	printf("       %s {--ids=<list> | --ids-from=<file>}\n", cmd);
+	printf("       %s --recent[=<n>{s|m|h|d|w}]\n", cmd);
+	printf("       %s --analyze=<file>\n", cmd);
 	printf("  Without any command-line arguments, prints the statistics\n");
 	printf("  of the current servicelog database contents.\n\n");
 
@@ -58,7 +112,63 @@ print_usage(char *cmd)
 	printf("                     servicelog database.\n");
 	printf("  --query='<query>'  Prints all of the events that match the\n");
 	printf("                     query string. <query> is formatted like\n");
-	printf("                     the WHERE clause of an SQL statement\n");
+	printf("                     the WHERE clause of an SQL statement,\n");
+	printf("                     and may compare a time column with\n");
+	printf("                     now[-+]<n>{s|m|h|d|w}, or use\n");
+	printf("                     '<column> within <n>{s|m|h|d|w}'\n");
+	printf("  --open             Prints all of the open (unfixed)\n");
+	printf("                     serviceable events\n");
+	printf("  --location=<prefix>\n");
+	printf("                     Prints all of the events with a callout,\n");
+	printf("                     and all of the repair actions, at or\n");
+	printf("                     under the location code <prefix>\n");
+	printf("  --ids=<list>       Prints the events with the ids in <list>,\n");
+	printf("                     e.g., 12,15,40-49, in that order\n");
+	printf("  --ids-from=<file>  Like --ids, with the ids and ranges read\n");
+	printf("                     from <file> (- for stdin)\n");
+	printf("  --recent[=<n>{s|m|h|d|w}]\n");
+	printf("                     Prints the events logged or closed\n");
+	printf("                     recently (in the last <n> units), from\n");
+	printf("                     shared memory, without opening the\n");
+	printf("                     servicelog database\n");
+	printf("  --analyze=<file>   Prints the statistics, events by day, and\n");
+	printf("                     most frequent reference codes and\n");
+	printf("                     locations of the last %d days, from a\n",
+	       SLOG_HOT_WINDOW / DAY);
+	printf("                     cache in <file> that is brought up to\n");
+	printf("                     date first\n");
+	printf("  --export-snapshot=<file>\n");
+	printf("                     Writes all of the events, or those that\n");
+	printf("                     match --query, to a binary snapshot file\n");
+	printf("  --snapshot=<file>  Prints the statistics of a snapshot file\n");
+	printf("                     written by --export-snapshot\n");
+	printf("                     (with --query or --open, of the events\n");
+	printf("                     matching a filter over type, severity,\n");
+	printf("                     serviceable, closed and the times)\n");
+	printf("  --export           Prints all of the events and repair\n");
+	printf("                     actions in the servicelog database\n");
+	printf("  --cursor-file=<file>\n");
+	printf("                     With --export, prints only what was\n");
+	printf("                     added or changed since the position\n");
+	printf("                     saved in <file>, then updates <file>\n");
+	printf("  --compress={gzip|zstd}\n");
+	printf("                     Compresses the output of --dump, --query,\n");
+	printf("                     --ids or --export\n");
+	printf("  --diff             Prints the events added, closed and\n");
+	printf("                     removed between two snapshot files,\n");
+	printf("                     or added and closed since the position\n");
+	printf("                     saved in a --cursor-file\n");
+	printf("  --jobs=<n>         Fetches and formats the events of --dump\n");
+	printf("                     or --query in <n> worker processes\n");
+	printf("  --incidents        Groups the events that call out the same\n");
+	printf("                     unit and drawer within %d minutes of\n",
+	       INCIDENT_WINDOW / 60);
+	printf("                     each other, and prints the incidents\n");
+	printf("  --timeout=<ms>     Stops --dump, --query or --export-snapshot\n");
+	printf("                     if the query runs longer than <ms>\n");
+	printf("                     milliseconds\n");
+	printf("  --max-rows=<n>     Stops --dump, --query or --export-snapshot\n");
+	printf("                     if more than <n> events match\n");
 // Don't advertise -v.  It doesn't do anything, but it might be used by
 // Director or some such.
 //	printf("  --verbose | -v     Verbose output\n");
@@ -74,21 +184,634 @@ print_usage(char *cmd)
 	printf("        prints all open events with a sev of WARNING or greater\n");
 	printf("    servicelog --query=\"time_event>'2008-02-08'\"\n");
 	printf("        prints all events that occurred after Feb 08, 2008\n");
+	printf("    servicelog --query='time_event > now-1h'\n");
+	printf("        prints all events that occurred in the last hour\n");
+	printf("    servicelog --query='time_logged within 7d AND closed=0'\n");
+	printf("        prints all open events logged in the last week\n");
 
 	return;
 }
 
-void
-check_event(struct sl_event *e, int *open, int *close, int *info)
+/**
+ * print_snapshot_stats
+ * @brief Print the statistics of a snapshot written by --export-snapshot
+ *
+ * Only the mapped columns are touched; no event is materialized.
+ *
+ * @param path snapshot file
+ * @return 0 on success, 2 on failure
+ */
+static int
+print_snapshot_stats(const char *path)
 {
-	if (e->serviceable) {
-		if (e->closed)
-			(*close)++;
-		else
-			(*open)++;
+	struct slog_snapshot snap;
+	struct slog_stats stats;
+	uint64_t sev[SL_SEV_FATAL + 1], i;
+	int64_t first = 0, last = 0;
+	char buf[32];
+	int s;
+
+	if (slog_snapshot_open(path, &snap) != 0) {
+		fprintf(stderr, "%s\n", snap.error);
+		return 2;
 	}
+
+	memset(&stats, 0, sizeof(stats));
+	memset(sev, 0, sizeof(sev));
+
+	for (i = 0; i < snap.nrows; i++) {
+		if (slog_stats_add(&stats, snap.type[i], snap.serviceable[i],
+				   snap.closed[i]) < 0)
+			fprintf(stderr, "Event ""%" PRIu64 "has unknown type "
+				"%d\n", snap.id[i], snap.type[i]);
+		if (snap.severity[i] <= SL_SEV_FATAL)
+			sev[snap.severity[i]]++;
+		if (i == 0 || snap.time_event[i] < first)
+			first = snap.time_event[i];
+		if (i == 0 || snap.time_event[i] > last)
+			last = snap.time_event[i];
+	}
+
+	printf("Servicelog Snapshot Statistics:\n\n");
+	if (snap.nrows) {
+		time_t t = first;
+
+		strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", localtime(&t));
+		printf("First Event: %s\n", buf);
+		t = last;
+		strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", localtime(&t));
+		printf("Last Event:  %s\n\n", buf);
+	}
+
+	slog_stats_print(stdout, &stats);
+
+	printf("Events by Severity:\n\n");
+	for (s = SL_SEV_FATAL; s >= SL_SEV_DEBUG; s--)
+		if (sev[s])
+			printf("  %11s %7" PRIu64 "\n", slog_sev_name(s),
+			       sev[s]);
+	printf("\n");
+
+	slog_snapshot_close(&snap);
+	return 0;
+}
+
+/**
+ * count_scanned
+ * @brief Count the events of a snapshot that match any filter
+ *
+ * The mapped columns are evaluated SLOG_SELECT_BATCH rows at a time,
+ * and only the selected rows are counted.
+ *
+ * @param snap mapped snapshot
+ * @param filter compiled filter
+ * @param stats returned counts by type
+ * @param sev returned counts by severity
+ */
+static void
+count_scanned(struct slog_snapshot *snap, struct slog_filter *filter,
+	      struct slog_stats *stats, uint64_t *sev)
+{
+	struct slog_batch batch;
+	uint16_t sel[SLOG_SELECT_BATCH];
+	uint64_t row, i;
+	size_t k, n;
+
+	for (row = 0; row < snap->nrows; row += batch.n) {
+		batch.n = snap->nrows - row;
+		if (batch.n > SLOG_SELECT_BATCH)
+			batch.n = SLOG_SELECT_BATCH;
+		batch.type = snap->type + row;
+		batch.severity = snap->severity + row;
+		batch.serviceable = snap->serviceable + row;
+		batch.closed = snap->closed + row;
+		batch.time_logged = snap->time_logged + row;
+		batch.time_event = snap->time_event + row;
+
+		n = slog_select(filter, &batch, sel);
+		for (k = 0; k < n; k++) {
+			i = row + sel[k];
+			slog_stats_add(stats, snap->type[i], snap->serviceable[i],
+				       snap->closed[i]);
+			if (snap->severity[i] <= SL_SEV_FATAL)
+				sev[snap->severity[i]]++;
+		}
+	}
+}
+
+/**
+ * print_snapshot_counts
+ * @brief Count the events of a snapshot that match a filter
+ *
+ * A filter over type, severity, serviceable and closed is answered from
+ * the value bitmaps of the snapshot; any other filter, or a snapshot
+ * written without bitmaps, is evaluated over batches of the mapped
+ * columns, which are not copied.
+ *
+ * @param path snapshot file
+ * @param query filter over the fixed-width columns
+ * @return 0 on success, 1 if the query cannot be used, 2 on failure
+ */
+static int
+print_snapshot_counts(const char *path, const char *query)
+{
+	struct slog_snapshot snap;
+	struct slog_stats stats;
+	struct slog_filter filter;
+	uint64_t sev[SL_SEV_FATAL + 1];
+	char err[SL_MAX_ERR];
+	int s;
+
+	if (slog_filter_parse(query, &filter, err, sizeof(err)) != 0) {
+		fprintf(stderr, "%s: %s\n", cmd, err);
+		fprintf(stderr, "With --snapshot, --query can only compare "
+			"type, severity, serviceable, closed, time_logged "
+			"and time_event.\n\n");
+		print_usage(cmd);
+		return 1;
+	}
+
+	if (slog_snapshot_open(path, &snap) != 0) {
+		fprintf(stderr, "%s\n", snap.error);
+		return 2;
+	}
+
+	memset(&stats, 0, sizeof(stats));
+	memset(sev, 0, sizeof(sev));
+
+	if (slog_bitmap_usable(&snap, &filter))
+		slog_bitmap_count(&snap, &filter, &stats, sev);
+	else
+		count_scanned(&snap, &filter, &stats, sev);
+
+	printf("Servicelog Snapshot Statistics for \"%s\":\n\n", query);
+	slog_stats_print(stdout, &stats);
+
+	printf("Events by Severity:\n\n");
+	for (s = SL_SEV_FATAL; s >= SL_SEV_DEBUG; s--)
+		if (sev[s])
+			printf("  %11s %7" PRIu64 "\n", slog_sev_name(s),
+			       sev[s]);
+	printf("\n");
+
+	slog_snapshot_close(&snap);
+	return 0;
+}
+
+/**
+ * export_records
+ * @brief Print the events and repair actions past an export cursor
+ *
+ * The cursor file is only updated once everything has been written
+ * out, so an export that fails part way is repeated by the next run.
+ *
+ * @param slog open servicelog
+ * @param cursor_file file holding the export position, or NULL to
+ *		      export everything
+ * @param out output stream; closed before the cursor file is updated
+ * @return 0 on success, 2 on failure
+ */
+static int
+export_records(servicelog *slog, char *cursor_file, struct slog_output *out)
+{
+	struct slog_cursor cursor;
+	struct sl_event *events = NULL;
+	struct sl_repair_action *repairs = NULL;
+	char query[256], err[SL_MAX_ERR];
+	int rc = 2;
+
+	memset(&cursor, 0, sizeof(cursor));
+	if (cursor_file) {
+		if (slog_cursor_read(cursor_file, &cursor, err,
+				     sizeof(err)) != 0) {
+			fprintf(stderr, "%s\n", err);
+			return 2;
+		}
+	}
+
+	slog_cursor_event_query(&cursor, query, sizeof(query));
+	if (servicelog_event_query(slog, query, &events) != 0) {
+		fprintf(stderr, "%s\n", servicelog_error(slog));
+		goto out;
+	}
+
+	if (cursor.repair_id)
+		snprintf(query, sizeof(query), "id>%" PRIu64, cursor.repair_id);
 	else
-		(*info)++;
+		query[0] = '\0';
+	if (servicelog_repair_query(slog, query, &repairs) != 0) {
+		fprintf(stderr, "%s\n", servicelog_error(slog));
+		goto out;
+	}
+
+	if ((events && servicelog_event_print(out->fp, events, 1) < 0) ||
+	    (repairs && servicelog_repair_print(out->fp, repairs, 1) < 0)) {
+		fprintf(stderr, "%s: Could not write the export: %s\n", cmd,
+			strerror(errno));
+		goto out;
+	}
+	if (slog_output_close(out) != 0) {
+		fprintf(stderr, "%s: Could not write the export: %s\n", cmd,
+			out->error);
+		goto out;
+	}
+
+	if (cursor_file) {
+		slog_cursor_advance(&cursor, events, repairs);
+		if (slog_cursor_write(cursor_file, &cursor, err,
+				      sizeof(err)) != 0) {
+			fprintf(stderr, "%s\n", err);
+			goto out;
+		}
+	}
+	rc = 0;
+
+out:
+	slog_output_close(out);
+	if (events)
+		servicelog_event_free(events);
+	if (repairs)
+		servicelog_repair_free(repairs);
+	return rc;
+}
+
+/**
+ * print_location
+ * @brief Print the events and repair actions at or under a location
+ *
+ * @param slog open servicelog
+ * @param prefix location code of a unit, drawer, slot, ...
+ * @return 0 on success, 2 on failure
+ */
+static int
+print_location(servicelog *slog, const char *prefix)
+{
+	struct sl_event *events = NULL;
+	struct sl_repair_action *repairs = NULL;
+	char match[640], query[768];
+	int rc = 2;
+
+	if (slog_query_location("location", prefix, match,
+				sizeof(match)) != 0) {
+		fprintf(stderr, "%s: Location code too long\n", cmd);
+		return 2;
+	}
+
+	snprintf(query, sizeof(query), "id IN (SELECT event_id FROM callouts "
+		 "WHERE %s)", match);
+	if (servicelog_event_query(slog, query, &events) != 0 ||
+	    servicelog_repair_query(slog, match, &repairs) != 0) {
+		fprintf(stderr, "%s\n", servicelog_error(slog));
+		goto out;
+	}
+
+	if (events)
+		servicelog_event_print(stdout, events, 1);
+	if (repairs)
+		servicelog_repair_print(stdout, repairs, 1);
+	rc = 0;
+
+out:
+	if (events)
+		servicelog_event_free(events);
+	if (repairs)
+		servicelog_repair_free(repairs);
+	return rc;
+}
+
+static int
+compare_event_ids(const void *a, const void *b)
+{
+	uint64_t x = (*(struct sl_event * const *)a)->id;
+	uint64_t y = (*(struct sl_event * const *)b)->id;
+
+	return (x > y) - (x < y);
+}
+
+/**
+ * print_ids
+ * @brief Print a list of events in the order their ids were requested
+ *
+ * All of the events are fetched by one query through a temporary id
+ * table, then relinked in the requested order; an id requested twice
+ * is printed once, at its first position.
+ *
+ * @param slog open servicelog
+ * @param ids requested ids
+ * @param fp output stream
+ * @return 0 on success, 2 on failure or if an event was not found
+ */
+static int
+print_ids(servicelog *slog, struct slog_ids *ids, FILE *fp)
+{
+	struct sl_event *events = NULL, *e, **sorted = NULL, **found;
+	struct sl_event *head = NULL, **tail = &head;
+	size_t n = 0, i;
+	char *printed = NULL;
+	int rc = 2, missing = 0;
+
+	if (slog_query_ids(slog, ids) != 0) {
+		fprintf(stderr, "%s: %s\n", cmd, sqlite3_errmsg(slog->db));
+		return 2;
+	}
+	if (servicelog_event_query(slog, SLOG_QUERY_IDS, &events) != 0) {
+		fprintf(stderr, "%s\n", servicelog_error(slog));
+		return 2;
+	}
+
+	for (e = events; e; e = e->next)
+		n++;
+	sorted = malloc((n ? n : 1) * sizeof(*sorted));
+	printed = calloc(n ? n : 1, 1);
+	if (sorted == NULL || printed == NULL) {
+		fprintf(stderr, "%s: Out of memory\n", cmd);
+		goto out;
+	}
+	for (e = events, i = 0; e; e = e->next)
+		sorted[i++] = e;
+	qsort(sorted, n, sizeof(*sorted), compare_event_ids);
+
+	for (i = 0; i < ids->n; i++) {
+		struct sl_event key, *k = &key;
+
+		key.id = ids->id[i];
+		found = bsearch(&k, sorted, n, sizeof(*sorted),
+				compare_event_ids);
+		if (found == NULL) {
+			fprintf(stderr, "%s: Event %" PRIu64 " not found\n",
+				cmd, ids->id[i]);
+			missing = 1;
+			continue;
+		}
+		if (printed[found - sorted])
+			continue;
+		printed[found - sorted] = 1;
+		*tail = *found;
+		tail = &(*found)->next;
+	}
+	/* every event fetched was requested, so all of them are relinked */
+	*tail = NULL;
+	events = head;
+
+	if (events && servicelog_event_print(fp, events, 1) < 0) {
+		fprintf(stderr, "%s\n", servicelog_error(slog));
+		goto out;
+	}
+	rc = missing ? 2 : 0;
+
+out:
+	free(sorted);
+	free(printed);
+	if (events)
+		servicelog_event_free(events);
+	return rc;
+}
+
+/**
+ * print_recent
+ * @brief Print the events in the ring of recent events
+ *
+ * The ring is read without opening the database.  Each line is an
+ * event as it was logged, or closed by a repair action, oldest first.
+ *
+ * @param age only print what happened in the last age seconds, if > 0
+ * @return 0 on success, 2 on failure
+ */
+static int
+print_recent(long long age)
+{
+	struct slog_recent_event *events;
+	uint64_t dropped, missed = 0;
+	size_t n, i;
+	char err[SL_MAX_ERR], buf[32];
+	time_t when;
+
+	if (slog_recent_read(age > 0 ? (int64_t)time(NULL) - age : 0, &events,
+			     &n, &dropped, err, sizeof(err)) != 0) {
+		fprintf(stderr, "%s: %s\n", cmd, err);
+		return 2;
+	}
+
+	printf("%-6s %10s  %-19s  %-9s %-11s %-10s %s\n\n", "Change", "ID",
+	       "Time", "Type", "Severity", "Refcode", "Description");
+	for (i = 0; i < n; i++) {
+		when = events[i].published;
+		strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S",
+			 localtime(&when));
+		printf("%-6s %10" PRIu64 "  %s  %-9s %-11s %-10s %s\n",
+		       events[i].closed ? "Closed" : "Logged", events[i].id,
+		       buf, slog_type_name(events[i].type),
+		       slog_sev_name(events[i].severity), events[i].refcode,
+		       events[i].description);
+		/* overwritten while the ring was read */
+		if (i > 0)
+			missed += events[i].seq - events[i - 1].seq - 1;
+	}
+
+	if (missed)
+		printf("\n%" PRIu64 " changes between these were overwritten "
+		       "while reading\n", missed);
+	if (dropped)
+		printf("\n%" PRIu64 " changes since boot could not be added "
+		       "to the ring; use --query\n", dropped);
+
+	free(events);
+	return 0;
+}
+
+/**
+ * print_top
+ * @brief Print the most frequent values of a cached column
+ */
+static void
+print_top(struct slog_hot *hot, int64_t since, int column, const char *title)
+{
+	struct slog_hot_count top[ANALYZE_TOP];
+	size_t n, i;
+
+	n = slog_hot_top(hot, since, column, top, ANALYZE_TOP);
+	if (n == 0)
+		return;
+
+	printf("%s:\n\n", title);
+	for (i = 0; i < n; i++)
+		printf("  %7" PRIu64 "  %s\n", top[i].count,
+		       hot->dict[column].str[top[i].code]);
+	printf("\n");
+}
+
+/**
+ * print_analysis
+ * @brief Print reports over the recent events, from a columnar cache
+ *
+ * The cache is refreshed with the events logged or changed since it was
+ * last written, and saved, before the reports are computed from it.
+ *
+ * @param path cache file
+ * @return 0 on success, 2 on failure
+ */
+static int
+print_analysis(const char *path)
+{
+	static const char *sev_title[SL_SEV_FATAL + 1] = {
+		"", "Debug", "Info", "Event", "Warning", "Local", "Error",
+		"Fatal"
+	};
+	struct slog_hot hot;
+	struct slog_stats stats;
+	uint64_t sev[SL_SEV_FATAL + 1], *counts, total;
+	time_t now = time(NULL), t;
+	struct tm tm, day;
+	size_t days, d;
+	servicelog *slog;
+	char buf[32];
+	int rc, s;
+
+	if (slog_hot_load(path, &hot) != 0) {
+		fprintf(stderr, "%s: %s\n", cmd, hot.error);
+		return 2;
+	}
+
+	rc = servicelog_open(&slog, 0);
+	if (rc) {
+		fprintf(stderr, "Error opening servicelog: %s\n", strerror(rc));
+		slog_hot_free(&hot);
+		return 2;
+	}
+	rc = slog_hot_refresh(&hot, slog, now);
+	servicelog_close(slog);
+	if (rc != 0 || slog_hot_save(path, &hot) != 0) {
+		fprintf(stderr, "%s: %s\n", cmd, hot.error);
+		slog_hot_free(&hot);
+		return 2;
+	}
+
+	/* the histogram starts at midnight of the first day in the window */
+	t = now - hot.window;
+	localtime_r(&t, &tm);
+	tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
+	tm.tm_isdst = -1;
+	t = mktime(&tm);
+	days = (now - t) / DAY + 1;
+
+	counts = malloc(days * (SL_SEV_FATAL + 1) * sizeof(*counts));
+	if (counts == NULL) {
+		fprintf(stderr, "%s: Out of memory\n", cmd);
+		slog_hot_free(&hot);
+		return 2;
+	}
+
+	slog_hot_stats(&hot, now - hot.window, &stats, sev);
+	printf("Servicelog Statistics for the Last %lld Days:\n\n",
+	       (long long)hot.window / DAY);
+	slog_stats_print(stdout, &stats);
+
+	printf("Events by Day:\n\n");
+	printf("  %10s %7s", "Date", "Total");
+	for (s = SL_SEV_FATAL; s >= SL_SEV_DEBUG; s--)
+		printf(" %7s", sev_title[s]);
+	printf("\n\n");
+
+	slog_hot_histogram(&hot, t, DAY, counts, days);
+	for (d = 0; d < days; d++) {
+		for (total = 0, s = SL_SEV_DEBUG; s <= SL_SEV_FATAL; s++)
+			total += counts[d * (SL_SEV_FATAL + 1) + s];
+		if (total == 0)
+			continue;
+
+		day = tm;
+		day.tm_mday += d;
+		day.tm_isdst = -1;
+		mktime(&day);
+		strftime(buf, sizeof(buf), "%Y-%m-%d", &day);
+		printf("  %10s %7" PRIu64, buf, total);
+		for (s = SL_SEV_FATAL; s >= SL_SEV_DEBUG; s--)
+			printf(" %7" PRIu64,
+			       counts[d * (SL_SEV_FATAL + 1) + s]);
+		printf("\n");
+	}
+	printf("\n");
+
+	print_top(&hot, now - hot.window, SLOG_HOT_REFCODE,
+		  "Most Frequent Reference Codes");
+	print_top(&hot, now - hot.window, SLOG_HOT_LOCATION,
+		  "Most Frequent Locations");
+
+	free(counts);
+	slog_hot_free(&hot);
+	return 0;
+}
+
+/**
+ * diff_snapshots
+ * @brief Print the differences between two snapshot files
+ *
+ * @param path_a older snapshot
+ * @param path_b newer snapshot
+ * @return 0 on success, 2 on failure
+ */
+static int
+diff_snapshots(const char *path_a, const char *path_b)
+{
+	struct slog_snapshot a, b;
+	struct slog_diff diff;
+	int rc;
+
+	if (slog_snapshot_open(path_a, &a) != 0) {
+		fprintf(stderr, "%s\n", a.error);
+		return 2;
+	}
+	if (slog_snapshot_open(path_b, &b) != 0) {
+		fprintf(stderr, "%s\n", b.error);
+		slog_snapshot_close(&a);
+		return 2;
+	}
+
+	rc = slog_diff_snapshots(stdout, &a, &b, &diff);
+	if (rc == 0)
+		slog_diff_print_summary(stdout, &diff);
+	else
+		fprintf(stderr, "%s: Snapshot is not in id order\n", cmd);
+
+	slog_snapshot_close(&a);
+	slog_snapshot_close(&b);
+	return rc ? 2 : 0;
+}
+
+/**
+ * query_events
+ * @brief Run an event query within a time and row budget
+ *
+ * @param slog open servicelog
+ * @param query WHERE clause
+ * @param budget limits to apply
+ * @param events returned list of events
+ * @return 0 on success, SLOG_EXIT_BUDGET if the budget was exceeded,
+ *	   2 on other failures
+ */
+static int
+query_events(servicelog *slog, char *query, struct slog_budget *budget,
+	     struct sl_event **events)
+{
+	int rc;
+
+	slog_budget_start(budget, slog->db);
+	rc = servicelog_event_query(slog, query, events);
+	slog_budget_stop(budget, slog->db);
+
+	if (budget->exceeded) {
+		if (rc == 0 && *events)
+			servicelog_event_free(*events);
+		*events = NULL;
+		slog_budget_report(stderr, cmd, budget);
+		return SLOG_EXIT_BUDGET;
+	}
+	if (rc != 0) {
+		fprintf(stderr, "%s\n", servicelog_error(slog));
+		return 2;
+	}
+
+	return 0;
 }
 
 /**
@@ -98,13 +821,27 @@ check_event(struct sl_event *e, int *open, int *close, int *info)
  * @param argc the number of command-line arguments
  * @param argv array of command-line arguments
  * @return exit status: 0 for normal exit, 1 for usage error, >1 for other error
+ *	   (SLOG_EXIT_BUDGET if a --timeout or --max-rows budget was exceeded)
  */
 int
 main(int argc, char *argv[]) 
 {
 	int option_index, rc;
 	int dump = 0;
-	char *query = NULL;
+	char *query = NULL, *rewritten = NULL;
+	char *export_snapshot = NULL, *snapshot = NULL;
+	char *cursor_file = NULL, *location = NULL, *analyze = NULL;
+	int export = 0, diff = 0, incidents = 0, open_events = 0;
+	int compress = SLOG_COMPRESS_NONE, jobs = 1;
+	struct slog_ids ids;
+	int by_ids = 0, recent = 0;
+	long long recent_age = 0;
+	char err[SL_MAX_ERR];
+	struct slog_output out;
+	struct slog_pipeline pipeline;
+	struct slog_budget budget;
+	uint64_t value;
+	char *next_char;
 	servicelog *slog;
 	struct sl_event *event;
 	int platform = 0;
@@ -120,11 +857,14 @@ main(int argc, char *argv[])
 	}
 #endif
 	cmd = argv[0];
+	memset(&budget, 0, sizeof(budget));
+	memset(&ids, 0, sizeof(ids));
 
 	for (;;) {
 		option_index = 0;
-		rc = getopt_long(argc, argv, "dq:vVh", long_options,
-				 &option_index);
+		rc = getopt_long(argc, argv,
+				 "dq:x:n:XC:z:j:DT:M:IOL:N:F:W::A:vVh",
+				 long_options, &option_index);
 
 		if (rc == -1)
 			break;
@@ -136,6 +876,96 @@ main(int argc, char *argv[])
 		case 'q':
 			query = optarg;
 			break;
+		case 'x':
+			export_snapshot = optarg;
+			break;
+		case 'n':
+			snapshot = optarg;
+			break;
+		case 'X':
+			export = 1;
+			break;
+		case 'C':
+			cursor_file = optarg;
+			break;
+		case 'D':
+			diff = 1;
+			break;
+		case 'I':
+			incidents = 1;
+			break;
+		case 'O':
+			open_events = 1;
+			break;
+		case 'L':
+			location = optarg;
+			break;
+		case 'N':
+			if (slog_ids_parse(&ids, optarg, err, sizeof(err)) != 0) {
+				fprintf(stderr, "--ids argument invalid: %s\n\n",
+					err);
+				print_usage(argv[0]);
+				exit(1);
+			}
+			by_ids = 1;
+			break;
+		case 'F':
+			if (slog_ids_read(&ids, optarg, err, sizeof(err)) != 0) {
+				fprintf(stderr, "--ids-from argument invalid: "
+					"%s\n\n", err);
+				print_usage(argv[0]);
+				exit(1);
+			}
+			by_ids = 1;
+			break;
+		case 'W':
+			if (optarg && (slog_query_duration(optarg,
+							   &recent_age) != 0 ||
+				       recent_age <= 0)) {
+				fprintf(stderr, "--recent argument invalid.\n\n");
+				print_usage(argv[0]);
+				exit(1);
+			}
+			recent = 1;
+			break;
+		case 'A':
+			analyze = optarg;
+			break;
+		case 'j':
+			jobs = (int)strtoul(optarg, &next_char, 10);
+			if (optarg[0] == '\0' || *next_char != '\0' ||
+			    jobs <= 0 || jobs > SLOG_PIPELINE_MAX_JOBS) {
+				fprintf(stderr, "--jobs argument invalid.\n\n");
+				print_usage(argv[0]);
+				exit(1);
+			}
+			break;
+		case 'T':
+			if (slog_budget_parse(optarg, &value) != 0 ||
+			    value > LONG_MAX) {
+				fprintf(stderr, "--timeout argument invalid.\n\n");
+				print_usage(argv[0]);
+				exit(1);
+			}
+			budget.timeout_ms = (long)value;
+			break;
+		case 'M':
+			if (slog_budget_parse(optarg, &budget.max_rows) != 0) {
+				fprintf(stderr, "--max-rows argument "
+					"invalid.\n\n");
+				print_usage(argv[0]);
+				exit(1);
+			}
+			break;
+		case 'z':
+			compress = slog_output_method(optarg);
+			if (compress < 0) {
+				fprintf(stderr, "--compress argument invalid or "
+					"not supported by this build.\n\n");
+				print_usage(argv[0]);
+				exit(1);
+			}
+			break;
 		case 'v':
 			/* obsolete */
 			break;
@@ -159,6 +989,28 @@ main(int argc, char *argv[])
 		}
 	}
 
+	if (recent) {
+		if (argc != 2) {
+			fprintf(stderr, "The recent flag cannot be combined "
+				"with other flags.\n\n");
+			print_usage(argv[0]);
+			exit(1);
+		}
+		return print_recent(recent_age);
+	}
+
+	if (analyze) {
+		/* the file may be a separate argument of -A or --analyze */
+		if (optind != argc ||
+		    !(argc == 2 || (argc == 3 && argv[2] == analyze))) {
+			fprintf(stderr, "The analyze flag cannot be combined "
+				"with other flags.\n\n");
+			print_usage(argv[0]);
+			exit(1);
+		}
+		return print_analysis(analyze);
+	}
+
 	if (dump && query) {
 		fprintf(stderr, "The dump and query flags cannot be specified "
 			"on the same command line.\n\n");
@@ -166,57 +1018,288 @@ main(int argc, char *argv[])
 		exit(1);
 	}
 
+	if (open_events) {
+		if (dump || query) {
+			fprintf(stderr, "The open flag cannot be combined "
+				"with the dump or query flag.\n\n");
+			print_usage(argv[0]);
+			exit(1);
+		}
+		query = SLOG_QUERY_OPEN;
+	}
+
+	if (dump && export_snapshot) {
+		fprintf(stderr, "The dump and export-snapshot flags cannot be "
+			"specified on the same command line.\n\n");
+		print_usage(argv[0]);
+		exit(1);
+	}
+
+	if (export && (dump || query || export_snapshot)) {
+		fprintf(stderr, "The export flag cannot be combined with the "
+			"dump, query or export-snapshot flags.\n\n");
+		print_usage(argv[0]);
+		exit(1);
+	}
+
+	if (cursor_file && !(export || diff)) {
+		fprintf(stderr, "The cursor-file flag requires the export "
+			"or diff flag.\n\n");
+		print_usage(argv[0]);
+		exit(1);
+	}
+
+	if (diff) {
+		if (dump || query || export || export_snapshot || snapshot ||
+		    jobs > 1 || compress != SLOG_COMPRESS_NONE) {
+			fprintf(stderr, "The diff flag can only be combined "
+				"with the cursor-file flag.\n\n");
+			print_usage(argv[0]);
+			exit(1);
+		}
+		if (cursor_file ? (optind != argc) : (argc - optind != 2)) {
+			fprintf(stderr, "The diff flag requires either two "
+				"snapshot files or the cursor-file flag.\n\n");
+			print_usage(argv[0]);
+			exit(1);
+		}
+		if (!cursor_file)
+			return diff_snapshots(argv[optind], argv[optind + 1]);
+	}
+
+	if (compress != SLOG_COMPRESS_NONE &&
+	    !(dump || query || export || by_ids)) {
+		fprintf(stderr, "The compress flag requires the dump, query, "
+			"ids or export flag.\n\n");
+		print_usage(argv[0]);
+		exit(1);
+	}
+
+	if (jobs > 1 && (export || export_snapshot || !(dump || query))) {
+		fprintf(stderr, "The jobs flag can only be used with the dump "
+			"or query flag.\n\n");
+		print_usage(argv[0]);
+		exit(1);
+	}
+
+	if ((budget.timeout_ms || budget.max_rows) &&
+	    (jobs > 1 || !(dump || query || export_snapshot))) {
+		fprintf(stderr, "The timeout and max-rows flags require the "
+			"dump, query or export-snapshot flag, and cannot be "
+			"combined with the jobs flag.\n\n");
+		print_usage(argv[0]);
+		exit(1);
+	}
+
+	if (incidents && (dump || query || export || export_snapshot ||
+			  snapshot || cursor_file || jobs > 1 ||
+			  compress != SLOG_COMPRESS_NONE)) {
+		fprintf(stderr, "The incidents flag cannot be combined with "
+			"other flags.\n\n");
+		print_usage(argv[0]);
+		exit(1);
+	}
+
+	if (location && (dump || query || export || export_snapshot ||
+			 snapshot || incidents || cursor_file || jobs > 1 ||
+			 compress != SLOG_COMPRESS_NONE)) {
+		fprintf(stderr, "The location flag cannot be combined with "
+			"other flags.\n\n");
+		print_usage(argv[0]);
+		exit(1);
+	}
+
+	if (location && location[strspn(location, "-")] == '\0') {
+		fprintf(stderr, "The location flag requires a location "
+			"code.\n\n");
+		print_usage(argv[0]);
+		exit(1);
+	}
+
+	if (by_ids && (dump || query || export || export_snapshot ||
+		      snapshot || incidents || location || cursor_file ||
+		      jobs > 1)) {
+		fprintf(stderr, "The ids and ids-from flags can only be "
+			"combined with the compress flag.\n\n");
+		print_usage(argv[0]);
+		exit(1);
+	}
+
+	if (snapshot) {
+		if (dump || export_snapshot || export || jobs > 1 ||
+		    compress != SLOG_COMPRESS_NONE || budget.timeout_ms ||
+		    budget.max_rows) {
+			fprintf(stderr, "The snapshot flag can only be combined "
+				"with the query or open flag.\n\n");
+			print_usage(argv[0]);
+			exit(1);
+		}
+		if (query)
+			return print_snapshot_counts(snapshot, query);
+		return print_snapshot_stats(snapshot);
+	}
+
+	if (query && !open_events) {
+		if (slog_query_rewrite(query, time(NULL), &rewritten, err,
+				       sizeof(err)) != 0) {
+			fprintf(stderr, "%s: %s\n\n", argv[0], err);
+			print_usage(argv[0]);
+			exit(1);
+		}
+		query = rewritten;
+	}
+
+	/*
+	 * the workers must be forked before the database is opened, and
+	 * before the compression thread exists
+	 */
+	if (jobs > 1 &&
+	    slog_pipeline_start(&pipeline, dump ? NULL : query, jobs) != 0) {
+		fprintf(stderr, "%s: %s\n", argv[0], pipeline.error);
+		exit(2);
+	}
+
 	rc = servicelog_open(&slog, 0);
 	if (rc) {
 		fprintf(stderr, "Error opening servicelog: %s\n", strerror(rc));
+		if (jobs > 1)
+			slog_pipeline_finish(&pipeline);
+		exit(2);
+	}
+	if (jobs > 1 && slog_pipeline_plan(&pipeline, slog) != 0) {
+		fprintf(stderr, "%s: %s\n", argv[0], pipeline.error);
+		slog_pipeline_finish(&pipeline);
+		servicelog_close(slog);
 		exit(2);
 	}
 
-	if (dump) {
-		rc = servicelog_event_query(slog, "", &event);
-		if (rc != 0) {
-			fprintf(stderr, "%s\n", servicelog_error(slog));
+	/* without the partial index, --open reads every event */
+	if (open_events && slog_index_present(slog) == 0 &&
+	    slog_index_ensure(slog, err, sizeof(err)) != 0)
+		fprintf(stderr, "%s: The index of open events is missing, so "
+			"every event is read; run \"servicelog_manage "
+			"--index\" as root to create it\n", argv[0]);
+
+	if ((dump || query || export || by_ids) && !export_snapshot &&
+	    slog_output_open(&out, compress, STDOUT_FILENO) != 0) {
+		fprintf(stderr, "%s: %s\n", argv[0], out.error);
+		servicelog_close(slog);
+		exit(2);
+	}
+
+	if (diff) {
+		struct slog_cursor cursor;
+		struct slog_diff changes;
+
+		if (slog_cursor_read(cursor_file, &cursor, err,
+				     sizeof(err)) != 0) {
+			fprintf(stderr, "%s\n", err);
 			servicelog_close(slog);
 			exit(2);
 		}
-		rc = servicelog_event_print(stdout, event, 1);
-		if (rc < 0) {
+		if (slog_diff_cursor(stdout, slog, &cursor, &changes) != 0) {
 			fprintf(stderr, "%s\n", servicelog_error(slog));
 			servicelog_close(slog);
 			exit(2);
 		}
-		servicelog_event_free(event);
+		slog_diff_print_summary(stdout, &changes);
+	}
+	else if (incidents) {
+		struct slog_incident_update update;
+
+		if (slog_incident_update(slog, &update) != 0 ||
+		    slog_incident_print(stdout, slog) != 0) {
+			fprintf(stderr, "%s: %s\n", argv[0], update.error[0] ?
+				update.error : sqlite3_errmsg(slog->db));
+			servicelog_close(slog);
+			exit(2);
+		}
+	}
+	else if (location) {
+		rc = print_location(slog, location);
+		servicelog_close(slog);
+		return rc;
+	}
+	else if (by_ids) {
+		rc = print_ids(slog, &ids, out.fp);
+		if (slog_output_close(&out) != 0) {
+			fprintf(stderr, "%s: %s\n", argv[0], out.error);
+			rc = 2;
+		}
+		slog_ids_free(&ids);
+		servicelog_close(slog);
+		return rc;
 	}
-	else if (query) {
-		rc = servicelog_event_query(slog, query, &event);
+	else if (export) {
+		rc = export_records(slog, cursor_file, &out);
+		servicelog_close(slog);
+		return rc;
+	}
+	else if (export_snapshot) {
+		rc = query_events(slog, query ? query : "", &budget, &event);
 		if (rc != 0) {
-			fprintf(stderr, "%s\n", servicelog_error(slog));
+			servicelog_close(slog);
+			exit(rc);
+		}
+		rc = slog_snapshot_write(export_snapshot, &event, err,
+					 sizeof(err));
+		if (event)
+			servicelog_event_free(event);
+		if (rc != 0) {
+			fprintf(stderr, "%s\n", err);
 			servicelog_close(slog);
 			exit(2);
 		}
-		rc = servicelog_event_print(stdout, event, 1);
+	}
+	else if (jobs > 1) {
+		rc = slog_pipeline_run(&pipeline, out.fp);
+		if (slog_pipeline_finish(&pipeline) != 0)
+			rc = -1;
+		if (rc != 0) {
+			fprintf(stderr, "%s: %s\n", argv[0], pipeline.error);
+			slog_output_close(&out);
+			servicelog_close(slog);
+			exit(2);
+		}
+
+		if (slog_output_close(&out) != 0) {
+			fprintf(stderr, "%s: %s\n", argv[0], out.error);
+			servicelog_close(slog);
+			exit(2);
+		}
+	}
+	else if (dump || query) {
+		rc = query_events(slog, dump ? "" : query, &budget, &event);
+		if (rc != 0) {
+			slog_output_close(&out);
+			servicelog_close(slog);
+			exit(rc);
+		}
+		rc = servicelog_event_print(out.fp, event, 1);
 		if (rc < 0) {
 			fprintf(stderr, "%s\n", servicelog_error(slog));
+			slog_output_close(&out);
 			servicelog_close(slog);
 			exit(2);
 		}
 		servicelog_event_free(event);
+
+		if (slog_output_close(&out) != 0) {
+			fprintf(stderr, "%s: %s\n", argv[0], out.error);
+			servicelog_close(slog);
+			exit(2);
+		}
 	}
 	else {
 		struct sl_event *e;
+		struct slog_stats stats;
 
 		struct sl_repair_action *repair, *r;
 		struct sl_notify *notify, *n;
 
 		int n_repair = 0, n_notify = 0;
 
-		int n_events = 0, n_open = 0;
-		/* _o = open events, _c = closed events, _i = info events */
-		int n_basic = 0, n_basic_o = 0, n_basic_c = 0, n_basic_i=0;
-		int n_os = 0, n_os_o = 0, n_os_c = 0, n_os_i=0;
-		int n_rtas = 0, n_rtas_o = 0, n_rtas_c = 0, n_rtas_i=0;
-		int n_encl = 0, n_encl_o = 0, n_encl_c = 0, n_encl_i=0;
-		int n_bmc = 0, n_bmc_o = 0, n_bmc_c = 0, n_bmc_i=0;
+		memset(&stats, 0, sizeof(stats));
 
 		/* Print a summary of the database contents */
 		printf("Servicelog Statistics:\n\n");
@@ -227,81 +1310,11 @@ main(int argc, char *argv[])
 			servicelog_close(slog);
 			exit(2);
 		}
-		e = event;
-		while (e) {
-			n_events++;
-
-			if (e->serviceable && !(e->closed))
-				n_open++;
-
-			switch (e->type) {
-			case SL_TYPE_BASIC:
-				n_basic++;
-				check_event(e, &n_basic_o, &n_basic_c,
-					    &n_basic_i);
-				break;
-			case SL_TYPE_OS:
-				n_os++;
-				check_event(e, &n_os_o, &n_os_c, &n_os_i);
-				break;
-			case SL_TYPE_RTAS:
-				n_rtas++;
-				check_event(e, &n_rtas_o, &n_rtas_c, &n_rtas_i);
-				break;
-			case SL_TYPE_ENCLOSURE:
-				n_encl++;
-				check_event(e, &n_encl_o, &n_encl_c, &n_encl_i);
-				break;
-			case SL_TYPE_BMC:
-				n_bmc++;
-				check_event(e, &n_bmc_o, &n_bmc_c, &n_bmc_i);
-				break;
-			default:
-				fprintf(stderr, "Event ""%" PRIu64 "has unknown type "
-					"%d\n", e->id, e->type);
-			}
-
-			e = e->next;
-		}
+		for (e = event; e; e = e->next)
+			slog_stats_add_event(&stats, e);
 		servicelog_event_free(event);
 
-		if (n_open == 0)
-			printf("There are no open events that require action."
-			       "\n\n");
-		else if (n_open == 1)
-			printf("There is 1 open event requiring action.\n\n");
-		else
-			printf("There are %d open events requiring action.\n\n",
-			       n_open);
-
-		printf("Summary of Logged Events:\n\n");
-
-		printf("  %10s %7s %7s %7s %7s\n\n", "Type", "Total", "Open",
-		       "Closed", "Info");
-
-		if (n_basic)
-			printf("  %10s %7d %7d %7d %7d\n", "Basic", n_basic,
-			       n_basic_o, n_basic_c, n_basic_i);
-		if (n_os)
-			printf("  %10s %7d %7d %7d %7d\n", "OS", n_os,
-			       n_os_o, n_os_c, n_os_i);
-		if (n_rtas)
-			printf("  %10s %7d %7d %7d %7d\n", "RTAS", n_rtas,
-			       n_rtas_o, n_rtas_c, n_rtas_i);
-		if (n_encl)
-			printf("  %10s %7d %7d %7d %7d\n", "Enclosure", n_encl,
-			       n_encl_o, n_encl_c, n_encl_i);
-		if (n_bmc)
-			printf("  %10s %7d %7d %7d %7d\n", "BMC", n_bmc,
-			       n_bmc_o, n_bmc_c, n_bmc_i);
-
-		printf("  %10s -------------------------------\n", "");
-		printf("  %10s %7d %7d %7d %7d\n\n", "",
-		       n_basic + n_os + n_rtas + n_encl + n_bmc,
-		       n_basic_o + n_os_o + n_rtas_o + n_encl_o + n_bmc_o,
-		       n_basic_c + n_os_c + n_rtas_c + n_encl_c + n_bmc_c,
-		       n_basic_i + n_os_i + n_rtas_i + n_encl_i + n_bmc_i);
-       
+		slog_stats_print(stdout, &stats);
 
 		rc = servicelog_repair_query(slog, "", &repair);
 		if (rc != 0) {
@@ -333,6 +1346,7 @@ main(int argc, char *argv[])
 	}
 
 	servicelog_close(slog);
+	free(rewritten);
 
 	return 0;
 }
@@ -0,0 +1,610 @@
+/**
+ * @file servicelog_fleet.c
+ * @brief Program for querying many servicelog databases at once
+ *
+ * Copyright (C) 2026 IBM Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301,
+ * USA.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <sqlite3.h>
+#include <servicelog-1/servicelog.h>
+#include "config.h"
+#include "slog_stats.h"
+
+#define ARG_LIST	"q:j:vVh"
+
+/* Upper bound on --jobs; more processes than this only add contention */
+#define MAX_JOBS	256
+
+static char *cmd;
+
+static struct option long_options[] = {
+	{"query",	    required_argument, NULL, 'q'},
+	{"jobs",	    required_argument, NULL, 'j'},
+	{"help",	    no_argument,       NULL, 'h'},
+	{"verbose",	    no_argument,       NULL, 'v'},
+	{"version",	    no_argument,       NULL, 'V'},
+	{0,0,0,0}
+};
+
+/*
+ * What a scan process leaves at the start of its result file; the
+ * matching events follow, each as a struct fleet_row, then its
+ * time_event and its printed text, both NUL-terminated
+ */
+struct fleet_result {
+	int rc;				/* 0 if the scan succeeded */
+	char error[SL_MAX_ERR];
+	struct slog_stats stats;
+	int n_repair;
+	uint64_t n_events;		/* --query results */
+};
+
+struct fleet_row {
+	uint64_t id;
+	uint32_t time_len;		/* with the NUL */
+	uint32_t text_len;		/* with the NUL */
+};
+
+/* One --query result, pointing into the buffer of its database */
+struct fleet_event {
+	uint64_t id;
+	const char *time;		/* time_event, as stored */
+	const char *text;
+};
+
+/* One servicelog database file collected from a system */
+struct fleet_source {
+	const char *path;
+	pid_t pid;
+	FILE *fp;			/* result file of the scan */
+	struct fleet_result result;
+	char *buf;			/* the events of the result file */
+	struct fleet_event *events;	/* by time_event, then id */
+	uint64_t next;			/* next event to print */
+};
+
+static struct fleet_source *sources;
+static int n_sources;
+static char *query;
+static int verbose;
+
+/**
+ * print_usage
+ * @brief Print the usage message
+ */
+static void
+print_usage(void)
+{
+	printf("Usage: %s [--query='<query>'] [--jobs=<n>] [-vVh] "
+	       "<database>...\n", cmd);
+	printf("  Without --query, prints the statistics of each servicelog\n");
+	printf("  database followed by a summary of the whole fleet.\n\n");
+
+	printf("  --query='<query>'  Prints the events from all databases\n");
+	printf("                     that match the query string, merged in\n");
+	printf("                     order of event time and tagged with the\n");
+	printf("                     database they came from. <query> is\n");
+	printf("                     formatted like the WHERE clause of an\n");
+	printf("                     SQL statement\n");
+	printf("  --jobs=<n> | -j    Number of databases to scan in parallel\n");
+	printf("                     (defaults to the number of online CPUs)\n");
+	printf("  --verbose | -v     Print the description of each event\n");
+	printf("  --version | -V     Print the version of the command and exit\n");
+	printf("  --help | -h        Print this help text and exit\n");
+}
+
+/**
+ * write_row
+ * @brief Format one matching event into the result file
+ *
+ * @return 0 on success, -1 on a write error
+ */
+static int
+write_row(FILE *fp, sqlite3_stmt *stmt, const char *path)
+{
+	struct fleet_row row;
+	const char *time = (const char *)sqlite3_column_text(stmt, 1);
+	const char *refcode = (const char *)sqlite3_column_text(stmt, 6);
+	const char *desc = (const char *)sqlite3_column_text(stmt, 7);
+	int serviceable = sqlite3_column_int(stmt, 4);
+	int closed = sqlite3_column_int(stmt, 5);
+	char *text = NULL;
+	int len;
+
+	if (time == NULL)
+		time = "";
+	len = asprintf(&text, "%-19s %10" PRIu64 "  %-9s %-11s %-6s %-10s %s\n"
+		       "%s%s%s", time, (uint64_t)sqlite3_column_int64(stmt, 0),
+		       slog_type_name(sqlite3_column_int(stmt, 2)),
+		       slog_sev_name(sqlite3_column_int(stmt, 3)),
+		       !serviceable ? "info" : closed ? "closed" : "open",
+		       refcode ? refcode : "", path,
+		       verbose > 1 && desc ? "    " : "",
+		       verbose > 1 && desc ? desc : "",
+		       verbose > 1 && desc ? "\n" : "");
+	if (len < 0)
+		return -1;
+
+	row.id = sqlite3_column_int64(stmt, 0);
+	row.time_len = strlen(time) + 1;
+	row.text_len = len + 1;
+	if (fwrite(&row, sizeof(row), 1, fp) != 1 ||
+	    fwrite(time, 1, row.time_len, fp) != row.time_len ||
+	    fwrite(text, 1, row.text_len, fp) != row.text_len) {
+		free(text);
+		return -1;
+	}
+	free(text);
+	return 0;
+}
+
+/**
+ * fleet_scan
+ * @brief Run the statistics or the query against one database
+ *
+ * Runs in a process of its own, with its own read-only SQLite
+ * connection; libservicelog can only open the database of the local
+ * system, so the events table is read directly.  The query string is
+ * the WHERE clause libservicelog would have used.
+ *
+ * @param src database to scan
+ * @return 0 on success, 2 on failure
+ */
+static int
+fleet_scan(struct fleet_source *src)
+{
+	struct fleet_result *res = &src->result;
+	sqlite3 *db = NULL;
+	sqlite3_stmt *stmt = NULL;
+	char *sql = NULL;
+	int rc;
+
+	memset(res, 0, sizeof(*res));
+	if (fwrite(res, sizeof(*res), 1, src->fp) != 1)
+		goto write_err;
+
+	rc = sqlite3_open_v2(src->path, &db, SQLITE_OPEN_READONLY, NULL);
+	if (rc != SQLITE_OK)
+		goto db_err;
+
+	if (query) {
+		if (asprintf(&sql, "SELECT id, time_event, type, severity, "
+			     "serviceable, closed, refcode, description FROM "
+			     "events WHERE (%s) ORDER BY time_event, id",
+			     query) < 0) {
+			snprintf(res->error, SL_MAX_ERR, "Out of memory");
+			goto out;
+		}
+		if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK)
+			goto db_err;
+		while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+			slog_stats_add(&res->stats, sqlite3_column_int(stmt, 2),
+				       sqlite3_column_int(stmt, 4),
+				       sqlite3_column_int(stmt, 5));
+			if (write_row(src->fp, stmt, src->path) != 0)
+				goto write_err;
+			res->n_events++;
+		}
+		if (rc != SQLITE_DONE)
+			goto db_err;
+	}
+	else {
+		if (sqlite3_prepare_v2(db, "SELECT type, serviceable, closed "
+				       "FROM events", -1, &stmt,
+				       NULL) != SQLITE_OK)
+			goto db_err;
+		while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+			slog_stats_add(&res->stats, sqlite3_column_int(stmt, 0),
+				       sqlite3_column_int(stmt, 1),
+				       sqlite3_column_int(stmt, 2));
+		if (rc != SQLITE_DONE)
+			goto db_err;
+		sqlite3_finalize(stmt);
+
+		if (sqlite3_prepare_v2(db, "SELECT count(*) FROM "
+				       "repair_actions", -1, &stmt,
+				       NULL) != SQLITE_OK ||
+		    sqlite3_step(stmt) != SQLITE_ROW)
+			goto db_err;
+		res->n_repair = sqlite3_column_int(stmt, 0);
+	}
+	res->rc = 0;
+	goto out;
+
+write_err:
+	snprintf(res->error, SL_MAX_ERR, "Could not write the results: %s",
+		 strerror(errno));
+	res->rc = 2;
+	goto out;
+db_err:
+	snprintf(res->error, SL_MAX_ERR, "%s", db ? sqlite3_errmsg(db) :
+		 "Out of memory");
+out:
+	if (res->error[0])
+		res->rc = 2;
+	sqlite3_finalize(stmt);
+	sqlite3_close(db);
+	free(sql);
+
+	/* the header goes last, once the counts are known */
+	if (fseek(src->fp, 0, SEEK_SET) != 0 ||
+	    fwrite(res, sizeof(*res), 1, src->fp) != 1 ||
+	    fflush(src->fp) != 0)
+		return 2;
+	return res->rc;
+}
+
+/**
+ * fleet_collect
+ * @brief Read the result file of a finished scan
+ *
+ * @param src database whose scan has exited
+ * @param status exit status of the scan process
+ */
+static void
+fleet_collect(struct fleet_source *src, int status)
+{
+	struct fleet_result *res = &src->result;
+	struct fleet_row row;
+	char *p, *end;
+	long size;
+	uint64_t i;
+
+	src->pid = 0;
+	rewind(src->fp);
+	/* the header is only complete if the scan got to the end */
+	if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0 &&
+				    WEXITSTATUS(status) != 2) ||
+	    fread(res, sizeof(*res), 1, src->fp) != 1 ||
+	    (res->rc == 0 && WEXITSTATUS(status) != 0)) {
+		memset(res, 0, sizeof(*res));
+		res->rc = 2;
+		if (WIFSIGNALED(status))
+			snprintf(res->error, SL_MAX_ERR, "The scan was killed "
+				 "by signal %d", WTERMSIG(status));
+		else
+			snprintf(res->error, SL_MAX_ERR, "The scan failed");
+		goto out;
+	}
+	if (res->rc || res->n_events == 0)
+		goto out;
+
+	fseek(src->fp, 0, SEEK_END);
+	size = ftell(src->fp) - (long)sizeof(*res);
+	fseek(src->fp, sizeof(*res), SEEK_SET);
+	src->buf = malloc(size);
+	src->events = calloc(res->n_events, sizeof(*src->events));
+	if (src->buf == NULL || src->events == NULL ||
+	    fread(src->buf, 1, size, src->fp) != (size_t)size)
+		goto err_out;
+
+	p = src->buf;
+	end = src->buf + size;
+	for (i = 0; i < res->n_events; i++) {
+		if ((size_t)(end - p) < sizeof(row))
+			goto err_out;
+		memcpy(&row, p, sizeof(row));
+		p += sizeof(row);
+		if ((uint64_t)(end - p) < (uint64_t)row.time_len + row.text_len ||
+		    row.time_len == 0 || row.text_len == 0 ||
+		    p[row.time_len - 1] != '\0' ||
+		    p[row.time_len + row.text_len - 1] != '\0')
+			goto err_out;
+		src->events[i].id = row.id;
+		src->events[i].time = p;
+		src->events[i].text = p + row.time_len;
+		p += row.time_len + row.text_len;
+	}
+	goto out;
+
+err_out:
+	res->rc = 2;
+	snprintf(res->error, SL_MAX_ERR, "Could not read the results of the "
+		 "scan");
+out:
+	fclose(src->fp);
+	src->fp = NULL;
+}
+
+/* Min-heap of the next unprinted event from each database */
+static int
+heap_less(int a, int b)
+{
+	struct fleet_event *ea = &sources[a].events[sources[a].next];
+	struct fleet_event *eb = &sources[b].events[sources[b].next];
+	int c = strcmp(ea->time, eb->time);
+
+	if (c != 0)
+		return c < 0;
+	if (a != b)
+		return a < b;
+	return ea->id < eb->id;
+}
+
+static void
+heap_sift_down(int *heap, int n, int i)
+{
+	int child, tmp;
+
+	for (;;) {
+		child = 2 * i + 1;
+		if (child >= n)
+			break;
+		if (child + 1 < n && heap_less(heap[child + 1], heap[child]))
+			child++;
+		if (!heap_less(heap[child], heap[i]))
+			break;
+
+		tmp = heap[i];
+		heap[i] = heap[child];
+		heap[child] = tmp;
+		i = child;
+	}
+}
+
+/**
+ * print_merged
+ * @brief K-way merge of the per-database results in order of event time
+ *
+ * Each database's events are already in order; the times are compared
+ * as stored, i.e., as the local time of the system that logged them.
+ *
+ * @return 0 on success, -1 on failure
+ */
+static int
+print_merged(void)
+{
+	struct fleet_source *src;
+	int *heap;
+	int i, n = 0;
+
+	heap = calloc(n_sources, sizeof(*heap));
+	if (heap == NULL) {
+		fprintf(stderr, "%s: Out of memory\n", cmd);
+		return -1;
+	}
+
+	for (i = 0; i < n_sources; i++)
+		if (sources[i].result.rc == 0 && sources[i].result.n_events)
+			heap[n++] = i;
+	for (i = n / 2 - 1; i >= 0; i--)
+		heap_sift_down(heap, n, i);
+
+	printf("%-19s %10s  %-9s %-11s %-6s %-10s %s\n\n", "Event Time", "ID",
+	       "Type", "Severity", "Status", "Refcode", "Database");
+	while (n > 0) {
+		src = &sources[heap[0]];
+		fputs(src->events[src->next].text, stdout);
+
+		if (++src->next == src->result.n_events)
+			heap[0] = heap[--n];
+		heap_sift_down(heap, n, 0);
+	}
+
+	free(heap);
+	return 0;
+}
+
+static void
+print_stats(void)
+{
+	struct slog_stats fleet;
+	int i, n_repair = 0, n_ok = 0;
+
+	memset(&fleet, 0, sizeof(fleet));
+
+	printf("Servicelog Fleet Statistics:\n\n");
+	printf("  %7s %7s %7s  %s\n\n", "Events", "Open", "Repairs",
+	       "Database");
+	for (i = 0; i < n_sources; i++) {
+		struct fleet_result *res = &sources[i].result;
+
+		if (res->rc)
+			continue;
+
+		printf("  %7d %7d %7d  %s\n", res->stats.n_events,
+		       res->stats.n_open, res->n_repair, sources[i].path);
+		slog_stats_merge(&fleet, &res->stats);
+		n_repair += res->n_repair;
+		n_ok++;
+	}
+	printf("\n");
+
+	printf("Databases Scanned:             %d\n\n", n_ok);
+	slog_stats_print(stdout, &fleet);
+	printf("Logged Repair Actions:         %d\n", n_repair);
+}
+
+/**
+ * main
+ * @brief Parse command line args, scan the databases and print the results
+ *
+ * @param argc the number of command-line arguments
+ * @param argv array of command-line arguments
+ * @return exit status: 0 for normal exit, 1 for usage error, >1 for other error
+ */
+int
+main(int argc, char *argv[])
+{
+	int option_index, rc, i, status;
+	int jobs = 0, running = 0, next = 0, failed = 0;
+	char *next_char;
+	pid_t pid;
+
+	/*
+	 * No platform check: the databases are read as plain files, and
+	 * are typically collected to an analysis host for processing.
+	 */
+	cmd = argv[0];
+	verbose = 1;
+
+	for (;;) {
+		option_index = 0;
+		rc = getopt_long(argc, argv, ARG_LIST, long_options,
+				 &option_index);
+
+		if (rc == -1)
+			break;
+
+		switch (rc) {
+		case 'q':
+			query = optarg;
+			break;
+		case 'j':
+			jobs = (int)strtoul(optarg, &next_char, 10);
+			if (optarg[0] == '\0' || *next_char != '\0' ||
+			    jobs <= 0 || jobs > MAX_JOBS) {
+				fprintf(stderr, "--jobs argument invalid.\n\n");
+				print_usage();
+				exit(1);
+			}
+			break;
+		case 'v':
+			verbose = 2;
+			break;
+		case 'V':
+			printf("%s: Version %s\n", argv[0], VERSION);
+			exit(0);
+			break;
+		case 'h':	/* help */
+			print_usage();
+			exit(0);
+			break;
+		case '?':
+			print_usage();
+			exit(1);
+			break;
+		default:
+			fprintf(stderr, "Encountered a problem while parsing "
+				"options; report a bug to the maintainers "
+				"(%s).\n", PACKAGE_BUGREPORT);
+			exit(1);
+		}
+	}
+
+	n_sources = argc - optind;
+	if (n_sources <= 0) {
+		fprintf(stderr, "At least one database file must be "
+			"specified.\n\n");
+		print_usage();
+		exit(1);
+	}
+
+	sources = calloc(n_sources, sizeof(*sources));
+	if (sources == NULL) {
+		fprintf(stderr, "%s: Out of memory\n", cmd);
+		exit(2);
+	}
+	for (i = 0; i < n_sources; i++)
+		sources[i].path = argv[optind + i];
+
+	if (jobs == 0) {
+		jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+		if (jobs <= 0)
+			jobs = 1;
+		if (jobs > MAX_JOBS)
+			jobs = MAX_JOBS;
+	}
+	if (jobs > n_sources)
+		jobs = n_sources;
+
+	/* don't let the scans inherit (and flush) buffered output */
+	fflush(stdout);
+	fflush(stderr);
+
+	/* one process per database, at most jobs at a time */
+	while (next < n_sources || running > 0) {
+		if (next < n_sources && running < jobs) {
+			struct fleet_source *src = &sources[next++];
+
+			src->fp = tmpfile();
+			if (src->fp == NULL) {
+				src->result.rc = 2;
+				snprintf(src->result.error, SL_MAX_ERR,
+					 "Could not create a result file: %s",
+					 strerror(errno));
+				continue;
+			}
+			src->pid = fork();
+			if (src->pid == 0)
+				_exit(fleet_scan(src));
+			if (src->pid == -1) {
+				src->pid = 0;
+				src->result.rc = 2;
+				snprintf(src->result.error, SL_MAX_ERR,
+					 "Could not start the scan: %s",
+					 strerror(errno));
+				fclose(src->fp);
+				src->fp = NULL;
+				continue;
+			}
+			running++;
+			continue;
+		}
+
+		pid = waitpid(-1, &status, 0);
+		if (pid == -1) {
+			if (errno == EINTR)
+				continue;
+			fprintf(stderr, "%s: %s\n", cmd, strerror(errno));
+			exit(2);
+		}
+		for (i = 0; i < next; i++) {
+			if (sources[i].pid == pid) {
+				fleet_collect(&sources[i], status);
+				running--;
+				break;
+			}
+		}
+	}
+
+	for (i = 0; i < n_sources; i++) {
+		if (sources[i].result.rc) {
+			fprintf(stderr, "%s: %s\n", sources[i].path,
+				sources[i].result.error);
+			failed++;
+		}
+	}
+
+	if (query)
+		rc = print_merged();
+	else {
+		print_stats();
+		rc = 0;
+	}
+
+	for (i = 0; i < n_sources; i++) {
+		free(sources[i].events);
+		free(sources[i].buf);
+	}
+	free(sources);
+
+	if (rc || failed)
+		return 2;
+
+	return 0;
+}
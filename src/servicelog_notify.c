@@ -31,6 +31,10 @@
 #include <servicelog-1/servicelog.h>
 #include "config.h"
 #include "platform.h"
+#include "slog_ids.h"
+#include "slog_notify.h"
+#include "slog_subscriber.h"
+#include "slog_notify_stats.h"
 
 #define ACTION_TOOMANY		-1
 #define ACTION_UNSPECIFIED	0
@@ -38,11 +42,12 @@
 #define ACTION_LIST		2
 #define ACTION_REMOVE	3
 #define ACTION_QUERY	4
+#define ACTION_DISPATCH	5
 
 #define TYPE_EVENTS 0x1
 #define TYPE_REPAIRS 0x2
 
-#define ARG_LIST	"alrqi:t:E:R:S:c:M:m:h"
+#define ARG_LIST	"alrqsf:D:i:t:E:R:S:c:M:m:h"
 
 static char *cmd;
 
@@ -50,6 +55,9 @@ static struct option long_options[] = {
 	{"add",		    no_argument,        NULL, 'a'},
 	{"remove",	    no_argument,        NULL, 'r'},
 	{"list",	    no_argument,        NULL, 'l'},
+	{"dispatch",	    required_argument,  NULL, 'D'},
+	{"stats",	    no_argument,        NULL, 's'},
+	{"metrics-file",    required_argument,  NULL, 'f'},
 	{"match",	    required_argument,  NULL, 'm'},
 	{"type",	    required_argument,  NULL, 't'},
 	{"command",	    required_argument,	NULL, 'c'},
@@ -73,14 +81,26 @@ print_usage()
 {
 	printf("Usage: %s {--add | --remove | --list} [flags]\n",
 	       cmd);
+	printf("       %s --dispatch=<ids> [--type=EVENT|REPAIR]\n", cmd);
 	printf("  Add Flags:\n");
 	printf("    --command=\"<cmd>\"  command to be run when notified\n");
 	printf("    --type=EVENT|REPAIR  notify on events or repair actions?\n");
 	printf("    --match=<query_string>  notify on events matching query\n");
 	printf("    --method={num_stdin|num_arg|text_stdin|pairs_stdin}\n");
-	printf("  Remove Flags:  One of --id or --command must be specified.\n");
+	printf("    --method=socket:<path>  push records to a subscriber\n");
+	printf("        listening on the Unix socket <path> (no --command)\n");
+	printf("  Remove Flags:  One of --id, --command or --method=socket:<path>\n");
+	printf("                 must be specified.\n");
 	printf("  List Flags:    At most one of --id or --command may be specified.\n");
 	printf("    --id=<id>    ID of registered tool to list or remove\n");
+	printf("    --stats      list the delivery latency histograms of\n");
+	printf("                 each tool and subscriber instead\n");
+	printf("    --metrics-file=<file>  with --stats, write them to <file>\n");
+	printf("                 in the Prometheus text format instead\n");
+	printf("  Dispatch Flags:\n");
+	printf("    --dispatch=<ids>  run the matching tools for the logged\n");
+	printf("        events (or, with --type=REPAIR, repair actions) with\n");
+	printf("        the ids in <ids>, e.g., 12,15,40-49\n");
 	printf("  Flags supported for backward compatibility:\n");
 	printf("    --type=\"<type>\"  notify on specified event type(s).\n");
 	printf("        Can be: [os|ppc64_encl|ppc64_rtas|ppc64_bmc],\n");
@@ -143,6 +163,30 @@ valid_method_arg(const char *arg) {
 	return -1;
 }
 
+/**
+ * add_subscriber
+ * @brief Register a socket subscriber for one kind of record
+ *
+ * @return 0 on success, 2 on failure
+ */
+static int
+add_subscriber(servicelog *servlog, const char *path, int notify,
+	       const char *match)
+{
+	char err[SL_MAX_ERR];
+	uint64_t id;
+
+	if (slog_subscriber_add(servlog, path, notify, match, &id, err,
+				sizeof(err)) != 0) {
+		fprintf(stderr, "%s\n", err);
+		return 2;
+	}
+
+	printf("%s Subscriber Registration successful (id: %" PRIu64 ")\n",
+	       notify == SL_NOTIFY_EVENTS ? "Event" : "Repair", id);
+	return 0;
+}
+
 /**
  * main
  * @brief Parse command line args and execute diagnostics
@@ -181,9 +225,17 @@ main(int argc, char *argv[])
 	int notify_flag = 0;
 	uint64_t id=0;
 	char *command=NULL, *match=NULL, query[256], cmdbuf[256];
+	char *socket_path = NULL, *metrics_file = NULL;
+	int stats = 0;
 	char *next_char;
 	struct servicelog *servlog;
 	struct sl_notify *notify, *current;
+	struct slog_notify_result result;
+	struct slog_notify_lanes lanes;
+	struct slog_notify_stats lane_stats;
+	struct slog_ids ids;
+	uint64_t next_id;
+	size_t i;
 	struct stat sbuf;
 	char *tSev = NULL;
 	int tRepAct = 0;
@@ -208,6 +260,7 @@ main(int argc, char *argv[])
 	}
 
 	memset(&servlog, 0, sizeof(servlog));
+	memset(&ids, 0, sizeof(ids));
 
 	for (;;) {
 		option_index = 0;
@@ -242,6 +295,25 @@ main(int argc, char *argv[])
 			if (action != ACTION_TOOMANY)
 				action = ACTION_QUERY;
 			break;
+		case 'D':
+			if (action != ACTION_UNSPECIFIED)
+				action = ACTION_TOOMANY;
+			if (action != ACTION_TOOMANY)
+				action = ACTION_DISPATCH;
+			if (slog_ids_parse(&ids, optarg, query,
+					   sizeof(query)) != 0) {
+				fprintf(stderr, "--dispatch argument invalid: "
+					"%s\n\n", query);
+				print_usage();
+				exit(1);
+			}
+			break;
+		case 's':
+			stats = 1;
+			break;
+		case 'f':
+			metrics_file = optarg;
+			break;
 		case 'i':	/* event ID */
 			id = strtoul(optarg, &next_char, 10);
 			if (optarg[0] == '\0' || *next_char != '\0' ||
@@ -286,6 +358,12 @@ main(int argc, char *argv[])
 			add_flags++;
 			break;
 		case 'M':
+			if (strncmp(optarg, SLOG_METHOD_SOCKET,
+				    strlen(SLOG_METHOD_SOCKET)) == 0) {
+				socket_path = optarg + strlen(SLOG_METHOD_SOCKET);
+				add_flags++;
+				break;
+			}
 			method = valid_method_arg(optarg);
 			if (method == -1) {
 				fprintf(stderr, "--method or -M argument invalid\n");
@@ -345,8 +423,8 @@ main(int argc, char *argv[])
 
 	/* Command-line validation */
 	if (action == ACTION_UNSPECIFIED) {
-		fprintf(stderr, "One of --add, --remove, --query or --list "
-			"is required.\n\n");
+		fprintf(stderr, "One of --add, --remove, --query, --list or "
+			"--dispatch is required.\n\n");
 		print_usage();
 		exit(1);
 	}
@@ -385,8 +463,21 @@ main(int argc, char *argv[])
 	}
 
 	if (action == ACTION_TOOMANY) {
-		fprintf(stderr, "Only one of the --add, --remove, or "
-			"--list options may be specified.\n\n");
+		fprintf(stderr, "Only one of the --add, --remove, --list "
+			"or --dispatch options may be specified.\n\n");
+		print_usage();
+		exit(1);
+	}
+
+	if ((stats || metrics_file) && action != ACTION_LIST) {
+		fprintf(stderr, "The --stats and --metrics-file flags require "
+			"the --list option.\n\n");
+		print_usage();
+		exit(1);
+	}
+	if (metrics_file && !stats) {
+		fprintf(stderr, "The --metrics-file flag requires the --stats "
+			"flag.\n\n");
 		print_usage();
 		exit(1);
 	}
@@ -444,6 +535,27 @@ main(int argc, char *argv[])
 				rc = 1;
 				goto err_out;
 			}
+			if (socket_path) {
+				if (command) {
+					fprintf(stderr, "The --command flag may "
+						"not be used with a socket "
+						"method.\n\n");
+					print_usage();
+					rc = 1;
+					goto err_out;
+				}
+				rc = 0;
+				if (notify_flag & TYPE_EVENTS)
+					rc = add_subscriber(servlog, socket_path,
+							    SL_NOTIFY_EVENTS,
+							    match ? match :
+							    type_match);
+				if (rc == 0 && (notify_flag & TYPE_REPAIRS))
+					rc = add_subscriber(servlog, socket_path,
+							    SL_NOTIFY_REPAIRS,
+							    match ? match : "");
+				break;
+			}
 			if (command == NULL) {
 				fprintf(stderr, "The --command flag must be specified "
 					"with the --add option.\n\n");
@@ -543,6 +655,27 @@ main(int argc, char *argv[])
 				goto err_out;
 			}
 
+			if (stats) {
+				char err[SL_MAX_ERR];
+
+				rc = 0;
+				if (metrics_file) {
+					if (slog_notify_stats_write(metrics_file,
+							servlog->db, err,
+							sizeof(err)) != 0) {
+						fprintf(stderr, "%s\n", err);
+						rc = 2;
+					}
+				}
+				else if (slog_notify_stats_print(stdout,
+							servlog->db) != 0) {
+					fprintf(stderr, "%s\n",
+						sqlite3_errmsg(servlog->db));
+					rc = 2;
+				}
+				break;
+			}
+
 			/*
 			 * Query the database.
 			 *
@@ -588,12 +721,25 @@ main(int argc, char *argv[])
 					fprintf(stderr, "%s\n",
 						servicelog_error(servlog));
 					goto err_out;
-				} else if (notify == NULL) {
+				}
+				if (notify) {
+					servicelog_notify_print(stdout, notify, 2);
+					servicelog_notify_free(notify);
+				}
+				rc = slog_subscriber_print(stdout, servlog);
+				if (rc < 0) {
+					fprintf(stderr, "%s\n",
+						sqlite3_errmsg(servlog->db));
+					rc = 2;
+					goto err_out;
+				} else if (notify == NULL && rc == 0) {
 					fprintf(stderr, "There are no registered "
 						"notification tools.\n");
 					rc = 1;
 					goto err_out;
 				}
+				rc = 0;
+				break;
 			}
 
 			/* display the notification tools */
@@ -603,15 +749,30 @@ main(int argc, char *argv[])
 
 	case ACTION_REMOVE:
 		/* additional command line validation */
-		if ((command == NULL) && (!flag_id)) {
-			fprintf(stderr, "At least one of the --command or --id "
-				"flags must be specified with the --remove "
-				"option.\n\n");
+		if ((command == NULL) && (!flag_id) && !socket_path) {
+			fprintf(stderr, "At least one of the --command, --id "
+				"or --method=socket:<path> flags must be "
+				"specified with the --remove option.\n\n");
 			print_usage();
 			rc = 1;
 			goto err_out;
 		}
 
+		if (socket_path && !command && !flag_id) {
+			rc = slog_subscriber_remove(servlog, socket_path);
+			if (rc < 0) {
+				fprintf(stderr, "%s\n",
+					sqlite3_errmsg(servlog->db));
+				rc = 2;
+			} else if (rc == 0) {
+				fprintf(stderr, "Could not find a subscriber "
+					"at '%s'.\n", socket_path);
+				rc = 1;
+			} else
+				rc = 0;
+			break;
+		}
+
 		/* find the registered notification tool to be removed */
 		if (flag_id) {
 			rc = servicelog_notify_get(servlog, id, &notify);
@@ -648,6 +809,43 @@ main(int argc, char *argv[])
 		servicelog_notify_free(notify);
 		break;
 
+	case ACTION_DISPATCH:
+		/* additional command line validation */
+		if (command || flag_id || add_flags > (type_tmp ? 1 : 0)) {
+			fprintf(stderr, "Only the --type flag may be specified "
+				"with the --dispatch option.\n\n");
+			print_usage();
+			rc = 1;
+			goto err_out;
+		}
+
+		/* the lanes share the deliveries, critical events most */
+		rc = 0;
+		slog_notify_lanes_init(&lanes);
+		memset(&lane_stats, 0, sizeof(lane_stats));
+		notify_flag = (notify_flag == TYPE_REPAIRS) ? SL_NOTIFY_REPAIRS :
+							      SL_NOTIFY_EVENTS;
+		for (i = 0; i < ids.n; i++) {
+			if (slog_notify_lanes_add(&lanes, servlog, notify_flag,
+						  ids.id[i], &lane_stats) != 0) {
+				fprintf(stderr, "Out of memory\n");
+				rc = 2;
+				break;
+			}
+		}
+		while (i == ids.n &&
+		       slog_notify_lanes_next(&lanes, &lane_stats, &next_id)) {
+			if (slog_notify_dispatch(servlog, notify_flag, next_id,
+						 &result) != 0) {
+				fprintf(stderr, "%s\n", result.error);
+				rc = 2;
+			}
+		}
+		slog_notify_stats_flush(&lane_stats, servlog->db);
+		slog_notify_lanes_free(&lanes);
+		slog_ids_free(&ids);
+		break;
+
 	default:
 		fprintf(stderr, "Internal error; unknown action %d\n", action);
 		rc = 1;
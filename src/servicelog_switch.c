@@ -49,8 +49,24 @@ static struct option long_options[] = {
 /* v1 options: */
 	{"query",	    required_argument, NULL, 'q'},
 	{"dump",	    no_argument,       NULL, 'd'},
+	{"export-snapshot", required_argument, NULL, 'x'},
+	{"snapshot",	    required_argument, NULL, 'n'},
+	{"export",	    no_argument,       NULL, 'X'},
+	{"cursor-file",	    required_argument, NULL, 'C'},
+	{"compress",	    required_argument, NULL, 'z'},
+	{"jobs",	    required_argument, NULL, 'j'},
+	{"diff",	    no_argument,       NULL, 'D'},
+	{"incidents",	    no_argument,       NULL, 'I'},
+	{"open",	    no_argument,       NULL, 'O'},
+	{"location",	    required_argument, NULL, 'L'},
+	{"ids",		    required_argument, NULL, 'N'},
 
 /* common options */
+	{"ids-from",	    required_argument, NULL, 'F'},
+	{"recent",	    optional_argument, NULL, 'W'},
+	{"analyze",	    required_argument, NULL, 'A'},
+	{"timeout",	    required_argument, NULL, 'T'},
+	{"max-rows",	    required_argument, NULL, 'M'},
 	{"help",	    no_argument,       NULL, 'h'},
 	{"verbose",	    no_argument,       NULL, 'v'},
 	{"version",	    no_argument,       NULL, 'V'},
@@ -66,7 +82,8 @@ static char *v1_usage[] = { v1_cmd, "-h", NULL };
 static void
 setup_failed(const char *why)
 {
-	fprintf(stderr, "%s: cannot find v1_servicelog and/or v29_servicelog\n",								cmd);
+	fprintf(stderr, "%s: cannot find v1_servicelog and/or "
+		"v29_servicelog\n", cmd);
 	fprintf(stderr, "%s\n", why);
 }
 
@@ -177,13 +194,27 @@ main(int argc, char **argv)
 	for (;;) {
 		option_index = 0;
 
-		rc = getopt_long(argc, argv, "dE:e:hi:q:R:r:S:s:t:Vv",
-					long_options, &option_index);
+		rc = getopt_long(argc, argv,
+			"A:C:DdE:e:F:hIi:j:L:M:N:n:Oq:R:r:S:s:T:t:VvW::Xx:z:",
+			long_options, &option_index);
 		if (rc == -1)
 			break;
 		switch (rc) {
+		case 'A':
+		case 'C':
+		case 'D':
 		case 'd':
+		case 'I':
+		case 'j':
+		case 'L':
+		case 'N':
+		case 'n':
+		case 'O':
 		case 'q':
+		case 'W':
+		case 'X':
+		case 'x':
+		case 'z':
 			v1_opts++;
 			break;
 		case 'E':
@@ -199,6 +230,9 @@ main(int argc, char **argv)
 		case 'V':
 			printf("%s: Version %s\n", cmd, VERSION);
 			exit(0);
+		case 'F':
+		case 'M':
+		case 'T':
 		case 'v':
 			break;
 		case 'h':
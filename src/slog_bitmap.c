@@ -0,0 +1,171 @@
+/**
+ * @file slog_bitmap.c
+ * @brief Count the events of a snapshot from its value bitmaps
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "slog_bitmap.h"
+
+/* The snapshot column of each of the small filter columns */
+static const int snap_col[SLOG_FILTER_N_SMALL] = {
+	[SLOG_FILTER_TYPE]		= SNAP_COL_TYPE,
+	[SLOG_FILTER_SEVERITY]		= SNAP_COL_SEVERITY,
+	[SLOG_FILTER_SERVICEABLE]	= SNAP_COL_SERVICEABLE,
+	[SLOG_FILTER_CLOSED]		= SNAP_COL_CLOSED,
+};
+
+#define POPCOUNT(x)	((uint64_t)__builtin_popcountll(x))
+
+/* A word of a bitmap that may be absent, since no row holds its value */
+static inline uint64_t
+bitmap_word(const uint64_t *bitmap, uint64_t i)
+{
+	return bitmap ? bitmap[i] : 0;
+}
+
+/**
+ * slog_bitmap_usable
+ * @brief Check whether a filter can be answered from the bitmaps
+ *
+ * @param snap mapped snapshot
+ * @param filter compiled filter
+ * @return 1 if the snapshot has bitmaps and the filter only compares
+ *	   the columns they cover, 0 otherwise
+ */
+int
+slog_bitmap_usable(const struct slog_snapshot *snap,
+		   const struct slog_filter *filter)
+{
+	int i;
+
+	if (!snap->has_bitmaps)
+		return 0;
+
+	for (i = 0; i < filter->n; i++)
+		if (filter->node[i].kind == SLOG_FILTER_CMP &&
+		    filter->node[i].column >= SLOG_FILTER_N_SMALL)
+			return 0;
+
+	return 1;
+}
+
+/**
+ * eval_node
+ * @brief Evaluate a filter node over a chunk of bitmap words
+ *
+ * @param snap mapped snapshot
+ * @param filter compiled filter
+ * @param n node to evaluate
+ * @param base first word of the chunk
+ * @param nw words in the chunk, up to SLOG_BITMAP_CHUNK
+ * @param out returned rows of the chunk for which the node holds
+ */
+static void
+eval_node(const struct slog_snapshot *snap, const struct slog_filter *filter,
+	  int n, uint64_t base, size_t nw, uint64_t *out)
+{
+	const struct slog_filter_node *node = &filter->node[n];
+	const uint64_t *const *values;
+	uint64_t right[SLOG_BITMAP_CHUNK];
+	const uint64_t *bitmap;
+	size_t i;
+	int v;
+
+	switch (node->kind) {
+	case SLOG_FILTER_AND:
+		eval_node(snap, filter, node->left, base, nw, out);
+		eval_node(snap, filter, node->right, base, nw, right);
+		for (i = 0; i < nw; i++)
+			out[i] &= right[i];
+		return;
+	case SLOG_FILTER_OR:
+		eval_node(snap, filter, node->left, base, nw, out);
+		eval_node(snap, filter, node->right, base, nw, right);
+		for (i = 0; i < nw; i++)
+			out[i] |= right[i];
+		return;
+	}
+
+	/* the OR of the bitmaps of every value the comparison holds for */
+	memset(out, 0, nw * sizeof(*out));
+	values = snap->bitmap[SNAP_BITMAP_INDEX(snap_col[node->column])];
+	for (v = 0; v < SNAP_BITMAP_VALUES; v++) {
+		bitmap = values[v];
+		if (bitmap == NULL ||
+		    !slog_filter_compare(node->op, v, node->value))
+			continue;
+		for (i = 0; i < nw; i++)
+			out[i] |= bitmap[base + i];
+	}
+}
+
+/**
+ * slog_bitmap_count
+ * @brief Count the events of a snapshot that match a filter
+ *
+ * Only the bitmaps are read, never the rows; the caller checks with
+ * slog_bitmap_usable() first.  The counts are added to stats and sev
+ * as slog_stats_add() would for each matching row.
+ *
+ * @param snap mapped snapshot
+ * @param filter compiled filter over type, severity, serviceable and
+ *		 closed
+ * @param stats counts by type
+ * @param sev counts by severity, SL_SEV_FATAL + 1 of them
+ */
+void
+slog_bitmap_count(const struct slog_snapshot *snap,
+		  const struct slog_filter *filter, struct slog_stats *stats,
+		  uint64_t *sev)
+{
+	const uint64_t *const *type =
+		snap->bitmap[SNAP_BITMAP_INDEX(SNAP_COL_TYPE)];
+	const uint64_t *const *severity =
+		snap->bitmap[SNAP_BITMAP_INDEX(SNAP_COL_SEVERITY)];
+	const uint64_t *service =
+		snap->bitmap[SNAP_BITMAP_INDEX(SNAP_COL_SERVICEABLE)][1];
+	const uint64_t *closed =
+		snap->bitmap[SNAP_BITMAP_INDEX(SNAP_COL_CLOSED)][1];
+	uint64_t match[SLOG_BITMAP_CHUNK];
+	uint64_t base, m, svc, open, shut, w;
+	struct slog_type_stats *ts;
+	size_t i, nw;
+	int t, s;
+
+	for (base = 0; base < snap->nwords; base += nw) {
+		nw = snap->nwords - base;
+		if (nw > SLOG_BITMAP_CHUNK)
+			nw = SLOG_BITMAP_CHUNK;
+		eval_node(snap, filter, filter->root, base, nw, match);
+
+		for (i = 0; i < nw; i++) {
+			m = match[i];
+			if (m == 0)
+				continue;
+			svc = m & bitmap_word(service, base + i);
+			shut = svc & bitmap_word(closed, base + i);
+			open = svc & ~shut;
+
+			stats->n_events += POPCOUNT(m);
+			stats->n_open += POPCOUNT(open);
+			for (t = 0; t < SLOG_STATS_NTYPES; t++) {
+				w = m & bitmap_word(type[t], base + i);
+				if (w == 0)
+					continue;
+				ts = &stats->type[t];
+				ts->total += POPCOUNT(w);
+				ts->open += POPCOUNT(w & open);
+				ts->closed += POPCOUNT(w & shut);
+				ts->info += POPCOUNT(w & ~svc);
+			}
+			for (s = 0; s <= SL_SEV_FATAL; s++)
+				sev[s] += POPCOUNT(m & bitmap_word(severity[s],
+								   base + i));
+		}
+	}
+}
@@ -0,0 +1,33 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_BITMAP_H
+#define SLOG_BITMAP_H
+
+#include <stdint.h>
+
+#include "slog_snapshot.h"
+#include "slog_filter.h"
+#include "slog_stats.h"
+
+/*
+ * Counts over the value bitmaps of a snapshot
+ *
+ * A filter that only compares type, severity, serviceable and closed
+ * is answered without reading the rows: each comparison is the OR of
+ * the bitmaps of the values it holds for, AND and OR combine those
+ * word by word, and the counts are popcounts of the result ANDed with
+ * the bitmaps of each type, severity and flag.  The words are
+ * evaluated SLOG_BITMAP_CHUNK at a time, so nothing is allocated.
+ */
+#define SLOG_BITMAP_CHUNK	64	/* words, or 4096 rows */
+
+extern int slog_bitmap_usable(const struct slog_snapshot *snap,
+			      const struct slog_filter *filter);
+extern void slog_bitmap_count(const struct slog_snapshot *snap,
+			      const struct slog_filter *filter,
+			      struct slog_stats *stats, uint64_t *sev);
+
+#endif
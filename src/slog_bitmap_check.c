@@ -0,0 +1,348 @@
+/**
+ * @file slog_bitmap_check.c
+ * @brief Check slog_bitmap_count() against a scan of the snapshot rows
+ *
+ * Writes snapshots of random events with slog_snapshot_write(), some of
+ * them shorter than a bitmap word or a chunk and some not a multiple
+ * of either, then counts each of a fixed set of filters and a series of
+ * random ones with slog_bitmap_count() and with slog_select() over
+ * batches of the mapped rows, and compares the counts by type and by
+ * severity.
+ *
+ * With -b, it instead times both over a snapshot of a million events
+ * and prints the cost per event of each filter.
+ *
+ * It only uses memory and a temporary file, so it is run by "make
+ * check" when built with --with-test.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "slog_bitmap.h"
+#include "slog_select.h"
+
+#define N_RANDOM	200	/* random filters per snapshot */
+#define BENCH_ROWS	1000000	/* events in the snapshot with -b */
+#define BENCH_RUNS	20	/* counts per filter with -b */
+
+static const char *filters[] = {
+	"severity>=$WARNING",
+	"severity<>4",
+	"type=$OS",
+	"type<1 OR type>6",
+	"serviceable=1 AND closed=0",
+	"closed!=1",
+	"severity>=$WARNING AND serviceable=1 AND (closed=0 OR type=$OS)",
+	"(type=1 OR severity=2) AND (closed=1 OR serviceable=0)",
+	"severity=300",
+	"severity<300",
+	"type>-1",
+	"type=-1 OR closed=1",
+};
+
+#define N_FILTERS	(sizeof(filters) / sizeof(filters[0]))
+
+static const uint64_t sizes[] = { 0, 1, 63, 64, 65, 4095, 4097, 20000 };
+
+#define N_SIZES		(sizeof(sizes) / sizeof(sizes[0]))
+
+static const char *column_names[SLOG_FILTER_N_SMALL] = {
+	"type", "severity", "serviceable", "closed"
+};
+
+static const char *op_names[] = { "=", "<>", "<", "<=", ">", ">=" };
+
+static uint64_t state = 0x9e3779b97f4a7c15ULL;
+
+/* xorshift64*, so that a failure can be reproduced from the seed */
+static uint64_t
+next_random(void)
+{
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 0x2545f4914f6cdd1dULL;
+}
+
+static int64_t
+random_range(int64_t lo, int64_t hi)
+{
+	return lo + (int64_t)(next_random() % (uint64_t)(hi - lo + 1));
+}
+
+/* Write a random filter of up to about 8 comparisons */
+static void
+random_filter(char *buf, size_t len, int depth)
+{
+	size_t used;
+
+	if (depth < 3 && random_range(0, 2) != 0) {
+		used = snprintf(buf, len, "(");
+		random_filter(buf + used, len - used, depth + 1);
+		used = strlen(buf);
+		used += snprintf(buf + used, len - used, ") %s (",
+				 random_range(0, 1) ? "AND" : "OR");
+		random_filter(buf + used, len - used, depth + 1);
+		used = strlen(buf);
+		snprintf(buf + used, len - used, ")");
+		return;
+	}
+
+	snprintf(buf, len, "%s%s%lld",
+		 column_names[random_range(0, SLOG_FILTER_N_SMALL - 1)],
+		 op_names[random_range(0, 5)],
+		 (long long)random_range(-1, 9));
+}
+
+/**
+ * write_snapshot
+ * @brief Write a snapshot of random events
+ *
+ * Types and severities run past the known ones, so that the counts of
+ * events of no known type or severity are covered.
+ *
+ * @return 0 on success, -1 on failure
+ */
+static int
+write_snapshot(const char *path, uint64_t nrows)
+{
+	struct sl_event *events, *list = NULL;
+	char err[256];
+	uint64_t i;
+	int rc;
+
+	events = calloc(nrows ? nrows : 1, sizeof(*events));
+	if (events == NULL) {
+		fprintf(stderr, "Out of memory\n");
+		return -1;
+	}
+	/* in descending id order, so that the writer has to sort them */
+	for (i = 0; i < nrows; i++) {
+		events[i].id = i + 1;
+		events[i].time_logged = events[i].time_event = 1000000 + i;
+		events[i].type = random_range(0, 7);
+		events[i].severity = random_range(0, 9);
+		events[i].serviceable = random_range(0, 1);
+		events[i].closed = random_range(0, 1);
+		events[i].next = list;
+		list = &events[i];
+	}
+
+	rc = slog_snapshot_write(path, &list, err, sizeof(err));
+	if (rc != 0)
+		fprintf(stderr, "%s\n", err);
+	free(events);
+	return rc;
+}
+
+/* The batched scan of the mapped rows, as servicelog --snapshot does */
+static void
+count_scanned(const struct slog_snapshot *snap,
+	      const struct slog_filter *filter, struct slog_stats *stats,
+	      uint64_t *sev)
+{
+	struct slog_batch batch;
+	uint16_t sel[SLOG_SELECT_BATCH];
+	uint64_t row, i;
+	size_t k, n;
+
+	for (row = 0; row < snap->nrows; row += batch.n) {
+		batch.n = snap->nrows - row;
+		if (batch.n > SLOG_SELECT_BATCH)
+			batch.n = SLOG_SELECT_BATCH;
+		batch.type = snap->type + row;
+		batch.severity = snap->severity + row;
+		batch.serviceable = snap->serviceable + row;
+		batch.closed = snap->closed + row;
+		batch.time_logged = snap->time_logged + row;
+		batch.time_event = snap->time_event + row;
+
+		n = slog_select(filter, &batch, sel);
+		for (k = 0; k < n; k++) {
+			i = row + sel[k];
+			slog_stats_add(stats, snap->type[i], snap->serviceable[i],
+				       snap->closed[i]);
+			if (snap->severity[i] <= SL_SEV_FATAL)
+				sev[snap->severity[i]]++;
+		}
+	}
+}
+
+/**
+ * check_filter
+ * @brief Compare the bitmap and scanned counts of a filter
+ *
+ * @return 0 if they agree, 1 otherwise
+ */
+static int
+check_filter(const struct slog_snapshot *snap, const char *text)
+{
+	struct slog_filter filter;
+	struct slog_stats stats, want;
+	uint64_t sev[SL_SEV_FATAL + 1], want_sev[SL_SEV_FATAL + 1];
+	char err[256];
+
+	if (slog_filter_parse(text, &filter, err, sizeof(err)) != 0) {
+		printf("FAIL: %s: %s\n", text, err);
+		return 1;
+	}
+	if (!slog_bitmap_usable(snap, &filter)) {
+		printf("FAIL: %s: not answered from the bitmaps\n", text);
+		return 1;
+	}
+
+	memset(&stats, 0, sizeof(stats));
+	memset(&want, 0, sizeof(want));
+	memset(sev, 0, sizeof(sev));
+	memset(want_sev, 0, sizeof(want_sev));
+	slog_bitmap_count(snap, &filter, &stats, sev);
+	count_scanned(snap, &filter, &want, want_sev);
+
+	if (memcmp(&stats, &want, sizeof(stats)) ||
+	    memcmp(sev, want_sev, sizeof(sev))) {
+		printf("FAIL: %s: %d of %llu events counted instead of %d\n",
+		       text, stats.n_events, (unsigned long long)snap->nrows,
+		       want.n_events);
+		return 1;
+	}
+	return 0;
+}
+
+static double
+elapsed_ns(struct timespec *start)
+{
+	struct timespec end;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) * 1e9 +
+		(end.tv_nsec - start->tv_nsec);
+}
+
+static void
+bench_filter(const struct slog_snapshot *snap, const char *text)
+{
+	struct slog_filter filter;
+	struct slog_stats stats;
+	uint64_t sev[SL_SEV_FATAL + 1];
+	struct timespec start;
+	double bitmap_ns, scan_ns;
+	char err[256];
+	int r;
+
+	if (slog_filter_parse(text, &filter, err, sizeof(err)) != 0) {
+		printf("%s: %s\n", text, err);
+		return;
+	}
+
+	memset(&stats, 0, sizeof(stats));
+	memset(sev, 0, sizeof(sev));
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (r = 0; r < BENCH_RUNS; r++)
+		slog_bitmap_count(snap, &filter, &stats, sev);
+	bitmap_ns = elapsed_ns(&start);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (r = 0; r < BENCH_RUNS; r++)
+		count_scanned(snap, &filter, &stats, sev);
+	scan_ns = elapsed_ns(&start);
+
+	printf("%9.3f %8.3f  %5.1f%%  %s\n",
+	       bitmap_ns / BENCH_RUNS / snap->nrows,
+	       scan_ns / BENCH_RUNS / snap->nrows,
+	       100.0 * stats.n_events / (2.0 * BENCH_RUNS * snap->nrows),
+	       text);
+}
+
+static void
+print_usage(const char *cmd)
+{
+	printf("Usage: %s [-b] [-s seed]\n", cmd);
+	printf("  -b: time slog_bitmap_count() against a scan of the rows\n");
+	printf("  -s: seed of the random events and filters\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+	struct slog_snapshot snap;
+	char path[] = "/tmp/slog_bitmap_check.XXXXXX";
+	char text[1024];
+	int c, fd, bench = 0, failed = 0, checked = 0;
+	size_t i, j;
+
+	while ((c = getopt(argc, argv, "bs:h")) != -1) {
+		switch (c) {
+		case 'b':
+			bench = 1;
+			break;
+		case 's':
+			state = strtoull(optarg, NULL, 0);
+			if (state == 0) {
+				fprintf(stderr, "%s: the seed must not be "
+					"0\n", argv[0]);
+				exit(1);
+			}
+			break;
+		case 'h':
+			print_usage(argv[0]);
+			exit(0);
+		default:
+			print_usage(argv[0]);
+			exit(1);
+		}
+	}
+
+	/* slog_snapshot_write() renames its own file over this one */
+	fd = mkstemp(path);
+	if (fd < 0) {
+		perror(path);
+		exit(1);
+	}
+	close(fd);
+
+	for (i = 0; i < (bench ? 1 : N_SIZES); i++) {
+		memset(&snap, 0, sizeof(snap));
+		if (write_snapshot(path, bench ? BENCH_ROWS : sizes[i]) != 0 ||
+		    slog_snapshot_open(path, &snap) != 0) {
+			if (snap.error[0])
+				fprintf(stderr, "%s\n", snap.error);
+			unlink(path);
+			exit(2);
+		}
+		if (!snap.has_bitmaps) {
+			printf("FAIL: snapshot of %llu events has no "
+			       "bitmaps\n", (unsigned long long)snap.nrows);
+			failed++;
+		}
+
+		if (bench) {
+			printf("%9s %8s  %6s  %s\n", "bitmap ns", "scan ns",
+			       "match", "filter (per event)");
+			for (j = 0; j < N_FILTERS; j++)
+				bench_filter(&snap, filters[j]);
+		} else {
+			for (j = 0; j < N_FILTERS; j++)
+				failed += check_filter(&snap, filters[j]);
+			for (j = 0; j < N_RANDOM; j++) {
+				random_filter(text, sizeof(text), 0);
+				failed += check_filter(&snap, text);
+			}
+			checked += N_FILTERS + N_RANDOM;
+		}
+		slog_snapshot_close(&snap);
+	}
+	unlink(path);
+
+	if (bench)
+		return 0;
+	printf("%s: %d filters over %zu snapshots, %d failed\n",
+	       failed ? "FAIL" : "ok", checked, N_SIZES, failed);
+	return failed ? 1 : 0;
+}
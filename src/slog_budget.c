@@ -0,0 +1,157 @@
+/**
+ * @file slog_budget.c
+ * @brief Time and row limits for user-supplied queries
+ *
+ * A query such as "refcode LIKE '%1234%' OR description LIKE ..." scans
+ * the whole events table while holding the shared lock, and rtas_errd
+ * cannot log new events until it finishes.  A budget bounds such a scan
+ * by interrupting the statement from the SQLite progress callback.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "slog_budget.h"
+
+/* virtual machine instructions between two checks of the clock */
+#define PROGRESS_STEPS	1000
+
+/**
+ * slog_budget_parse
+ * @brief Parse the argument of --timeout or --max-rows
+ *
+ * @param arg decimal number; 0 disables the limit
+ * @param value returned number
+ * @return 0 on success, -1 if arg is not a valid number
+ */
+int
+slog_budget_parse(const char *arg, uint64_t *value)
+{
+	char *end;
+
+	if (arg[0] < '0' || arg[0] > '9')
+		return -1;
+	*value = strtoull(arg, &end, 10);
+	return (*end == '\0') ? 0 : -1;
+}
+
+long
+slog_budget_elapsed(struct slog_budget *b)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - b->start.tv_sec) * 1000 +
+		(now.tv_nsec - b->start.tv_nsec) / 1000000;
+}
+
+/*
+ * A non-zero return makes SQLite abandon the running statement with
+ * SQLITE_INTERRUPT; the library then reports the query as failed.
+ */
+static int
+progress(void *arg)
+{
+	struct slog_budget *b = arg;
+
+	if (b->exceeded)
+		return 1;
+	if (b->timeout_ms && slog_budget_elapsed(b) >= b->timeout_ms) {
+		b->exceeded = SLOG_BUDGET_TIME;
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Count the rows of the query on the events table.  The library steps
+ * that statement first and looks up the callouts and type-specific data
+ * of each event only once it has its row, so the statement returning the
+ * first row is the query; the rows of the lookups are not counted.
+ */
+static int
+trace_row(unsigned type, void *arg, void *p, void *x)
+{
+	struct slog_budget *b = arg;
+	sqlite3_stmt *stmt = p;
+	int i;
+
+	if (b->stmt == NULL)
+		b->stmt = stmt;
+	if (stmt != b->stmt)
+		return 0;
+
+	if (b->max_rows && b->rows == b->max_rows) {
+		b->exceeded = SLOG_BUDGET_ROWS;
+		sqlite3_interrupt(sqlite3_db_handle(stmt));
+		return 0;
+	}
+
+	b->rows++;
+	for (i = 0; i < sqlite3_column_count(stmt); i++) {
+		if (strcmp(sqlite3_column_name(stmt, i), "id") == 0) {
+			b->last_id = sqlite3_column_int64(stmt, i);
+			break;
+		}
+	}
+	return 0;
+}
+
+/**
+ * slog_budget_start
+ * @brief Start enforcing a budget on the queries run on a connection
+ *
+ * @param b budget; timeout_ms and max_rows must be set
+ * @param db database connection, or NULL to only start the clock
+ */
+void
+slog_budget_start(struct slog_budget *b, sqlite3 *db)
+{
+	b->rows = 0;
+	b->last_id = 0;
+	b->stmt = NULL;
+	b->exceeded = SLOG_BUDGET_OK;
+	clock_gettime(CLOCK_MONOTONIC, &b->start);
+	if (db == NULL)
+		return;
+
+	sqlite3_progress_handler(db, PROGRESS_STEPS, progress, b);
+	sqlite3_trace_v2(db, SQLITE_TRACE_ROW, trace_row, b);
+}
+
+void
+slog_budget_stop(struct slog_budget *b, sqlite3 *db)
+{
+	sqlite3_progress_handler(db, 0, NULL, NULL);
+	sqlite3_trace_v2(db, 0, NULL, NULL);
+}
+
+/**
+ * slog_budget_report
+ * @brief Explain why a query was stopped, and how far it got
+ *
+ * @param fp stream to print to
+ * @param cmd name of the command
+ * @param b exceeded budget
+ */
+void
+slog_budget_report(FILE *fp, const char *cmd, struct slog_budget *b)
+{
+	if (b->exceeded == SLOG_BUDGET_ROWS)
+		fprintf(fp, "%s: Query stopped: more than %" PRIu64 " events "
+			"matched\n", cmd, b->max_rows);
+	else
+		fprintf(fp, "%s: Query stopped: timeout of %ld ms expired\n",
+			cmd, b->timeout_ms);
+
+	fprintf(fp, "%s: %" PRIu64 " events were returned in %ld ms",
+		cmd, b->rows, slog_budget_elapsed(b));
+	if (b->rows)
+		fprintf(fp, "; the last was event %" PRIu64, b->last_id);
+	fprintf(fp, "\n");
+}
@@ -0,0 +1,41 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_BUDGET_H
+#define SLOG_BUDGET_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <sqlite3.h>
+
+/* Exit status of a command whose query ran out of budget */
+#define SLOG_EXIT_BUDGET	5
+
+enum {
+	SLOG_BUDGET_OK = 0,
+	SLOG_BUDGET_TIME,	/* the timeout expired */
+	SLOG_BUDGET_ROWS,	/* more than max_rows events matched */
+};
+
+/* Limits on a single query; 0 means no limit */
+struct slog_budget {
+	long timeout_ms;
+	uint64_t max_rows;
+	struct timespec start;
+	uint64_t rows;		/* events returned so far */
+	uint64_t last_id;	/* id of the last event returned */
+	sqlite3_stmt *stmt;	/* query whose rows are counted */
+	int exceeded;		/* SLOG_BUDGET_* */
+};
+
+extern int slog_budget_parse(const char *arg, uint64_t *value);
+extern void slog_budget_start(struct slog_budget *b, sqlite3 *db);
+extern void slog_budget_stop(struct slog_budget *b, sqlite3 *db);
+extern long slog_budget_elapsed(struct slog_budget *b);
+extern void slog_budget_report(FILE *fp, const char *cmd,
+			       struct slog_budget *b);
+
+#endif
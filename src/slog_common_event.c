@@ -29,6 +29,9 @@
 #include <servicelog-1/servicelog.h>
 #include "config.h"
 #include "platform.h"
+#include "slog_index.h"
+#include "slog_recent.h"
+#include "slog_subscriber.h"
 
 static struct option long_options[] = {
 	{"event",       required_argument, NULL, 'e'},
@@ -79,6 +82,9 @@ main(int argc, char **argv) {
 	servicelog *slog;
 	struct sl_event event;
 	uint64_t event_id;
+	struct slog_notify_result result;
+	char err[SL_MAX_ERR];
+	int64_t committed;
 
 	for (;;) {
 		option_index = 0;
@@ -217,6 +223,11 @@ main(int argc, char **argv) {
 		exit(2);
 	}
 
+	/*
+	 * The event is committed inside servicelog_event_log(), which then
+	 * runs the notification tools; the subscribers wait for them too.
+	 */
+	committed = slog_notify_stats_usec();
 	rc = servicelog_event_log(slog, &event, &event_id);
 	if (rc) {
 		if (verbose) {
@@ -226,6 +237,19 @@ main(int argc, char **argv) {
 		servicelog_close(slog);
 		exit(3);
 	}
+	event.id = event_id;
+	slog_recent_publish(&event);
+
+	/* libservicelog has run the notification tools, but not this */
+	if (slog_subscriber_logged(slog, SL_NOTIFY_EVENTS, event_id, committed,
+				   &result) != 0 && verbose)
+		fprintf(stderr, "%s: %s\n", argv[0], result.error);
+
+	/* the servicelog may not have existed when the package installed */
+	if (slog_index_present(slog) == 0 &&
+	    slog_index_ensure(slog, err, sizeof(err)) != 0 && verbose)
+		fprintf(stderr, "%s: Could not create the indexes: %s\n",
+			argv[0], err);
 
 	if (verbose) {
 		printf("Logged event number ""%" PRIu64 "\n", event_id);
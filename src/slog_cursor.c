@@ -0,0 +1,198 @@
+/**
+ * @file slog_cursor.c
+ * @brief Persisted position of an incremental servicelog export
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include "slog_cursor.h"
+
+#define LENGTH		128
+
+/**
+ * slog_cursor_read
+ * @brief Load a cursor file
+ *
+ * A missing cursor file is not an error: the cursor starts at the
+ * beginning, so that the first export emits the whole servicelog.
+ *
+ * @param path cursor file
+ * @param cursor returned cursor
+ * @param error buffer for an error message
+ * @param error_len size of the error buffer
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_cursor_read(const char *path, struct slog_cursor *cursor, char *error,
+		 size_t error_len)
+{
+	char line[LENGTH], *value, *next_char;
+	unsigned long long val;
+	FILE *fp;
+
+	memset(cursor, 0, sizeof(*cursor));
+
+	fp = fopen(path, "r");
+	if (fp == NULL) {
+		if (errno == ENOENT)
+			return 0;
+		snprintf(error, error_len, "%s: %s", path, strerror(errno));
+		return -1;
+	}
+
+	while (fgets(line, LENGTH, fp)) {
+		line[strcspn(line, "\n")] = '\0';
+		if (line[0] == '#' || line[0] == '\0')
+			continue;
+
+		value = strchr(line, '=');
+		if (value == NULL)
+			goto err_format;
+		*value++ = '\0';
+
+		errno = 0;
+		val = strtoull(value, &next_char, 10);
+		if (value[0] == '\0' || *next_char != '\0' || errno)
+			goto err_format;
+
+		if (!strcmp(line, "event_id"))
+			cursor->event_id = val;
+		else if (!strcmp(line, "event_update"))
+			cursor->event_update = (time_t)val;
+		else if (!strcmp(line, "repair_id"))
+			cursor->repair_id = val;
+		/* unknown keys are ignored */
+	}
+
+	fclose(fp);
+	return 0;
+
+err_format:
+	snprintf(error, error_len, "%s: Invalid cursor file", path);
+	fclose(fp);
+	return -1;
+}
+
+/**
+ * slog_cursor_write
+ * @brief Atomically replace a cursor file
+ *
+ * @param path cursor file
+ * @param cursor cursor to save
+ * @param error buffer for an error message
+ * @param error_len size of the error buffer
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_cursor_write(const char *path, struct slog_cursor *cursor, char *error,
+		  size_t error_len)
+{
+	char tmp_path[PATH_MAX];
+	FILE *fp;
+	int fd;
+
+	if (snprintf(tmp_path, PATH_MAX, "%s.XXXXXX", path) >= PATH_MAX) {
+		snprintf(error, error_len, "%s: %s", path,
+			 strerror(ENAMETOOLONG));
+		return -1;
+	}
+	fd = mkstemp(tmp_path);
+	if (fd < 0) {
+		snprintf(error, error_len, "%s: %s", path, strerror(errno));
+		return -1;
+	}
+	fp = fdopen(fd, "w");
+	if (fp == NULL) {
+		snprintf(error, error_len, "%s: %s", path, strerror(errno));
+		close(fd);
+		unlink(tmp_path);
+		return -1;
+	}
+
+	fprintf(fp, "# servicelog export cursor\n");
+	fprintf(fp, "event_id=%" PRIu64 "\n", cursor->event_id);
+	fprintf(fp, "event_update=%lld\n", (long long)cursor->event_update);
+	fprintf(fp, "repair_id=%" PRIu64 "\n", cursor->repair_id);
+
+	if (fflush(fp) != 0 || fsync(fd) != 0) {
+		snprintf(error, error_len, "%s: %s", path, strerror(errno));
+		fclose(fp);
+		unlink(tmp_path);
+		return -1;
+	}
+	if (fclose(fp) != 0 || rename(tmp_path, path) != 0) {
+		snprintf(error, error_len, "%s: %s", path, strerror(errno));
+		unlink(tmp_path);
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * slog_cursor_event_query
+ * @brief Build the query string selecting events past the cursor
+ *
+ * The watermark comparison is inclusive, so an event updated within the
+ * same second as the last export is emitted again rather than missed.
+ * libservicelog stores time_last_update as local time text, so the
+ * watermark is converted likewise; when the clocks go back, events
+ * updated in the repeated hour may be emitted again, but none is
+ * missed.
+ *
+ * @param cursor export position
+ * @param buf buffer for the query string
+ * @param len size of buf
+ * @return 0 on success, -1 if buf is too small
+ */
+int
+slog_cursor_event_query(struct slog_cursor *cursor, char *buf, size_t len)
+{
+	int n;
+
+	if (cursor->event_id == 0 && cursor->event_update == 0)
+		n = snprintf(buf, len, "%s", "");
+	else
+		n = snprintf(buf, len, "id>%" PRIu64 " OR time_last_update>="
+			     "datetime(%lld, 'unixepoch', 'localtime')",
+			     cursor->event_id,
+			     (long long)cursor->event_update);
+
+	return (n < 0 || (size_t)n >= len) ? -1 : 0;
+}
+
+/**
+ * slog_cursor_advance
+ * @brief Move the cursor past the records that have been exported
+ *
+ * @param cursor export position
+ * @param events exported events
+ * @param repairs exported repair actions
+ */
+void
+slog_cursor_advance(struct slog_cursor *cursor, struct sl_event *events,
+		    struct sl_repair_action *repairs)
+{
+	struct sl_event *e;
+	struct sl_repair_action *r;
+
+	for (e = events; e; e = e->next) {
+		if (e->id > cursor->event_id)
+			cursor->event_id = e->id;
+		if (e->time_last_update > cursor->event_update)
+			cursor->event_update = e->time_last_update;
+	}
+
+	for (r = repairs; r; r = r->next)
+		if (r->id > cursor->repair_id)
+			cursor->repair_id = r->id;
+}
@@ -0,0 +1,34 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_CURSOR_H
+#define SLOG_CURSOR_H
+
+#include <stdint.h>
+#include <time.h>
+#include <servicelog-1/servicelog.h>
+
+/*
+ * Position of an incremental export.  Everything with an id above
+ * event_id/repair_id is new; events with a time_last_update at or after
+ * event_update have changed (e.g., been closed) since the last export.
+ */
+struct slog_cursor {
+	uint64_t event_id;
+	time_t event_update;
+	uint64_t repair_id;
+};
+
+extern int slog_cursor_read(const char *path, struct slog_cursor *cursor,
+			    char *error, size_t error_len);
+extern int slog_cursor_write(const char *path, struct slog_cursor *cursor,
+			     char *error, size_t error_len);
+extern int slog_cursor_event_query(struct slog_cursor *cursor, char *buf,
+				   size_t len);
+extern void slog_cursor_advance(struct slog_cursor *cursor,
+				struct sl_event *events,
+				struct sl_repair_action *repairs);
+
+#endif
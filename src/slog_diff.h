@@ -0,0 +1,27 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_DIFF_H
+#define SLOG_DIFF_H
+
+#include <stdio.h>
+#include <servicelog-1/servicelog.h>
+#include "slog_snapshot.h"
+#include "slog_cursor.h"
+
+struct slog_diff {
+	uint64_t added;
+	uint64_t closed;
+	uint64_t removed;
+	int have_removed;	/* removals can be detected */
+};
+
+extern int slog_diff_snapshots(FILE *fp, struct slog_snapshot *a,
+			       struct slog_snapshot *b, struct slog_diff *diff);
+extern int slog_diff_cursor(FILE *fp, servicelog *slog,
+			    struct slog_cursor *cursor, struct slog_diff *diff);
+extern void slog_diff_print_summary(FILE *fp, struct slog_diff *diff);
+
+#endif
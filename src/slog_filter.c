@@ -0,0 +1,333 @@
+/**
+ * @file slog_filter.c
+ * @brief Compile --query filters over the fixed-width event columns
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <strings.h>
+#include <time.h>
+#include <servicelog-1/servicelog.h>
+
+#include "slog_filter.h"
+#include "slog_query.h"
+
+static const char *column_names[SLOG_FILTER_N_COLUMNS] = {
+	"type", "severity", "serviceable", "closed", "time_logged",
+	"time_event"
+};
+
+static const struct {
+	const char *name;
+	int value;
+} constants[] = {
+	{ "DEBUG",		SL_SEV_DEBUG },
+	{ "INFO",		SL_SEV_INFO },
+	{ "EVENT",		SL_SEV_EVENT },
+	{ "WARNING",		SL_SEV_WARNING },
+	{ "ERROR_LOCAL",	SL_SEV_ERROR_LOCAL },
+	{ "ERROR",		SL_SEV_ERROR },
+	{ "FATAL",		SL_SEV_FATAL },
+	{ "BASIC",		SL_TYPE_BASIC },
+	{ "OS",			SL_TYPE_OS },
+	{ "RTAS",		SL_TYPE_RTAS },
+	{ "ENCLOSURE",		SL_TYPE_ENCLOSURE },
+	{ "BMC",		SL_TYPE_BMC },
+};
+
+#define N_CONSTANTS	(sizeof(constants) / sizeof(constants[0]))
+
+/* longest first, so that ">=" is not taken for ">" */
+static const struct {
+	const char *text;
+	int op;
+} operators[] = {
+	{ ">=", SLOG_FILTER_GE }, { "<=", SLOG_FILTER_LE },
+	{ "<>", SLOG_FILTER_NE }, { "!=", SLOG_FILTER_NE },
+	{ "==", SLOG_FILTER_EQ }, { ">", SLOG_FILTER_GT },
+	{ "<", SLOG_FILTER_LT }, { "=", SLOG_FILTER_EQ },
+};
+
+#define N_OPERATORS	(sizeof(operators) / sizeof(operators[0]))
+
+struct parser {
+	const char *p;
+	struct slog_filter *filter;
+	char *error;
+	size_t error_len;
+	time_t now;
+};
+
+static int
+is_ident(char c)
+{
+	return isalnum((unsigned char)c) || c == '_';
+}
+
+static void
+skip_space(struct parser *ps)
+{
+	while (isspace((unsigned char)*ps->p))
+		ps->p++;
+}
+
+/* Consume a keyword, not followed by more identifier characters */
+static int
+match_word(struct parser *ps, const char *word)
+{
+	size_t len = strlen(word);
+
+	skip_space(ps);
+	if (strncasecmp(ps->p, word, len) != 0 || is_ident(ps->p[len]))
+		return 0;
+	ps->p += len;
+	return 1;
+}
+
+static int
+fail(struct parser *ps, const char *what)
+{
+	snprintf(ps->error, ps->error_len, "%s at \"%.20s\"", what, ps->p);
+	return -1;
+}
+
+static int
+new_node(struct parser *ps, int kind, int left, int right)
+{
+	struct slog_filter_node *node;
+
+	if (ps->filter->n == SLOG_FILTER_MAX_NODES)
+		return fail(ps, "Query too long");
+
+	node = &ps->filter->node[ps->filter->n];
+	memset(node, 0, sizeof(*node));
+	node->kind = kind;
+	node->left = left;
+	node->right = right;
+	return ps->filter->n++;
+}
+
+static int
+parse_value(struct parser *ps, int64_t *value)
+{
+	char *end;
+	size_t i, len;
+
+	skip_space(ps);
+	if (*ps->p == '$') {
+		for (len = 1; is_ident(ps->p[len]); len++)
+			;
+		for (i = 0; i < N_CONSTANTS; i++)
+			if (strlen(constants[i].name) == len - 1 &&
+			    strncasecmp(ps->p + 1, constants[i].name,
+					len - 1) == 0)
+				break;
+		if (i == N_CONSTANTS)
+			return fail(ps, "Unknown constant");
+		*value = constants[i].value;
+		ps->p += len;
+		return 0;
+	}
+
+	if (!isdigit((unsigned char)*ps->p) && *ps->p != '-')
+		return fail(ps, "Expected a number or $NAME");
+	*value = strtoll(ps->p, &end, 10);
+	if (end == ps->p || is_ident(*end))
+		return fail(ps, "Expected a number or $NAME");
+	ps->p = end;
+	return 0;
+}
+
+/* Parse a duration made of identifier characters, e.g., "30d" */
+static int
+parse_duration(struct parser *ps, long long *seconds)
+{
+	char buf[32];
+	size_t len;
+
+	skip_space(ps);
+	for (len = 0; is_ident(ps->p[len]); len++)
+		;
+	if (len == 0 || len >= sizeof(buf))
+		return fail(ps, "Expected a duration");
+	memcpy(buf, ps->p, len);
+	buf[len] = '\0';
+	if (slog_query_duration(buf, seconds) != 0)
+		return fail(ps, "Expected a duration");
+	ps->p += len;
+	return 0;
+}
+
+/* time value := number | now [ - duration ] */
+static int
+parse_time(struct parser *ps, int64_t *value)
+{
+	long long seconds = 0;
+
+	if (!match_word(ps, "now"))
+		return parse_value(ps, value);
+
+	skip_space(ps);
+	if (*ps->p == '-') {
+		ps->p++;
+		if (parse_duration(ps, &seconds) != 0)
+			return -1;
+	}
+	*value = (int64_t)ps->now - seconds;
+	return 0;
+}
+
+static int parse_or(struct parser *ps);
+
+/*
+ * factor := '(' or ')' | column op value | time_column op time
+ *	   | time_column WITHIN duration
+ */
+static int
+parse_factor(struct parser *ps)
+{
+	struct slog_filter_node *node;
+	int i, n, column;
+
+	skip_space(ps);
+	if (*ps->p == '(') {
+		ps->p++;
+		n = parse_or(ps);
+		if (n < 0)
+			return -1;
+		skip_space(ps);
+		if (*ps->p != ')')
+			return fail(ps, "Expected )");
+		ps->p++;
+		return n;
+	}
+
+	for (column = 0; column < SLOG_FILTER_N_COLUMNS; column++)
+		if (match_word(ps, column_names[column]))
+			break;
+	if (column == SLOG_FILTER_N_COLUMNS)
+		return fail(ps, "Expected type, severity, serviceable, "
+			    "closed, time_logged or time_event");
+
+	n = new_node(ps, SLOG_FILTER_CMP, -1, -1);
+	if (n < 0)
+		return -1;
+	node = &ps->filter->node[n];
+	node->column = column;
+
+	if (column >= SLOG_FILTER_N_SMALL && match_word(ps, "within")) {
+		long long seconds;
+
+		if (parse_duration(ps, &seconds) != 0)
+			return -1;
+		node->op = SLOG_FILTER_GE;
+		node->value = (int64_t)ps->now - seconds;
+		return n;
+	}
+
+	skip_space(ps);
+	for (i = 0; i < (int)N_OPERATORS; i++)
+		if (strncmp(ps->p, operators[i].text,
+			    strlen(operators[i].text)) == 0)
+			break;
+	if (i == (int)N_OPERATORS)
+		return fail(ps, "Expected a comparison");
+	node->op = operators[i].op;
+	ps->p += strlen(operators[i].text);
+
+	if ((column >= SLOG_FILTER_N_SMALL ? parse_time(ps, &node->value) :
+	     parse_value(ps, &node->value)) != 0)
+		return -1;
+	return n;
+}
+
+/* and := factor { AND factor } */
+static int
+parse_and(struct parser *ps)
+{
+	int left, right;
+
+	left = parse_factor(ps);
+	while (left >= 0 && match_word(ps, "AND")) {
+		right = parse_factor(ps);
+		if (right < 0)
+			return -1;
+		left = new_node(ps, SLOG_FILTER_AND, left, right);
+	}
+	return left;
+}
+
+/* or := and { OR and } */
+static int
+parse_or(struct parser *ps)
+{
+	int left, right;
+
+	left = parse_and(ps);
+	while (left >= 0 && match_word(ps, "OR")) {
+		right = parse_and(ps);
+		if (right < 0)
+			return -1;
+		left = new_node(ps, SLOG_FILTER_OR, left, right);
+	}
+	return left;
+}
+
+/**
+ * slog_filter_parse
+ * @brief Compile a query string over the fixed-width event columns
+ *
+ * @param text query, e.g., "severity>=$WARNING AND closed=0"
+ * @param filter returned compiled filter
+ * @param error buffer for an error message
+ * @param error_len size of error
+ * @return 0 on success, -1 if the query uses anything else
+ */
+int
+slog_filter_parse(const char *text, struct slog_filter *filter, char *error,
+		  size_t error_len)
+{
+	struct parser ps = { text, filter, error, error_len, time(NULL) };
+
+	filter->n = 0;
+	filter->root = parse_or(&ps);
+	if (filter->root < 0)
+		return -1;
+
+	skip_space(&ps);
+	if (*ps.p != '\0')
+		return fail(&ps, "Unexpected text");
+	return 0;
+}
+
+/**
+ * slog_filter_compare
+ * @brief Apply a comparison operator
+ *
+ * @return non-zero if "a op b" holds
+ */
+int
+slog_filter_compare(int op, int64_t a, int64_t b)
+{
+	switch (op) {
+	case SLOG_FILTER_EQ:
+		return a == b;
+	case SLOG_FILTER_NE:
+		return a != b;
+	case SLOG_FILTER_LT:
+		return a < b;
+	case SLOG_FILTER_LE:
+		return a <= b;
+	case SLOG_FILTER_GT:
+		return a > b;
+	case SLOG_FILTER_GE:
+		return a >= b;
+	}
+	return 0;
+}
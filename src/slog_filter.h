@@ -0,0 +1,68 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_FILTER_H
+#define SLOG_FILTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Filters over the fixed-width event columns, compiled from the
+ * subset of the --query syntax that compares them with constants:
+ *
+ *   severity>=$WARNING AND serviceable=1 AND (closed=0 OR type=$OS)
+ *   time_event within 30d AND closed=0
+ *
+ * Values are integers or the $NAME of a severity or an event type; the
+ * time columns also take "now", "now-<duration>" and "within
+ * <duration>".  The compiled filter is a tree of nodes; the callers
+ * evaluate it against their own representation of the events.
+ *
+ * The first SLOG_FILTER_N_SMALL columns have small integer domains; the
+ * others are times.
+ */
+#define SLOG_FILTER_TYPE	0
+#define SLOG_FILTER_SEVERITY	1
+#define SLOG_FILTER_SERVICEABLE	2
+#define SLOG_FILTER_CLOSED	3
+#define SLOG_FILTER_N_SMALL	4
+#define SLOG_FILTER_TIME_LOGGED	4
+#define SLOG_FILTER_TIME_EVENT	5
+#define SLOG_FILTER_N_COLUMNS	6
+
+#define SLOG_FILTER_EQ		0
+#define SLOG_FILTER_NE		1
+#define SLOG_FILTER_LT		2
+#define SLOG_FILTER_LE		3
+#define SLOG_FILTER_GT		4
+#define SLOG_FILTER_GE		5
+
+#define SLOG_FILTER_CMP		0	/* column op value */
+#define SLOG_FILTER_AND		1	/* left AND right */
+#define SLOG_FILTER_OR		2	/* left OR right */
+
+#define SLOG_FILTER_MAX_NODES	64
+
+struct slog_filter_node {
+	int kind;		/* SLOG_FILTER_CMP, _AND or _OR */
+	int column;		/* SLOG_FILTER_TYPE ... */
+	int op;			/* SLOG_FILTER_EQ ... */
+	int64_t value;
+	int left;		/* node indexes, for AND and OR */
+	int right;
+};
+
+struct slog_filter {
+	struct slog_filter_node node[SLOG_FILTER_MAX_NODES];
+	int n;
+	int root;
+};
+
+extern int slog_filter_parse(const char *text, struct slog_filter *filter,
+			     char *error, size_t error_len);
+extern int slog_filter_compare(int op, int64_t a, int64_t b);
+
+#endif
@@ -0,0 +1,785 @@
+/**
+ * @file slog_hot.c
+ * @brief Columnar cache of recent events, refreshed incrementally
+ *
+ * Statistics, histograms and top-N reports over the last 30 days are
+ * what is asked for most often, and each used to fetch every event of
+ * the window through libservicelog.  The cache holds only the columns
+ * they aggregate, packed, so that a report is a few sequential passes
+ * over arrays, and a refresh fetches only what changed since the last.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "slog_hot.h"
+
+/* FNV-1a */
+static uint32_t
+dict_hash(const char *s)
+{
+	uint32_t h = 2166136261u;
+
+	while (*s)
+		h = (h ^ (unsigned char)*s++) * 16777619u;
+	return h;
+}
+
+/* Append a string, which the dictionary then owns */
+static int
+dict_push(struct slog_dict *d, char *s)
+{
+	char **tmp;
+
+	if (s == NULL)
+		return -1;
+	if (d->n == d->max) {
+		tmp = realloc(d->str, (d->max ? d->max * 2 : 64) *
+			      sizeof(*tmp));
+		if (tmp == NULL) {
+			free(s);
+			return -1;
+		}
+		d->str = tmp;
+		d->max = d->max ? d->max * 2 : 64;
+	}
+	d->str[d->n++] = s;
+	return 0;
+}
+
+static int
+dict_rehash(struct slog_dict *d, uint32_t size)
+{
+	uint32_t code, h;
+
+	while (size < d->n * 2)
+		size *= 2;
+
+	free(d->hash);
+	d->hash = calloc(size, sizeof(*d->hash));
+	if (d->hash == NULL) {
+		d->hash_size = 0;
+		return -1;
+	}
+	d->hash_size = size;
+
+	/* code 0 is the empty string, which is never looked up */
+	for (code = 1; code < d->n; code++) {
+		h = dict_hash(d->str[code]) & (size - 1);
+		while (d->hash[h])
+			h = (h + 1) & (size - 1);
+		d->hash[h] = code + 1;
+	}
+	return 0;
+}
+
+/**
+ * dict_encode
+ * @brief Find the code of a string, adding it if it is new
+ *
+ * @return 0 on success, -1 if out of memory
+ */
+static int
+dict_encode(struct slog_dict *d, const char *s, uint32_t *code)
+{
+	uint32_t h;
+
+	if (s == NULL || *s == '\0') {
+		*code = 0;
+		return 0;
+	}
+	if ((d->n + 1) * 2 > d->hash_size &&
+	    dict_rehash(d, d->hash_size ? d->hash_size * 2 : 64) != 0)
+		return -1;
+
+	h = dict_hash(s) & (d->hash_size - 1);
+	while (d->hash[h]) {
+		if (strcmp(d->str[d->hash[h] - 1], s) == 0) {
+			*code = d->hash[h] - 1;
+			return 0;
+		}
+		h = (h + 1) & (d->hash_size - 1);
+	}
+
+	if (dict_push(d, strdup(s)) != 0)
+		return -1;
+	*code = d->n - 1;
+	d->hash[h] = d->n;
+	return 0;
+}
+
+/**
+ * dict_compact
+ * @brief Drop the strings no longer used by a column, and renumber
+ *
+ * @param d dictionary
+ * @param codes column of codes, rewritten
+ * @param nrows rows in the column
+ * @return 0 on success, -1 if out of memory
+ */
+static int
+dict_compact(struct slog_dict *d, uint32_t *codes, uint64_t nrows)
+{
+	uint32_t *remap, code, n = 1;
+	uint64_t i;
+
+	remap = calloc(d->n, sizeof(*remap));
+	if (remap == NULL)
+		return -1;
+	for (i = 0; i < nrows; i++)
+		remap[codes[i]] = 1;
+	remap[0] = 0;
+
+	/* codes only move down, so the strings are moved in place */
+	for (code = 1; code < d->n; code++) {
+		if (remap[code]) {
+			remap[code] = n;
+			d->str[n++] = d->str[code];
+		}
+		else
+			free(d->str[code]);
+	}
+	d->n = n;
+
+	for (i = 0; i < nrows; i++)
+		codes[i] = remap[codes[i]];
+	free(remap);
+
+	return dict_rehash(d, 64);
+}
+
+static void
+dict_free(struct slog_dict *d)
+{
+	uint32_t code;
+
+	for (code = 0; code < d->n; code++)
+		free(d->str[code]);
+	free(d->str);
+	free(d->hash);
+	memset(d, 0, sizeof(*d));
+}
+
+static int
+reserve(struct slog_hot *hot, uint64_t nrows)
+{
+	uint64_t max = hot->max ? hot->max : 1024;
+	void *p;
+
+	if (nrows <= hot->max)
+		return 0;
+	/* the widest column must still fit in a size_t */
+	if (nrows > SIZE_MAX / sizeof(*hot->id))
+		return -1;
+	while (max < nrows)
+		max *= 2;
+	if (max > SIZE_MAX / sizeof(*hot->id))
+		max = nrows;
+
+#define GROW(col)						\
+	do {							\
+		p = realloc(hot->col, max * sizeof(*hot->col));	\
+		if (p == NULL)					\
+			return -1;				\
+		hot->col = p;					\
+	} while (0)
+
+	GROW(id);
+	GROW(time_event);
+	GROW(time_logged);
+	GROW(refcode);
+	GROW(location);
+	GROW(type);
+	GROW(severity);
+	GROW(flags);
+#undef GROW
+
+	hot->max = max;
+	return 0;
+}
+
+static const char *
+first_location(struct sl_event *e)
+{
+	struct sl_callout *c;
+
+	for (c = e->callouts; c; c = c->next)
+		if (c->location && c->location[0])
+			return c->location;
+	return NULL;
+}
+
+static uint8_t
+event_flags(struct sl_event *e)
+{
+	return (e->serviceable ? SLOG_HOT_SERVICEABLE : 0) |
+	       (e->closed ? SLOG_HOT_CLOSED : 0);
+}
+
+/* Binary search for the row of an id */
+static int
+find_row(struct slog_hot *hot, uint64_t id, uint64_t *row)
+{
+	uint64_t lo = 0, hi = hot->nrows, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (hot->id[mid] < id)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	*row = lo;
+	return lo < hot->nrows && hot->id[lo] == id;
+}
+
+static int
+compare_ids(const void *a, const void *b)
+{
+	const struct sl_event *x = *(struct sl_event * const *)a;
+	const struct sl_event *y = *(struct sl_event * const *)b;
+
+	return (x->id > y->id) - (x->id < y->id);
+}
+
+/* Drop the rows whose events are older than the window */
+static int
+expire(struct slog_hot *hot, int64_t cutoff)
+{
+	uint64_t i, j;
+
+	for (i = 0, j = 0; i < hot->nrows; i++) {
+		if (hot->time_event[i] < cutoff)
+			continue;
+		if (i != j) {
+			hot->id[j] = hot->id[i];
+			hot->time_event[j] = hot->time_event[i];
+			hot->time_logged[j] = hot->time_logged[i];
+			hot->refcode[j] = hot->refcode[i];
+			hot->location[j] = hot->location[i];
+			hot->type[j] = hot->type[i];
+			hot->severity[j] = hot->severity[i];
+			hot->flags[j] = hot->flags[i];
+		}
+		j++;
+	}
+	if (j == hot->nrows)
+		return 0;
+
+	hot->nrows = j;
+	if (dict_compact(&hot->dict[SLOG_HOT_REFCODE], hot->refcode,
+			 hot->nrows) != 0 ||
+	    dict_compact(&hot->dict[SLOG_HOT_LOCATION], hot->location,
+			 hot->nrows) != 0)
+		return -1;
+	return 0;
+}
+
+/* Bytes of one row, over all of the columns of the file */
+#define ROW_SIZE	(3 * sizeof(uint64_t) + 2 * sizeof(uint32_t) + 3)
+
+/**
+ * check_sizes
+ * @brief Check the counts of a cache file header against the file size
+ *
+ * Everything is bounded by the bytes left in the file before anything
+ * is allocated, so a corrupt header cannot ask for more than that.
+ *
+ * @return 0 if the file is exactly as long as the header says, -1 if not
+ */
+static int
+check_sizes(FILE *fp, struct slog_hot_header *hdr)
+{
+	struct stat st;
+	uint64_t left;
+
+	if (fstat(fileno(fp), &st) != 0 || st.st_size < (off_t)sizeof(*hdr))
+		return -1;
+	left = st.st_size - sizeof(*hdr);
+
+	if (hdr->nrows > left / ROW_SIZE)
+		return -1;
+	left -= hdr->nrows * ROW_SIZE;
+	if (hdr->refcode_size > left)
+		return -1;
+	left -= hdr->refcode_size;
+	if (hdr->location_size != left)
+		return -1;
+
+	/* each string takes at least its NUL */
+	if (hdr->n_refcodes > hdr->refcode_size ||
+	    hdr->n_locations > hdr->location_size)
+		return -1;
+
+	return 0;
+}
+
+static int
+read_array(FILE *fp, void *array, size_t width, uint64_t n)
+{
+	return (n == 0 || fread(array, width, n, fp) == n) ? 0 : -1;
+}
+
+static int
+read_dict(FILE *fp, struct slog_dict *d, uint32_t n, uint64_t size)
+{
+	char *buf, *p, *end;
+	int rc = -1;
+
+	buf = malloc(size + 1);
+	if (buf == NULL)
+		return -1;
+	if (size && fread(buf, size, 1, fp) != 1)
+		goto out;
+	buf[size] = '\0';
+
+	for (p = buf, end = buf + size; p < end; p += strlen(p) + 1)
+		if (dict_push(d, strdup(p)) != 0)
+			goto out;
+	if (d->n != n || n == 0 || d->str[0][0] != '\0')
+		goto out;
+	rc = dict_rehash(d, 64);
+
+out:
+	free(buf);
+	return rc;
+}
+
+/**
+ * slog_hot_load
+ * @brief Read a cache file
+ *
+ * A missing file is an empty cache, which the first refresh fills.
+ *
+ * @param path cache file
+ * @param hot returned cache; hot->error is set on failure
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_hot_load(const char *path, struct slog_hot *hot)
+{
+	struct slog_hot_header hdr;
+	uint64_t i;
+	FILE *fp;
+
+	memset(hot, 0, sizeof(*hot));
+	hot->window = SLOG_HOT_WINDOW;
+
+	fp = fopen(path, "r");
+	if (fp == NULL) {
+		if (errno != ENOENT) {
+			snprintf(hot->error, sizeof(hot->error), "%s: %s",
+				 path, strerror(errno));
+			return -1;
+		}
+		if (dict_push(&hot->dict[SLOG_HOT_REFCODE], strdup("")) ||
+		    dict_push(&hot->dict[SLOG_HOT_LOCATION], strdup("")))
+			goto err_memory;
+		return 0;
+	}
+
+	if (fread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+	    memcmp(hdr.magic, SLOG_HOT_MAGIC, sizeof(hdr.magic)) != 0 ||
+	    hdr.version != SLOG_HOT_VERSION ||
+	    hdr.byte_order != SLOG_HOT_BYTE_ORDER) {
+		snprintf(hot->error, sizeof(hot->error), "%s: Not a servicelog "
+			 "cache file, or written by another version", path);
+		goto err_close;
+	}
+	if (hdr.window <= 0 || check_sizes(fp, &hdr) != 0)
+		goto err_corrupt;
+
+	hot->window = hdr.window;
+	hot->cursor.event_id = hdr.event_id;
+	hot->cursor.event_update = hdr.event_update;
+	if (reserve(hot, hdr.nrows) != 0)
+		goto err_memory;
+	hot->nrows = hdr.nrows;
+
+	if (read_array(fp, hot->id, sizeof(*hot->id), hot->nrows) ||
+	    read_array(fp, hot->time_event, sizeof(*hot->time_event),
+		       hot->nrows) ||
+	    read_array(fp, hot->time_logged, sizeof(*hot->time_logged),
+		       hot->nrows) ||
+	    read_array(fp, hot->refcode, sizeof(*hot->refcode), hot->nrows) ||
+	    read_array(fp, hot->location, sizeof(*hot->location),
+		       hot->nrows) ||
+	    read_array(fp, hot->type, 1, hot->nrows) ||
+	    read_array(fp, hot->severity, 1, hot->nrows) ||
+	    read_array(fp, hot->flags, 1, hot->nrows) ||
+	    read_dict(fp, &hot->dict[SLOG_HOT_REFCODE], hdr.n_refcodes,
+		      hdr.refcode_size) ||
+	    read_dict(fp, &hot->dict[SLOG_HOT_LOCATION], hdr.n_locations,
+		      hdr.location_size))
+		goto err_corrupt;
+
+	for (i = 0; i < hot->nrows; i++)
+		if (hot->refcode[i] >= hdr.n_refcodes ||
+		    hot->location[i] >= hdr.n_locations ||
+		    (i && hot->id[i] <= hot->id[i - 1]))
+			goto err_corrupt;
+
+	fclose(fp);
+	return 0;
+
+err_corrupt:
+	snprintf(hot->error, sizeof(hot->error), "%s: Cache file is truncated "
+		 "or corrupt; remove it to rebuild the cache", path);
+	goto err_close;
+err_memory:
+	snprintf(hot->error, sizeof(hot->error), "Out of memory");
+err_close:
+	if (fp)
+		fclose(fp);
+	slog_hot_free(hot);
+	return -1;
+}
+
+/**
+ * slog_hot_refresh
+ * @brief Bring a cache up to date with the database
+ *
+ * The first refresh fetches the events of the window; later ones only
+ * the events logged or updated (e.g., closed) since the last.  Events
+ * that have aged out of the window are dropped.
+ *
+ * @param hot cache
+ * @param slog open servicelog
+ * @param now current time
+ * @return 0 on success, -1 on failure (hot->error is set)
+ */
+int
+slog_hot_refresh(struct slog_hot *hot, servicelog *slog, time_t now)
+{
+	struct sl_event *events = NULL, *e, **added = NULL;
+	int64_t cutoff = (int64_t)now - hot->window;
+	uint64_t last, row;
+	size_t n = 0, n_added = 0, i;
+	char query[256];
+	int rc = -1;
+
+	if (hot->cursor.event_id == 0 && hot->cursor.event_update == 0)
+		snprintf(query, sizeof(query), "time_event >= "
+			 "datetime(%lld, 'unixepoch', 'localtime')",
+			 (long long)cutoff);
+	else
+		slog_cursor_event_query(&hot->cursor, query, sizeof(query));
+
+	if (servicelog_event_query(slog, query, &events) != 0) {
+		snprintf(hot->error, sizeof(hot->error), "%s",
+			 servicelog_error(slog));
+		return -1;
+	}
+
+	for (e = events; e; e = e->next)
+		n++;
+	added = malloc((n ? n : 1) * sizeof(*added));
+	if (added == NULL)
+		goto err_memory;
+
+	last = hot->nrows ? hot->id[hot->nrows - 1] : 0;
+	for (e = events; e; e = e->next) {
+		if (e->id > last) {
+			if (e->time_event >= cutoff)
+				added[n_added++] = e;
+		}
+		else if (find_row(hot, e->id, &row))
+			hot->flags[row] = event_flags(e);
+	}
+
+	/* the cursor query is not returned in id order */
+	qsort(added, n_added, sizeof(*added), compare_ids);
+	if (reserve(hot, hot->nrows + n_added) != 0)
+		goto err_memory;
+
+	for (i = 0; i < n_added; i++) {
+		e = added[i];
+		row = hot->nrows;
+		if (dict_encode(&hot->dict[SLOG_HOT_REFCODE], e->refcode,
+				&hot->refcode[row]) != 0 ||
+		    dict_encode(&hot->dict[SLOG_HOT_LOCATION],
+				first_location(e), &hot->location[row]) != 0)
+			goto err_memory;
+		hot->id[row] = e->id;
+		hot->time_event[row] = e->time_event;
+		hot->time_logged[row] = e->time_logged;
+		hot->type[row] = e->type;
+		hot->severity[row] = e->severity;
+		hot->flags[row] = event_flags(e);
+		hot->nrows++;
+	}
+
+	slog_cursor_advance(&hot->cursor, events, NULL);
+	if (expire(hot, cutoff) != 0)
+		goto err_memory;
+	rc = 0;
+	goto out;
+
+err_memory:
+	snprintf(hot->error, sizeof(hot->error), "Out of memory");
+out:
+	free(added);
+	if (events)
+		servicelog_event_free(events);
+	return rc;
+}
+
+static uint64_t
+dict_size(struct slog_dict *d)
+{
+	uint64_t size = 0;
+	uint32_t code;
+
+	for (code = 0; code < d->n; code++)
+		size += strlen(d->str[code]) + 1;
+	return size;
+}
+
+static int
+write_dict(FILE *fp, struct slog_dict *d)
+{
+	uint32_t code;
+
+	for (code = 0; code < d->n; code++)
+		if (fwrite(d->str[code], strlen(d->str[code]) + 1, 1, fp) != 1)
+			return -1;
+	return 0;
+}
+
+static int
+write_array(FILE *fp, const void *array, size_t width, uint64_t n)
+{
+	return (n == 0 || fwrite(array, width, n, fp) == n) ? 0 : -1;
+}
+
+/**
+ * slog_hot_save
+ * @brief Write a cache file
+ *
+ * The cache is written to a temporary file which is renamed over path
+ * once complete, so that a reader never sees a partial cache.
+ *
+ * @param path cache file
+ * @param hot cache
+ * @return 0 on success, -1 on failure (hot->error is set)
+ */
+int
+slog_hot_save(const char *path, struct slog_hot *hot)
+{
+	struct slog_hot_header hdr;
+	char tmp_path[PATH_MAX];
+	FILE *fp;
+	int fd;
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, SLOG_HOT_MAGIC, sizeof(hdr.magic));
+	hdr.version = SLOG_HOT_VERSION;
+	hdr.byte_order = SLOG_HOT_BYTE_ORDER;
+	hdr.window = hot->window;
+	hdr.event_id = hot->cursor.event_id;
+	hdr.event_update = hot->cursor.event_update;
+	hdr.nrows = hot->nrows;
+	hdr.n_refcodes = hot->dict[SLOG_HOT_REFCODE].n;
+	hdr.n_locations = hot->dict[SLOG_HOT_LOCATION].n;
+	hdr.refcode_size = dict_size(&hot->dict[SLOG_HOT_REFCODE]);
+	hdr.location_size = dict_size(&hot->dict[SLOG_HOT_LOCATION]);
+
+	if (snprintf(tmp_path, PATH_MAX, "%s.XXXXXX", path) >= PATH_MAX) {
+		snprintf(hot->error, sizeof(hot->error), "%s: %s", path,
+			 strerror(ENAMETOOLONG));
+		return -1;
+	}
+	fd = mkstemp(tmp_path);
+	if (fd < 0) {
+		snprintf(hot->error, sizeof(hot->error), "%s: %s", path,
+			 strerror(errno));
+		return -1;
+	}
+	fp = fdopen(fd, "w");
+	if (fp == NULL) {
+		snprintf(hot->error, sizeof(hot->error), "%s: %s", path,
+			 strerror(errno));
+		close(fd);
+		goto err_unlink;
+	}
+
+	if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1 ||
+	    write_array(fp, hot->id, sizeof(*hot->id), hot->nrows) ||
+	    write_array(fp, hot->time_event, sizeof(*hot->time_event),
+			hot->nrows) ||
+	    write_array(fp, hot->time_logged, sizeof(*hot->time_logged),
+			hot->nrows) ||
+	    write_array(fp, hot->refcode, sizeof(*hot->refcode), hot->nrows) ||
+	    write_array(fp, hot->location, sizeof(*hot->location),
+			hot->nrows) ||
+	    write_array(fp, hot->type, 1, hot->nrows) ||
+	    write_array(fp, hot->severity, 1, hot->nrows) ||
+	    write_array(fp, hot->flags, 1, hot->nrows) ||
+	    write_dict(fp, &hot->dict[SLOG_HOT_REFCODE]) ||
+	    write_dict(fp, &hot->dict[SLOG_HOT_LOCATION]) ||
+	    fflush(fp) != 0 || fsync(fileno(fp)) != 0)
+		goto err_write;
+	if (fclose(fp) != 0) {
+		snprintf(hot->error, sizeof(hot->error), "%s: %s", path,
+			 strerror(errno));
+		goto err_unlink;
+	}
+	if (chmod(tmp_path, 0644) != 0 || rename(tmp_path, path) != 0) {
+		snprintf(hot->error, sizeof(hot->error), "%s: %s", path,
+			 strerror(errno));
+		goto err_unlink;
+	}
+	return 0;
+
+err_write:
+	snprintf(hot->error, sizeof(hot->error), "%s: %s", path,
+		 strerror(errno));
+	fclose(fp);
+err_unlink:
+	unlink(tmp_path);
+	return -1;
+}
+
+void
+slog_hot_free(struct slog_hot *hot)
+{
+	free(hot->id);
+	free(hot->time_event);
+	free(hot->time_logged);
+	free(hot->refcode);
+	free(hot->location);
+	free(hot->type);
+	free(hot->severity);
+	free(hot->flags);
+	dict_free(&hot->dict[SLOG_HOT_REFCODE]);
+	dict_free(&hot->dict[SLOG_HOT_LOCATION]);
+	hot->id = NULL;
+	hot->time_event = hot->time_logged = NULL;
+	hot->refcode = hot->location = NULL;
+	hot->type = hot->severity = hot->flags = NULL;
+	hot->nrows = hot->max = 0;
+}
+
+/**
+ * slog_hot_stats
+ * @brief Count the cached events since a time, by type and severity
+ *
+ * @param hot cache
+ * @param since earliest time_event counted
+ * @param stats returned counts by type
+ * @param sev returned counts by severity, SL_SEV_FATAL + 1 entries
+ */
+void
+slog_hot_stats(struct slog_hot *hot, int64_t since, struct slog_stats *stats,
+	       uint64_t *sev)
+{
+	uint64_t counts[UINT8_MAX + 1][4], sevs[UINT8_MAX + 1], i;
+	int t, m;
+
+	memset(counts, 0, sizeof(counts));
+	memset(sevs, 0, sizeof(sevs));
+
+	/* no branch on the rows; flags has the serviceable and closed bits */
+	for (i = 0; i < hot->nrows; i++) {
+		m = hot->time_event[i] >= since;
+		counts[hot->type[i]][hot->flags[i] & 3] += m;
+		sevs[hot->severity[i]] += m;
+	}
+
+	memset(stats, 0, sizeof(*stats));
+	for (t = 0; t < SLOG_STATS_NTYPES; t++) {
+		stats->type[t].info = counts[t][0] + counts[t][SLOG_HOT_CLOSED];
+		stats->type[t].open = counts[t][SLOG_HOT_SERVICEABLE];
+		stats->type[t].closed =
+			counts[t][SLOG_HOT_SERVICEABLE | SLOG_HOT_CLOSED];
+		stats->type[t].total = stats->type[t].info +
+				       stats->type[t].open +
+				       stats->type[t].closed;
+		stats->n_events += stats->type[t].total;
+		stats->n_open += stats->type[t].open;
+	}
+	for (t = 0; t <= SL_SEV_FATAL; t++)
+		sev[t] = sevs[t];
+}
+
+/**
+ * slog_hot_histogram
+ * @brief Count the cached events by time_event bucket and severity
+ *
+ * @param hot cache
+ * @param since start of the first bucket
+ * @param bucket length of each bucket, in seconds
+ * @param counts returned counts, SL_SEV_FATAL + 1 per bucket
+ * @param nbuckets number of buckets
+ */
+void
+slog_hot_histogram(struct slog_hot *hot, int64_t since, int64_t bucket,
+		   uint64_t *counts, size_t nbuckets)
+{
+	uint64_t i, b;
+
+	memset(counts, 0, nbuckets * (SL_SEV_FATAL + 1) * sizeof(*counts));
+	for (i = 0; i < hot->nrows; i++) {
+		if (hot->time_event[i] < since ||
+		    hot->severity[i] > SL_SEV_FATAL)
+			continue;
+		b = (hot->time_event[i] - since) / bucket;
+		if (b < nbuckets)
+			counts[b * (SL_SEV_FATAL + 1) + hot->severity[i]]++;
+	}
+}
+
+/**
+ * slog_hot_top
+ * @brief Find the most frequent values of a dictionary-encoded column
+ *
+ * @param hot cache
+ * @param since earliest time_event counted
+ * @param column SLOG_HOT_REFCODE or SLOG_HOT_LOCATION
+ * @param top returned codes and counts, most frequent first; look the
+ *	  codes up in hot->dict[column]
+ * @param n size of top
+ * @return number of entries in top, or 0 if out of memory
+ */
+size_t
+slog_hot_top(struct slog_hot *hot, int64_t since, int column,
+	     struct slog_hot_count *top, size_t n)
+{
+	const uint32_t *codes = (column == SLOG_HOT_REFCODE) ? hot->refcode :
+				hot->location;
+	uint64_t *counts, i;
+	uint32_t code;
+	size_t k = 0, j;
+
+	if (n == 0)
+		return 0;
+	counts = calloc(hot->dict[column].n ? hot->dict[column].n : 1,
+			sizeof(*counts));
+	if (counts == NULL)
+		return 0;
+	for (i = 0; i < hot->nrows; i++)
+		counts[codes[i]] += hot->time_event[i] >= since;
+
+	/* insertion into a short sorted list; code 0 is a missing value */
+	for (code = 1; code < hot->dict[column].n; code++) {
+		if (counts[code] == 0 ||
+		    (k == n && counts[code] <= top[k - 1].count))
+			continue;
+		j = (k < n) ? k++ : k - 1;
+		for (; j > 0 && top[j - 1].count < counts[code]; j--)
+			top[j] = top[j - 1];
+		top[j].code = code;
+		top[j].count = counts[code];
+	}
+
+	free(counts);
+	return k;
+}
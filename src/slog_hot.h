@@ -0,0 +1,103 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_HOT_H
+#define SLOG_HOT_H
+
+#include <stdint.h>
+#include <time.h>
+#include <servicelog-1/servicelog.h>
+#include "slog_cursor.h"
+#include "slog_stats.h"
+
+/*
+ * Cache of the events of the last SLOG_HOT_WINDOW seconds, by
+ * time_event, held column by column for aggregation
+ *
+ * Times, type, severity and flags are packed arrays in ascending id
+ * order; reference codes and the location of the first callout are
+ * dictionary-encoded as 32-bit codes, code 0 being a missing string.
+ * The cache is kept in a file between runs:
+ *
+ *   struct slog_hot_header
+ *   id, time_event, time_logged     nrows 64-bit values each
+ *   refcode, location               nrows 32-bit codes each
+ *   type, severity, flags           nrows bytes each
+ *   refcode dictionary              n_refcodes NUL-terminated strings
+ *   location dictionary             n_locations NUL-terminated strings
+ *
+ * It is refreshed from the events past an export cursor (slog_cursor.h),
+ * which also brings back the events closed since the last refresh.
+ */
+#define SLOG_HOT_MAGIC		"SLHOT\0\0\0"
+#define SLOG_HOT_VERSION	1
+#define SLOG_HOT_BYTE_ORDER	0x01020304
+#define SLOG_HOT_WINDOW		(30 * 24 * 60 * 60)
+
+#define SLOG_HOT_SERVICEABLE	0x01	/* flags */
+#define SLOG_HOT_CLOSED		0x02
+
+#define SLOG_HOT_REFCODE	0	/* dictionary-encoded columns */
+#define SLOG_HOT_LOCATION	1
+
+struct slog_hot_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	int64_t window;
+	uint64_t event_id;	/* export cursor */
+	int64_t event_update;
+	uint64_t nrows;
+	uint32_t n_refcodes;
+	uint32_t n_locations;
+	uint64_t refcode_size;	/* bytes of each dictionary */
+	uint64_t location_size;
+};
+
+struct slog_dict {
+	char **str;		/* by code; str[0] is "" */
+	uint32_t n;
+	uint32_t max;
+	uint32_t *hash;		/* code + 1 by hash, or 0 */
+	uint32_t hash_size;
+};
+
+struct slog_hot {
+	int64_t window;
+	struct slog_cursor cursor;
+	uint64_t nrows;
+	uint64_t max;
+	uint64_t *id;
+	int64_t *time_event;
+	int64_t *time_logged;
+	uint32_t *refcode;
+	uint32_t *location;
+	uint8_t *type;
+	uint8_t *severity;
+	uint8_t *flags;
+	struct slog_dict dict[2];	/* SLOG_HOT_REFCODE, _LOCATION */
+	char error[SL_MAX_ERR];
+};
+
+struct slog_hot_count {
+	uint32_t code;
+	uint64_t count;
+};
+
+extern int slog_hot_load(const char *path, struct slog_hot *hot);
+extern int slog_hot_refresh(struct slog_hot *hot, servicelog *slog,
+			    time_t now);
+extern int slog_hot_save(const char *path, struct slog_hot *hot);
+extern void slog_hot_free(struct slog_hot *hot);
+
+extern void slog_hot_stats(struct slog_hot *hot, int64_t since,
+			   struct slog_stats *stats, uint64_t *sev);
+extern void slog_hot_histogram(struct slog_hot *hot, int64_t since,
+			       int64_t bucket, uint64_t *counts,
+			       size_t nbuckets);
+extern size_t slog_hot_top(struct slog_hot *hot, int64_t since, int column,
+			   struct slog_hot_count *top, size_t n);
+
+#endif
@@ -0,0 +1,209 @@
+/**
+ * @file slog_ids.c
+ * @brief Parse lists of record ids: "12", "12,15,40-49", files of ids
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <ctype.h>
+#include <inttypes.h>
+
+#include "slog_ids.h"
+
+static int
+add_id(struct slog_ids *ids, uint64_t id, char *error, size_t error_len)
+{
+	uint64_t *tmp;
+
+	if (ids->n == SLOG_IDS_MAX) {
+		snprintf(error, error_len, "More than %d ids requested",
+			 SLOG_IDS_MAX);
+		return -1;
+	}
+
+	if (ids->n == ids->max) {
+		ids->max = ids->max ? ids->max * 2 : 64;
+		tmp = realloc(ids->id, ids->max * sizeof(*tmp));
+		if (tmp == NULL) {
+			snprintf(error, error_len, "Out of memory");
+			return -1;
+		}
+		ids->id = tmp;
+	}
+
+	ids->id[ids->n++] = id;
+	return 0;
+}
+
+/**
+ * parse_item
+ * @brief Parse one id ("12") or inclusive range ("40-49")
+ *
+ * @return end of the item, or NULL on error
+ */
+static const char *
+parse_item(struct slog_ids *ids, const char *p, char *error,
+	   size_t error_len)
+{
+	const char *start = p;
+	uint64_t first, last;
+	char *end;
+
+	if (!isdigit((unsigned char)*p))
+		goto invalid;
+	errno = 0;
+	first = strtoull(p, &end, 10);
+	if (errno == ERANGE)
+		goto range;
+	last = first;
+
+	if (*end == '-') {
+		p = end + 1;
+		if (!isdigit((unsigned char)*p))
+			goto invalid;
+		last = strtoull(p, &end, 10);
+		if (errno == ERANGE)
+			goto range;
+		if (last < first)
+			goto invalid;
+	}
+	if (first == 0)
+		goto invalid;
+
+	if (last - first >= SLOG_IDS_MAX) {
+		snprintf(error, error_len, "More than %d ids requested",
+			 SLOG_IDS_MAX);
+		return NULL;
+	}
+	for (; first <= last; first++)
+		if (add_id(ids, first, error, error_len) != 0)
+			return NULL;
+
+	return end;
+
+invalid:
+	snprintf(error, error_len, "Invalid id or id range at \"%.20s\"",
+		 start);
+	return NULL;
+
+range:
+	snprintf(error, error_len, "Id out of range at \"%.20s\"", start);
+	return NULL;
+}
+
+/**
+ * slog_ids_parse
+ * @brief Append a comma-separated list of ids and ranges
+ *
+ * @param ids list to append to
+ * @param list e.g., "12,15,40-49"
+ * @param error buffer for an error message
+ * @param error_len size of error
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_ids_parse(struct slog_ids *ids, const char *list, char *error,
+	       size_t error_len)
+{
+	const char *p = list;
+
+	for (;;) {
+		p = parse_item(ids, p, error, error_len);
+		if (p == NULL)
+			return -1;
+		if (*p == '\0')
+			return 0;
+		if (*p != ',') {
+			snprintf(error, error_len, "Invalid id list \"%s\"",
+				 list);
+			return -1;
+		}
+		p++;
+	}
+}
+
+/**
+ * slog_ids_read
+ * @brief Append the ids and ranges listed in a file
+ *
+ * Items may be separated by commas or white space, so the output of
+ * a notification tool or of "cut" can be passed in directly.
+ *
+ * @param ids list to append to
+ * @param path file to read, or "-" for stdin
+ * @param error buffer for an error message
+ * @param error_len size of error
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_ids_read(struct slog_ids *ids, const char *path, char *error,
+	      size_t error_len)
+{
+	FILE *fp;
+	const char *end;
+	char item[64];
+	size_t len = 0;
+	int c, rc = 0;
+
+	if (strcmp(path, "-") == 0)
+		fp = stdin;
+	else {
+		fp = fopen(path, "r");
+		if (fp == NULL) {
+			snprintf(error, error_len, "%s: %s", path,
+				 strerror(errno));
+			return -1;
+		}
+	}
+
+	do {
+		c = getc(fp);
+		if (c != EOF && c != ',' && !isspace(c)) {
+			if (len == sizeof(item) - 1) {
+				snprintf(error, error_len, "%s: Invalid id "
+					 "\"%.20s...\"", path, item);
+				rc = -1;
+				break;
+			}
+			item[len++] = c;
+			continue;
+		}
+		if (len == 0)
+			continue;
+
+		item[len] = '\0';
+		len = 0;
+		end = parse_item(ids, item, error, error_len);
+		if (end == NULL) {
+			rc = -1;
+			break;
+		}
+		if (*end != '\0') {
+			snprintf(error, error_len, "%s: Invalid id \"%s\"",
+				 path, item);
+			rc = -1;
+			break;
+		}
+	} while (c != EOF);
+
+	if (rc == 0 && ferror(fp)) {
+		snprintf(error, error_len, "%s: %s", path, strerror(errno));
+		rc = -1;
+	}
+	if (fp != stdin)
+		fclose(fp);
+
+	return rc;
+}
+
+void
+slog_ids_free(struct slog_ids *ids)
+{
+	free(ids->id);
+	memset(ids, 0, sizeof(*ids));
+}
@@ -0,0 +1,28 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_IDS_H
+#define SLOG_IDS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Largest number of ids one command line may request */
+#define SLOG_IDS_MAX	(1 << 20)
+
+/* Record ids, in the order they were requested */
+struct slog_ids {
+	uint64_t *id;
+	size_t n;
+	size_t max;
+};
+
+extern int slog_ids_parse(struct slog_ids *ids, const char *list,
+			  char *error, size_t error_len);
+extern int slog_ids_read(struct slog_ids *ids, const char *path,
+			 char *error, size_t error_len);
+extern void slog_ids_free(struct slog_ids *ids);
+
+#endif
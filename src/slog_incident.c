@@ -0,0 +1,565 @@
+/**
+ * @file slog_incident.c
+ * @brief Group related events into incidents
+ *
+ * A failing adapter typically logs OS, RTAS and enclosure events that
+ * call out locations under the same drawer within seconds of each
+ * other.  Events are streamed in time order, and each one joins the
+ * latest incident of its location prefix if it occurred within
+ * INCIDENT_WINDOW seconds of that incident's first to last event;
+ * otherwise it starts a new incident.  The latest incident of every
+ * prefix is kept in a binary tree, so a pass costs O(log p) per event
+ * for p distinct prefixes, on top of the O(n log n) sort by time.
+ *
+ * The grouping is kept in two tables of a database of its own,
+ * incidents.db next to the servicelog database, which is attached as
+ * "incident"; the schema of the servicelog database belongs to
+ * libservicelog and is left alone:
+ *
+ *   incidents(id, location, time_first, time_last)
+ *   incident_events(event_id, incident)
+ *
+ * Each pass only reads the events logged since the previous one.  When
+ * incidents.db cannot be written, an in-memory database is attached
+ * instead and everything is grouped again.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <search.h>
+#include <time.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <libgen.h>
+#include <unistd.h>
+
+#include "slog_incident.h"
+#include "slog_stats.h"
+
+struct incident {
+	int64_t id;
+	char *location;		/* location prefix, "" if none */
+	int64_t time_first;
+	int64_t time_last;
+	int changed;		/* created or extended by this pass */
+};
+
+struct assignment {
+	int64_t event_id;
+	int64_t incident;
+};
+
+/* Tree node: the incidents of a location prefix an event may join */
+struct active {
+	char *location;
+	size_t idx;		/* index in pass->incidents, or NO_INCIDENT */
+	size_t stored;		/* the latest stored by an earlier pass */
+};
+
+#define NO_INCIDENT	((size_t)-1)
+
+struct pass {
+	sqlite3 *db;
+	sqlite3_stmt *latest;	/* latest stored incident of a prefix */
+	void *tree;		/* of struct active */
+	struct incident *incidents;	/* looked up or created by this pass */
+	size_t n_incidents, max_incidents;
+	size_t n_changed;
+	struct assignment *assigned;
+	size_t n_assigned, max_assigned;
+	int64_t next_id;
+};
+
+#define INCIDENT_DB	"incidents.db"
+
+static const char *schema_sql[] = {
+	"CREATE TABLE IF NOT EXISTS incident.incidents (id INTEGER "
+		"PRIMARY KEY, location TEXT, time_first INTEGER, "
+		"time_last INTEGER)",
+	"CREATE INDEX IF NOT EXISTS incident.incidents_location ON "
+		"incidents(location, time_last)",
+	"CREATE TABLE IF NOT EXISTS incident.incident_events (event_id "
+		"INTEGER PRIMARY KEY, incident INTEGER)",
+	"CREATE INDEX IF NOT EXISTS incident.incident_events_incident ON "
+		"incident_events(incident)",
+};
+
+#define N_SCHEMA_SQL	(sizeof(schema_sql) / sizeof(schema_sql[0]))
+
+static int
+compare_active(const void *a, const void *b)
+{
+	return strcmp(((const struct active *)a)->location,
+		      ((const struct active *)b)->location);
+}
+
+static void
+free_active(void *node)
+{
+	free(((struct active *)node)->location);
+	free(node);
+}
+
+/* The first INCIDENT_DEPTH '-'-separated segments of a location code */
+static char *
+location_prefix(const char *location)
+{
+	const char *p;
+	int depth = 0;
+
+	if (location == NULL)
+		return strdup("");
+
+	for (p = location; *p; p++)
+		if (*p == '-' && ++depth == INCIDENT_DEPTH)
+			break;
+
+	return strndup(location, p - location);
+}
+
+static int64_t
+query_int(sqlite3 *db, const char *sql)
+{
+	sqlite3_stmt *stmt;
+	int64_t value = 0;
+
+	if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK)
+		return -1;
+	if (sqlite3_step(stmt) == SQLITE_ROW)
+		value = sqlite3_column_int64(stmt, 0);
+	sqlite3_finalize(stmt);
+
+	return value;
+}
+
+static struct incident *
+new_incident(struct pass *pass)
+{
+	struct incident *tmp;
+
+	if (pass->n_incidents == pass->max_incidents) {
+		pass->max_incidents = pass->max_incidents ?
+					pass->max_incidents * 2 : 64;
+		tmp = realloc(pass->incidents,
+			      pass->max_incidents * sizeof(*tmp));
+		if (tmp == NULL)
+			return NULL;
+		pass->incidents = tmp;
+	}
+
+	tmp = &pass->incidents[pass->n_incidents++];
+	memset(tmp, 0, sizeof(*tmp));
+	return tmp;
+}
+
+static int
+assign(struct pass *pass, int64_t event_id, int64_t incident)
+{
+	struct assignment *tmp;
+
+	if (pass->n_assigned == pass->max_assigned) {
+		pass->max_assigned = pass->max_assigned ?
+					pass->max_assigned * 2 : 1024;
+		tmp = realloc(pass->assigned,
+			      pass->max_assigned * sizeof(*tmp));
+		if (tmp == NULL)
+			return -1;
+		pass->assigned = tmp;
+	}
+
+	pass->assigned[pass->n_assigned].event_id = event_id;
+	pass->assigned[pass->n_assigned].incident = incident;
+	pass->n_assigned++;
+	return 0;
+}
+
+/**
+ * find_active
+ * @brief Find the tree node of a location prefix, adding it if needed
+ *
+ * A prefix not seen yet in this pass is looked up in the incidents
+ * table, so that an incident stored by the previous pass can be
+ * extended.
+ *
+ * @param pass grouping pass
+ * @param prefix location prefix; taken over by the pass
+ * @return tree node, or NULL if out of memory
+ */
+static struct active *
+find_active(struct pass *pass, char *prefix)
+{
+	struct active key, *node, **found;
+	struct incident *inc;
+
+	key.location = prefix;
+	found = tfind(&key, &pass->tree, compare_active);
+	if (found) {
+		free(prefix);
+		return *found;
+	}
+
+	node = malloc(sizeof(*node));
+	if (node == NULL) {
+		free(prefix);
+		return NULL;
+	}
+	node->location = prefix;
+	node->idx = NO_INCIDENT;
+	node->stored = NO_INCIDENT;
+	if (tsearch(node, &pass->tree, compare_active) == NULL) {
+		free_active(node);
+		return NULL;
+	}
+
+	sqlite3_reset(pass->latest);
+	sqlite3_bind_text(pass->latest, 1, prefix, -1, SQLITE_STATIC);
+	if (sqlite3_step(pass->latest) == SQLITE_ROW) {
+		inc = new_incident(pass);
+		if (inc == NULL)
+			return NULL;
+		inc->id = sqlite3_column_int64(pass->latest, 0);
+		inc->location = node->location;
+		inc->time_first = sqlite3_column_int64(pass->latest, 1);
+		inc->time_last = sqlite3_column_int64(pass->latest, 2);
+		node->idx = pass->n_incidents - 1;
+		node->stored = node->idx;
+	}
+	sqlite3_reset(pass->latest);
+
+	return node;
+}
+
+/**
+ * near_incident
+ * @brief Find an incident of a prefix that an event at time t joins
+ *
+ * The events of a pass come in time order, but an event may be logged
+ * long after it occurred, so it can precede the incident stored by an
+ * earlier pass.  It joins an incident only if it is within
+ * INCIDENT_WINDOW seconds of the incident's [time_first, time_last].
+ *
+ * @return the incident, or NULL if the event starts a new one
+ */
+static struct incident *
+near_incident(struct pass *pass, struct active *node, int64_t t)
+{
+	size_t candidates[2] = { node->idx, node->stored };
+	struct incident *inc;
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		if (candidates[i] == NO_INCIDENT)
+			continue;
+		inc = &pass->incidents[candidates[i]];
+		if (t >= inc->time_first - INCIDENT_WINDOW &&
+		    t <= inc->time_last + INCIDENT_WINDOW) {
+			node->idx = candidates[i];
+			return inc;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * group_events
+ * @brief Stream the new events in time order and group them
+ *
+ * @param pass grouping pass
+ * @param watermark highest event id grouped by earlier passes
+ * @return 0 on success, -1 on failure
+ */
+static int
+group_events(struct pass *pass, int64_t watermark)
+{
+	sqlite3_stmt *stmt;
+	struct active *node;
+	struct incident *inc;
+	int64_t id, t;
+	char *prefix;
+	int rc;
+
+	/* libservicelog stores local time */
+	rc = sqlite3_prepare_v2(pass->db, "SELECT e.id, "
+		"CAST(strftime('%s', e.time_event, 'utc') AS INTEGER), "
+		"(SELECT c.location FROM callouts c WHERE c.event_id = e.id "
+		"LIMIT 1) FROM events e WHERE e.id > ? "
+		"ORDER BY e.time_event, e.id", -1, &stmt, NULL);
+	if (rc != SQLITE_OK)
+		return -1;
+	sqlite3_bind_int64(stmt, 1, watermark);
+
+	while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+		id = sqlite3_column_int64(stmt, 0);
+		t = sqlite3_column_int64(stmt, 1);
+		prefix = location_prefix((const char *)
+					 sqlite3_column_text(stmt, 2));
+		if (prefix == NULL)
+			break;
+
+		node = find_active(pass, prefix);
+		if (node == NULL)
+			break;
+
+		inc = near_incident(pass, node, t);
+		if (inc == NULL) {
+			inc = new_incident(pass);
+			if (inc == NULL)
+				break;
+			inc->id = pass->next_id++;
+			inc->location = node->location;
+			inc->time_first = t;
+			inc->time_last = t;
+			node->idx = pass->n_incidents - 1;
+		}
+		if (t < inc->time_first)
+			inc->time_first = t;
+		if (t > inc->time_last)
+			inc->time_last = t;
+		if (!inc->changed) {
+			inc->changed = 1;
+			pass->n_changed++;
+		}
+
+		if (assign(pass, id, inc->id) != 0)
+			break;
+	}
+	sqlite3_finalize(stmt);
+
+	return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+/**
+ * store_pass
+ * @brief Write the incidents and assignments of a pass in one transaction
+ */
+static int
+store_pass(struct pass *pass)
+{
+	sqlite3_stmt *inc_stmt = NULL, *ev_stmt = NULL;
+	struct incident *inc;
+	size_t i;
+	int rc;
+
+	if (pass->n_assigned == 0)
+		return 0;
+
+	if (sqlite3_exec(pass->db, "BEGIN", NULL, NULL, NULL) != SQLITE_OK)
+		return -1;
+
+	rc = sqlite3_prepare_v2(pass->db, "INSERT OR REPLACE INTO incident.incidents "
+				"(id, location, time_first, time_last) "
+				"VALUES (?, ?, ?, ?)", -1, &inc_stmt, NULL);
+	if (rc == SQLITE_OK)
+		rc = sqlite3_prepare_v2(pass->db, "INSERT OR REPLACE INTO "
+					"incident.incident_events "
+					"(event_id, incident) "
+					"VALUES (?, ?)", -1, &ev_stmt, NULL);
+
+	for (i = 0; rc == SQLITE_OK && i < pass->n_incidents; i++) {
+		inc = &pass->incidents[i];
+		if (!inc->changed)
+			continue;
+		sqlite3_bind_int64(inc_stmt, 1, inc->id);
+		sqlite3_bind_text(inc_stmt, 2, inc->location, -1,
+				  SQLITE_STATIC);
+		sqlite3_bind_int64(inc_stmt, 3, inc->time_first);
+		sqlite3_bind_int64(inc_stmt, 4, inc->time_last);
+		rc = sqlite3_step(inc_stmt);
+		rc = (rc == SQLITE_DONE) ? sqlite3_reset(inc_stmt) : rc;
+	}
+
+	for (i = 0; rc == SQLITE_OK && i < pass->n_assigned; i++) {
+		sqlite3_bind_int64(ev_stmt, 1, pass->assigned[i].event_id);
+		sqlite3_bind_int64(ev_stmt, 2, pass->assigned[i].incident);
+		rc = sqlite3_step(ev_stmt);
+		rc = (rc == SQLITE_DONE) ? sqlite3_reset(ev_stmt) : rc;
+	}
+
+	sqlite3_finalize(inc_stmt);
+	sqlite3_finalize(ev_stmt);
+
+	if (rc == SQLITE_OK &&
+	    sqlite3_exec(pass->db, "COMMIT", NULL, NULL, NULL) == SQLITE_OK)
+		return 0;
+
+	sqlite3_exec(pass->db, "ROLLBACK", NULL, NULL, NULL);
+	return -1;
+}
+
+/**
+ * attach
+ * @brief Attach the incident database as "incident"
+ *
+ * @param db servicelog database
+ * @param update update->persistent is set unless it is in memory
+ * @return 0 on success, -1 on failure
+ */
+static int
+attach(sqlite3 *db, struct slog_incident_update *update)
+{
+	sqlite3_stmt *stmt;
+	const char *main_db;
+	char *dir = NULL, path[PATH_MAX] = "";
+	int rc;
+
+	if (sqlite3_db_filename(db, "incident") != NULL) {
+		/* attached by an earlier pass */
+		update->persistent = sqlite3_db_filename(db, "incident")[0];
+		return 0;
+	}
+
+	main_db = sqlite3_db_filename(db, "main");
+	if (main_db && main_db[0])
+		dir = strdup(main_db);
+	if (dir) {
+		snprintf(path, sizeof(path), "%s/%s", dirname(dir),
+			 INCIDENT_DB);
+		/* created if need be, so it must be writable either way */
+		if (access(path, F_OK) == 0 ? access(path, R_OK | W_OK) != 0 :
+		    access(dir, W_OK | X_OK) != 0)
+			path[0] = '\0';
+		free(dir);
+	}
+	update->persistent = (path[0] != '\0');
+
+	if (sqlite3_prepare_v2(db, "ATTACH DATABASE ? AS incident", -1,
+			       &stmt, NULL) != SQLITE_OK)
+		return -1;
+	sqlite3_bind_text(stmt, 1, path[0] ? path : ":memory:", -1,
+			  SQLITE_STATIC);
+	rc = sqlite3_step(stmt);
+	sqlite3_finalize(stmt);
+
+	return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+/**
+ * slog_incident_update
+ * @brief Group the events logged since the previous pass into incidents
+ *
+ * The events are only read while grouping; the incident tables are
+ * written afterwards in a single short transaction, so the write lock
+ * is not held during the scan.
+ *
+ * @param slog open servicelog
+ * @param update returned statistics; update->error is set on failure
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_incident_update(servicelog *slog, struct slog_incident_update *update)
+{
+	struct pass pass;
+	int64_t watermark;
+	size_t i;
+	int rc = -1;
+
+	memset(update, 0, sizeof(*update));
+	memset(&pass, 0, sizeof(pass));
+	pass.db = slog->db;
+
+	if (attach(pass.db, update) != 0)
+		goto out;
+	for (i = 0; i < N_SCHEMA_SQL; i++)
+		if (sqlite3_exec(pass.db, schema_sql[i], NULL, NULL,
+				 NULL) != SQLITE_OK)
+			goto out;
+
+	watermark = query_int(pass.db, "SELECT max(event_id) FROM "
+			      "incident.incident_events");
+	if (watermark > query_int(pass.db, "SELECT max(id) FROM events")) {
+		/* the servicelog was cleared or replaced; start over */
+		if (sqlite3_exec(pass.db, "DELETE FROM incident.incidents; "
+				 "DELETE FROM incident.incident_events",
+				 NULL, NULL, NULL) != SQLITE_OK)
+			goto out;
+		watermark = 0;
+	}
+	pass.next_id = query_int(pass.db, "SELECT max(id) FROM "
+				 "incident.incidents") + 1;
+	if (watermark < 0 || pass.next_id <= 0)
+		goto out;
+
+	if (sqlite3_prepare_v2(pass.db, "SELECT id, time_first, time_last "
+			       "FROM incident.incidents WHERE location = ? "
+			       "ORDER BY time_last DESC LIMIT 1", -1,
+			       &pass.latest, NULL) != SQLITE_OK)
+		goto out;
+
+	if (group_events(&pass, watermark) != 0 || store_pass(&pass) != 0)
+		goto out;
+
+	update->events = pass.n_assigned;
+	update->incidents = pass.n_changed;
+	rc = 0;
+
+out:
+	if (rc != 0)
+		snprintf(update->error, sizeof(update->error),
+			 "Could not group events into incidents: %s",
+			 sqlite3_errmsg(pass.db));
+	sqlite3_finalize(pass.latest);
+	tdestroy(pass.tree, free_active);
+	free(pass.incidents);
+	free(pass.assigned);
+	return rc;
+}
+
+/**
+ * slog_incident_print
+ * @brief List the incidents, oldest first
+ *
+ * Events deleted since they were grouped (e.g., by servicelog_manage
+ * --clean) are left out, as are incidents with no events left.
+ *
+ * @param fp stream to print to
+ * @param slog open servicelog, grouped by slog_incident_update()
+ * @return 0 on success, -1 on a database error
+ */
+int
+slog_incident_print(FILE *fp, servicelog *slog)
+{
+	sqlite3_stmt *stmt;
+	char first[32], last[32];
+	time_t t;
+	int rc;
+
+	rc = sqlite3_prepare_v2(slog->db, "SELECT i.id, i.time_first, "
+		"i.time_last, count(*), "
+		"sum(e.serviceable = 1 AND e.closed = 0), max(e.severity), "
+		"i.location FROM incident.incidents i "
+		"JOIN incident.incident_events m ON m.incident = i.id "
+		"JOIN events e ON e.id = m.event_id "
+		"GROUP BY i.id ORDER BY i.time_first, i.id", -1, &stmt, NULL);
+	if (rc != SQLITE_OK)
+		return -1;
+
+	fprintf(fp, "%8s  %-19s  %-19s  %6s  %5s  %-11s %s\n\n", "Incident",
+		"First Event", "Last Event", "Events", "Open", "Severity",
+		"Location");
+
+	while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+		t = sqlite3_column_int64(stmt, 1);
+		strftime(first, sizeof(first), "%Y-%m-%d %H:%M:%S",
+			 localtime(&t));
+		t = sqlite3_column_int64(stmt, 2);
+		strftime(last, sizeof(last), "%Y-%m-%d %H:%M:%S",
+			 localtime(&t));
+
+		fprintf(fp, "%8lld  %s  %s  %6lld  %5lld  %-11s %s\n",
+			(long long)sqlite3_column_int64(stmt, 0), first, last,
+			(long long)sqlite3_column_int64(stmt, 3),
+			(long long)sqlite3_column_int64(stmt, 4),
+			slog_sev_name(sqlite3_column_int(stmt, 5)),
+			sqlite3_column_text(stmt, 6)[0] ?
+			(const char *)sqlite3_column_text(stmt, 6) :
+			"(none)");
+	}
+	sqlite3_finalize(stmt);
+
+	return (rc == SQLITE_DONE) ? 0 : -1;
+}
@@ -0,0 +1,32 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_INCIDENT_H
+#define SLOG_INCIDENT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <servicelog-1/servicelog.h>
+
+/*
+ * An incident groups the events whose first callout shares a location
+ * code prefix of INCIDENT_DEPTH segments (e.g., "U78D2.001.XXXX-P1"),
+ * each logged within INCIDENT_WINDOW seconds of the previous one.
+ */
+#define INCIDENT_DEPTH		2
+#define INCIDENT_WINDOW		300
+
+struct slog_incident_update {
+	uint64_t events;	/* events grouped by this pass */
+	uint64_t incidents;	/* incidents created or extended */
+	int persistent;		/* 0 if grouped in memory */
+	char error[SL_MAX_ERR];
+};
+
+extern int slog_incident_update(servicelog *slog,
+				struct slog_incident_update *update);
+extern int slog_incident_print(FILE *fp, servicelog *slog);
+
+#endif
@@ -0,0 +1,104 @@
+/**
+ * @file slog_index.c
+ * @brief Create the indexes that the servicelog commands query through
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <sqlite3.h>
+
+#include "slog_index.h"
+#include "slog_query.h"
+
+static const char *indexes[] = {
+	/* relative time predicates (slog_query_rewrite()) */
+	"CREATE INDEX IF NOT EXISTS events_time_logged "
+		"ON events(time_logged)",
+	"CREATE INDEX IF NOT EXISTS events_time_event "
+		"ON events(time_event)",
+	/* also the changed events of an incremental export */
+	"CREATE INDEX IF NOT EXISTS events_time_last_update "
+		"ON events(time_last_update)",
+	/*
+	 * Open events are a small fraction of a long-lived servicelog;
+	 * SQLite keeps a partial index current on each insert and update,
+	 * so events enter and leave it without any change to libservicelog.
+	 */
+	"CREATE INDEX IF NOT EXISTS events_open "
+		"ON events(id) WHERE " SLOG_QUERY_OPEN,
+	/* slog_query_location() and servicelog_repair_log() */
+	"CREATE INDEX IF NOT EXISTS callouts_location "
+		"ON callouts(location)",
+	"CREATE INDEX IF NOT EXISTS repair_actions_location "
+		"ON repair_actions(location)",
+};
+
+#define N_INDEXES	(sizeof(indexes) / sizeof(indexes[0]))
+
+/**
+ * slog_index_present
+ * @brief Check whether the indexes have been created
+ *
+ * slog_index_ensure() creates them all at once, so only the partial
+ * index of open events is looked for.
+ *
+ * @return 1 if they exist, 0 if not, -1 on a database error
+ */
+int
+slog_index_present(servicelog *slog)
+{
+	sqlite3_stmt *stmt;
+	int rc;
+
+	if (sqlite3_prepare_v2(slog->db, "SELECT 1 FROM sqlite_master WHERE "
+			       "type = 'index' AND name = 'events_open'", -1,
+			       &stmt, NULL) != SQLITE_OK)
+		return -1;
+	rc = sqlite3_step(stmt);
+	sqlite3_finalize(stmt);
+
+	if (rc == SQLITE_ROW)
+		return 1;
+	return rc == SQLITE_DONE ? 0 : -1;
+}
+
+/**
+ * slog_index_ensure
+ * @brief Create any of the indexes that do not exist yet
+ *
+ * All of them are created in one transaction, so a failure leaves the
+ * schema as it was.
+ *
+ * @param slog servicelog opened on a writable database
+ * @param error buffer for an error message
+ * @param error_len size of error
+ * @return 0 on success, -1 on a database error
+ */
+int
+slog_index_ensure(servicelog *slog, char *error, size_t error_len)
+{
+	size_t i;
+
+	if (sqlite3_exec(slog->db, "BEGIN IMMEDIATE", NULL, NULL,
+			 NULL) != SQLITE_OK)
+		goto err_out;
+
+	for (i = 0; i < N_INDEXES; i++) {
+		if (sqlite3_exec(slog->db, indexes[i], NULL, NULL,
+				 NULL) != SQLITE_OK)
+			goto err_out;
+	}
+
+	if (sqlite3_exec(slog->db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK)
+		goto err_out;
+
+	return 0;
+
+err_out:
+	snprintf(error, error_len, "%s", sqlite3_errmsg(slog->db));
+	if (!sqlite3_get_autocommit(slog->db))
+		sqlite3_exec(slog->db, "ROLLBACK", NULL, NULL, NULL);
+	return -1;
+}
@@ -0,0 +1,24 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_INDEX_H
+#define SLOG_INDEX_H
+
+#include <stddef.h>
+#include <servicelog-1/servicelog.h>
+
+/*
+ * Indexes that libservicelog does not create, on the columns that the
+ * time predicates, --open, --location, incremental exports and repair
+ * matching select on.  They are created once, by
+ * "servicelog_manage --index", or by the first command that logs a
+ * record or runs --open with write access and finds them missing;
+ * every query works without them, only with a table scan.
+ */
+extern int slog_index_present(servicelog *slog);
+extern int slog_index_ensure(servicelog *slog, char *error,
+			     size_t error_len);
+
+#endif
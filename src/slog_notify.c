@@ -0,0 +1,491 @@
+/**
+ * @file slog_notify.c
+ * @brief Deliver a logged event or repair action to notification tools
+ *
+ * Runs the tools registered with servicelog_notify whose match string
+ * selects the record, and hands them the record by the method they
+ * registered with, the same way the library does when the record is
+ * logged.  The tools are started with slog_spawn(), so delivery costs
+ * the same from a small command as from a large writer.
+ *
+ * A record is formatted once per method, into a sealed memfd, however
+ * many tools want it in that format.  Each tool gets its own read-only
+ * descriptor of that memfd as stdin (opened through /proc/self/fd, so
+ * each has its own offset): nothing is copied per tool, and the
+ * dispatch never blocks writing to a tool that reads slowly, or not at
+ * all.  Where memfds are not available, each tool is fed through a pipe
+ * instead.  Each tool is still waited for, for its exit status, before
+ * the next is started, so a slow tool delays the tools after it.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "slog_notify.h"
+#include "slog_spawn.h"
+#include "slog_subscriber.h"
+#include "slog_notify_stats.h"
+
+#define N_METHODS	(SL_METHOD_SIMPLE_VIA_STDIN + 1)
+
+/* The record being delivered; exactly one of event and repair is set */
+struct record {
+	uint64_t id;
+	int64_t committed;	/* when it was logged, in microseconds */
+	int payload[N_METHODS];	/* rendered memfd per method, or -1 */
+	int no_memfd;		/* memfds are not available; use pipes */
+	struct sl_event *event;
+	struct sl_repair_action *repair;
+};
+
+/**
+ * matches
+ * @brief Check a tool's match string against the record
+ *
+ * @return 1 if it matches, 0 if not, -1 on a query error
+ */
+static int
+matches(servicelog *slog, struct record *rec, const char *match)
+{
+	struct sl_event *events = NULL;
+	struct sl_repair_action *repairs = NULL;
+	char *query;
+	int rc;
+
+	if (match == NULL || match[0] == '\0')
+		return 1;
+
+	if (asprintf(&query, "id=%" PRIu64 " AND (%s)", rec->id, match) < 0)
+		return -1;
+
+	if (rec->event) {
+		rc = servicelog_event_query(slog, query, &events);
+		if (rc == 0 && events) {
+			servicelog_event_free(events);
+			rc = 1;
+		}
+	}
+	else {
+		rc = servicelog_repair_query(slog, query, &repairs);
+		if (rc == 0 && repairs) {
+			servicelog_repair_free(repairs);
+			rc = 1;
+		}
+	}
+	free(query);
+
+	return rc < 0 || rc > 1 ? -1 : rc;
+}
+
+/**
+ * render
+ * @brief Write the record to a tool's stdin in its registered format
+ */
+static int
+render(FILE *fp, struct record *rec, uint32_t method)
+{
+	/* SL_METHOD_SIMPLE_VIA_STDIN is the name=value form */
+	int verbosity = (method == SL_METHOD_PRETTY_VIA_STDIN) ? 1 : -1;
+
+	if (method == SL_METHOD_NUM_VIA_STDIN)
+		return fprintf(fp, "%" PRIu64 "\n", rec->id) < 0 ? -1 : 0;
+
+	if (rec->event)
+		return servicelog_event_print(fp, rec->event, verbosity) < 0 ?
+			-1 : 0;
+	return servicelog_repair_print(fp, rec->repair, verbosity) < 0 ? -1 : 0;
+}
+
+/**
+ * payload_fd
+ * @brief Open the record as rendered for a method, rendering it once
+ *
+ * @return a new read-only descriptor at offset 0, or -1 if the record
+ *	   has to be written to the tool through a pipe
+ */
+static int
+payload_fd(struct record *rec, uint32_t method)
+{
+	char path[64];
+	FILE *fp;
+	int fd, rc;
+
+	if (method >= N_METHODS || rec->no_memfd)
+		return -1;
+
+	if (rec->payload[method] < 0) {
+		fd = memfd_create("servicelog-notify", MFD_CLOEXEC |
+				  MFD_ALLOW_SEALING);
+		if (fd < 0) {
+			rec->no_memfd = 1;
+			return -1;
+		}
+
+		fp = fdopen(dup(fd), "w");
+		rc = fp ? render(fp, rec, method) : -1;
+		if ((fp && fclose(fp) != 0) || rc != 0 ||
+		    fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW |
+			  F_SEAL_WRITE | F_SEAL_SEAL) != 0) {
+			close(fd);
+			rec->no_memfd = 1;
+			return -1;
+		}
+		rec->payload[method] = fd;
+	}
+
+	snprintf(path, sizeof(path), "/proc/self/fd/%d", rec->payload[method]);
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		rec->no_memfd = 1;
+
+	return fd;
+}
+
+/**
+ * run_tool
+ * @brief Run one notification tool and wait for it
+ *
+ * @return 0 if the tool ran and exited with 0, -1 otherwise
+ */
+static int
+run_tool(struct sl_notify *tool, struct record *rec,
+	 struct slog_notify_stats *stats, char *error, size_t error_len)
+{
+	char *command = NULL;
+	int fd[2] = { -1, -1 };
+	int status, rc = -1;
+	int64_t start, started, finished;
+	FILE *fp;
+	pid_t pid;
+
+	slog_notify_stats_add(stats, SLOG_STAT_TOOL, tool->id,
+			      SLOG_STAT_QUEUE,
+			      slog_notify_stats_usec() - rec->committed);
+
+	if (tool->method == SL_METHOD_NUM_VIA_CMD_LINE) {
+		if (asprintf(&command, "%s %" PRIu64, tool->command,
+			     rec->id) < 0) {
+			snprintf(error, error_len, "Out of memory");
+			return -1;
+		}
+	}
+	else if ((fd[0] = payload_fd(rec, tool->method)) < 0 &&
+		 pipe2(fd, O_CLOEXEC) != 0) {
+		snprintf(error, error_len, "Could not create a pipe: %s",
+			 strerror(errno));
+		return -1;
+	}
+
+	start = slog_notify_stats_usec();
+	if (slog_spawn_shell(command ? command : tool->command, fd[0], &pid,
+			     error, error_len) != 0) {
+		free(command);
+		if (fd[0] >= 0)
+			close(fd[0]);
+		if (fd[1] >= 0)
+			close(fd[1]);
+		slog_notify_stats_add(stats, SLOG_STAT_TOOL, tool->id,
+				      SLOG_STAT_EXIT, SLOG_STAT_NOT_RUN);
+		return -1;
+	}
+	started = slog_notify_stats_usec();
+	free(command);
+	slog_notify_stats_add(stats, SLOG_STAT_TOOL, tool->id, SLOG_STAT_SPAWN,
+			      started - start);
+
+	if (fd[0] >= 0)
+		close(fd[0]);
+	if (fd[1] >= 0) {
+		fp = fdopen(fd[1], "w");
+		if (fp == NULL)
+			close(fd[1]);
+		/* a tool that exits without reading its input is not an error */
+		else if ((render(fp, rec, tool->method) | fclose(fp)) != 0 &&
+			 errno != EPIPE)
+			snprintf(error, error_len, "Could not write to %s: %s",
+				 tool->command, strerror(errno));
+	}
+
+	if (slog_spawn_wait(pid, &status) != 0) {
+		snprintf(error, error_len, "Could not wait for %s: %s",
+			 tool->command, strerror(errno));
+		return -1;
+	}
+
+	finished = slog_notify_stats_usec();
+	slog_notify_stats_add(stats, SLOG_STAT_TOOL, tool->id, SLOG_STAT_RUN,
+			      finished - started);
+	slog_notify_stats_add(stats, SLOG_STAT_TOOL, tool->id,
+			      SLOG_STAT_LATENCY, finished - rec->committed);
+	slog_notify_stats_add(stats, SLOG_STAT_TOOL, tool->id, SLOG_STAT_EXIT,
+			      WIFEXITED(status) ? WEXITSTATUS(status) :
+			      SLOG_STAT_SIGNALED + WTERMSIG(status));
+
+	if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+		rc = 0;
+	else if (WIFEXITED(status))
+		snprintf(error, error_len, "%s exited with %d", tool->command,
+			 WEXITSTATUS(status));
+	else
+		snprintf(error, error_len, "%s was killed by signal %d",
+			 tool->command, WTERMSIG(status));
+
+	return rc;
+}
+
+/**
+ * slog_notify_dispatch
+ * @brief Notify the registered tools of a logged record
+ *
+ * The tools are run one after the other, each with the record in its
+ * registered format, and then the record is pushed to the socket
+ * subscribers; a tool or subscriber that fails does not stop the
+ * others.  The delivery times and exit statuses are added to the
+ * notify_stats histograms.
+ *
+ * @param slog open servicelog
+ * @param notify SL_NOTIFY_EVENTS or SL_NOTIFY_REPAIRS
+ * @param id id of the event or repair action
+ * @param result returned counts, and the last failure
+ * @return 0 if every matching tool succeeded, 1 if one failed, -1 if
+ *	   the record or the tools could not be read
+ */
+int
+slog_notify_dispatch(servicelog *slog, int notify, uint64_t id,
+		     struct slog_notify_result *result)
+{
+	struct sl_notify *tools = NULL, *tool;
+	struct sigaction ignore, saved;
+	struct slog_notify_stats stats;
+	struct record rec;
+	char query[64];
+	int rc, i;
+
+	memset(result, 0, sizeof(*result));
+	memset(&rec, 0, sizeof(rec));
+	for (i = 0; i < N_METHODS; i++)
+		rec.payload[i] = -1;
+	memset(&stats, 0, sizeof(stats));
+	rec.id = id;
+
+	if (notify == SL_NOTIFY_EVENTS)
+		rc = servicelog_event_get(slog, id, &rec.event);
+	else
+		rc = servicelog_repair_get(slog, id, &rec.repair);
+	if (rc != 0) {
+		snprintf(result->error, sizeof(result->error), "%s",
+			 servicelog_error(slog));
+		return -1;
+	}
+	if (rec.event == NULL && rec.repair == NULL) {
+		snprintf(result->error, sizeof(result->error), "%s %" PRIu64
+			 " not found", notify == SL_NOTIFY_EVENTS ? "Event" :
+			 "Repair action", id);
+		return -1;
+	}
+	rec.committed = (int64_t)(rec.event ? rec.event->time_logged :
+				  rec.repair->time_logged) * 1000000;
+
+	snprintf(query, sizeof(query), "notify=%d", notify);
+	if (servicelog_notify_query(slog, query, &tools) != 0) {
+		snprintf(result->error, sizeof(result->error), "%s",
+			 servicelog_error(slog));
+		rc = -1;
+		goto out;
+	}
+
+	/* a tool closing its stdin early must not kill the caller */
+	memset(&ignore, 0, sizeof(ignore));
+	ignore.sa_handler = SIG_IGN;
+	sigaction(SIGPIPE, &ignore, &saved);
+
+	for (tool = tools; tool; tool = tool->next) {
+		rc = matches(slog, &rec, tool->match);
+		if (rc < 0) {
+			snprintf(result->error, sizeof(result->error),
+				 "Notification tool %" PRIu64 ": invalid match "
+				 "string '%s'", tool->id, tool->match);
+			result->failed++;
+			continue;
+		}
+		if (rc == 0)
+			continue;
+
+		result->matched++;
+		if (run_tool(tool, &rec, &stats, result->error,
+			     sizeof(result->error)) != 0)
+			result->failed++;
+	}
+	slog_subscriber_deliver(slog, notify, id, rec.committed, &stats,
+				result);
+	slog_notify_stats_flush(&stats, slog->db);
+
+	sigaction(SIGPIPE, &saved, NULL);
+	rc = result->failed ? 1 : 0;
+
+out:
+	for (i = 0; i < N_METHODS; i++)
+		if (rec.payload[i] >= 0)
+			close(rec.payload[i]);
+	if (tools)
+		servicelog_notify_free(tools);
+	if (rec.event)
+		servicelog_event_free(rec.event);
+	if (rec.repair)
+		servicelog_repair_free(rec.repair);
+	return rc;
+}
+
+/**
+ * classify
+ * @brief Pick the priority lane of a record
+ */
+static int
+classify(servicelog *slog, int notify, uint64_t id)
+{
+	sqlite3_stmt *stmt;
+	int lane = SLOG_LANE_NORMAL;
+	int severity, serviceable;
+
+	if (notify != SL_NOTIFY_EVENTS)
+		return lane;
+
+	if (sqlite3_prepare_v2(slog->db, "SELECT severity, serviceable FROM "
+			       "events WHERE id = ?", -1, &stmt,
+			       NULL) != SQLITE_OK)
+		return lane;
+	sqlite3_bind_int64(stmt, 1, id);
+
+	if (sqlite3_step(stmt) == SQLITE_ROW) {
+		severity = sqlite3_column_int(stmt, 0);
+		serviceable = sqlite3_column_int(stmt, 1);
+		if (serviceable && severity >= SL_SEV_ERROR_LOCAL)
+			lane = SLOG_LANE_CRITICAL;
+		else if (!serviceable && severity < SL_SEV_WARNING)
+			lane = SLOG_LANE_BULK;
+	}
+	sqlite3_finalize(stmt);
+
+	return lane;
+}
+
+void
+slog_notify_lanes_init(struct slog_notify_lanes *lanes)
+{
+	memset(lanes, 0, sizeof(*lanes));
+}
+
+/**
+ * slog_notify_lanes_add
+ * @brief Queue a record for dispatch in its priority lane
+ *
+ * @param lanes lanes set up by slog_notify_lanes_init()
+ * @param slog open servicelog
+ * @param notify SL_NOTIFY_EVENTS or SL_NOTIFY_REPAIRS
+ * @param id id of the event or repair action
+ * @param stats the depth of the lane is added here
+ * @return 0 on success, -1 if out of memory
+ */
+int
+slog_notify_lanes_add(struct slog_notify_lanes *lanes, servicelog *slog,
+		      int notify, uint64_t id, struct slog_notify_stats *stats)
+{
+	int i = classify(slog, notify, id);
+	struct slog_lane *l = &lanes->lane[i];
+	struct slog_lane_item *tmp;
+
+	if (l->n == l->max) {
+		l->max = l->max ? l->max * 2 : 64;
+		tmp = realloc(l->items, l->max * sizeof(*tmp));
+		if (tmp == NULL)
+			return -1;
+		l->items = tmp;
+	}
+
+	l->items[l->n].id = id;
+	l->items[l->n].queued = slog_notify_stats_usec();
+	l->n++;
+
+	slog_notify_stats_add(stats, SLOG_STAT_LANE, i, SLOG_STAT_DEPTH,
+			      l->n - l->head);
+	return 0;
+}
+
+/**
+ * slog_notify_lanes_next
+ * @brief Take the next record to dispatch
+ *
+ * A critical record past its latency budget is taken first.  Otherwise
+ * every lane with records waiting earns its weight in credit, and the
+ * lane with the most credit (the higher priority on a tie) gives up the
+ * credit of the round and delivers its next record; so with all three
+ * lanes busy, 8 of every 13 deliveries are critical, 4 normal and 1
+ * bulk, spread over the round rather than in runs.
+ *
+ * @param lanes queued records
+ * @param stats the time the record waited is added here
+ * @param id returned id of the record
+ * @return 1 if a record was taken, 0 if the lanes are empty
+ */
+int
+slog_notify_lanes_next(struct slog_notify_lanes *lanes,
+		       struct slog_notify_stats *stats, uint64_t *id)
+{
+	static const int weight[SLOG_LANES] = SLOG_LANE_WEIGHTS;
+	struct slog_lane *l = &lanes->lane[SLOG_LANE_CRITICAL];
+	struct slog_lane_item *item;
+	int64_t now = slog_notify_stats_usec();
+	int i, pick = -1, total = 0;
+
+	if (l->head < l->n &&
+	    now - l->items[l->head].queued >= SLOG_LANE_CRITICAL_BUDGET) {
+		pick = SLOG_LANE_CRITICAL;
+		goto take;
+	}
+
+	for (i = 0; i < SLOG_LANES; i++) {
+		l = &lanes->lane[i];
+		if (l->head == l->n) {
+			/* an idle lane does not save up credit */
+			lanes->credit[i] = 0;
+			continue;
+		}
+		lanes->credit[i] += weight[i];
+		total += weight[i];
+		if (pick < 0 || lanes->credit[i] > lanes->credit[pick])
+			pick = i;
+	}
+	if (pick < 0)
+		return 0;
+	lanes->credit[pick] -= total;
+
+take:
+	l = &lanes->lane[pick];
+	item = &l->items[l->head++];
+	slog_notify_stats_add(stats, SLOG_STAT_LANE, pick, SLOG_STAT_QUEUE,
+			      now - item->queued);
+	*id = item->id;
+	return 1;
+}
+
+void
+slog_notify_lanes_free(struct slog_notify_lanes *lanes)
+{
+	int i;
+
+	for (i = 0; i < SLOG_LANES; i++)
+		free(lanes->lane[i].items);
+	memset(lanes, 0, sizeof(*lanes));
+}
@@ -0,0 +1,70 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_NOTIFY_H
+#define SLOG_NOTIFY_H
+
+#include <stdint.h>
+#include <servicelog-1/servicelog.h>
+
+struct slog_notify_stats;
+
+/*
+ * Priority lanes for dispatching a list of records.  Serviceable events
+ * of at least SL_SEV_ERROR_LOCAL are critical; other serviceable events,
+ * events of at least SL_SEV_WARNING and repair actions are normal; the
+ * rest are bulk.  Each lane is taken in the order its records were
+ * added, and the lanes share the deliveries by weight (smooth weighted
+ * round-robin), so a long critical list does not starve the bulk lane.
+ * A critical record that has waited for SLOG_LANE_CRITICAL_BUDGET is
+ * taken before any other.
+ */
+#define SLOG_LANE_CRITICAL	0
+#define SLOG_LANE_NORMAL	1
+#define SLOG_LANE_BULK		2
+#define SLOG_LANES		3
+
+/* Deliveries per round of each lane, when all of them are waiting */
+#define SLOG_LANE_WEIGHTS	{ 8, 4, 1 }
+
+/* Microseconds a critical record may wait before it goes first */
+#define SLOG_LANE_CRITICAL_BUDGET	100000
+
+struct slog_lane_item {
+	uint64_t id;
+	int64_t queued;		/* slog_notify_stats_usec() when added */
+};
+
+struct slog_lane {
+	struct slog_lane_item *items;
+	size_t head;		/* next item to deliver */
+	size_t n;		/* items added */
+	size_t max;
+};
+
+struct slog_notify_lanes {
+	struct slog_lane lane[SLOG_LANES];
+	int credit[SLOG_LANES];	/* weighted round-robin state */
+};
+
+/* The outcome of delivering one record to the notification tools */
+struct slog_notify_result {
+	unsigned int matched;	/* tools whose match string selected it */
+	unsigned int failed;	/* tools that could not run or exited != 0 */
+	char error[SL_MAX_ERR];	/* the last failure */
+};
+
+extern int slog_notify_dispatch(servicelog *slog, int notify, uint64_t id,
+				struct slog_notify_result *result);
+extern void slog_notify_lanes_init(struct slog_notify_lanes *lanes);
+extern int slog_notify_lanes_add(struct slog_notify_lanes *lanes,
+				 servicelog *slog, int notify, uint64_t id,
+				 struct slog_notify_stats *stats);
+extern int slog_notify_lanes_next(struct slog_notify_lanes *lanes,
+				  struct slog_notify_stats *stats,
+				  uint64_t *id);
+extern void slog_notify_lanes_free(struct slog_notify_lanes *lanes);
+
+#endif
@@ -0,0 +1,478 @@
+/**
+ * @file slog_notify_stats.c
+ * @brief Histograms of notification delivery latency and outcome
+ *
+ * Each dispatch counts, for every tool and subscriber it delivers to,
+ * how long after the commit of the record the delivery started and
+ * finished, how long the tool took to start and to run, and how it
+ * exited.  The counts are added to
+ *
+ *   notify_stats(source, id, metric, bucket, count)
+ *
+ * in one transaction at the end of the dispatch.  A read-only database
+ * just does not keep them.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include "slog_notify_stats.h"
+#include "slog_notify.h"
+
+static const char *metric_names[SLOG_STAT_N_METRICS] = {
+	"queue", "spawn", "run", "exit", "depth", "latency"
+};
+
+static const char *metric_help[SLOG_STAT_N_METRICS] = {
+	"Time from the commit of a record to the start of its delivery",
+	"Time to start a notification tool",
+	"Time from starting a delivery to its completion",
+	"Deliveries by exit status",
+	"Records waiting in a priority lane when one was added",
+	"Time from the commit of a record to the end of its delivery",
+};
+
+static const char *source_names[] = { "tool", "subscriber", "lane" };
+
+static const char *lane_names[SLOG_LANES] = { "critical", "normal", "bulk" };
+
+static int
+time_bucket(int64_t usec)
+{
+	int b = 0;
+
+	if (usec <= 0)
+		return 0;
+	while (usec && b < SLOG_STAT_BUCKETS - 1) {
+		usec >>= 1;
+		b++;
+	}
+	return b;
+}
+
+/* Exclusive upper bound of a time bucket, in microseconds */
+static uint64_t
+bucket_limit(int bucket)
+{
+	return bucket ? (uint64_t)1 << bucket : 1;
+}
+
+static void
+add_count(struct slog_notify_stats *stats, int source, uint64_t id,
+	  int metric, int bucket, uint64_t count)
+{
+	struct slog_stat_count *c, *tmp;
+	size_t i;
+
+	for (i = 0; i < stats->n; i++) {
+		c = &stats->counts[i];
+		if (c->source == source && c->id == id &&
+		    c->metric == metric && c->bucket == bucket) {
+			c->count += count;
+			return;
+		}
+	}
+
+	if (stats->n == stats->max) {
+		stats->max = stats->max ? stats->max * 2 : 32;
+		tmp = realloc(stats->counts, stats->max * sizeof(*tmp));
+		if (tmp == NULL)
+			return;		/* the stats are best effort */
+		stats->counts = tmp;
+	}
+
+	c = &stats->counts[stats->n++];
+	c->source = source;
+	c->id = id;
+	c->metric = metric;
+	c->bucket = bucket;
+	c->count = count;
+}
+
+/**
+ * slog_notify_stats_add
+ * @brief Count one delivery measurement
+ *
+ * @param stats counts of the current dispatch
+ * @param source SLOG_STAT_TOOL, SLOG_STAT_SUBSCRIBER or SLOG_STAT_LANE
+ * @param id notification tool or subscriber id, or SLOG_LANE_*
+ * @param metric SLOG_STAT_*
+ * @param value time in microseconds, depth, or exit status
+ */
+void
+slog_notify_stats_add(struct slog_notify_stats *stats, int source,
+		      uint64_t id, int metric, int64_t value)
+{
+	if (metric == SLOG_STAT_EXIT) {
+		add_count(stats, source, id, metric, (int)value, 1);
+		return;
+	}
+
+	add_count(stats, source, id, metric, time_bucket(value), 1);
+	add_count(stats, source, id, metric, SLOG_STAT_SUM,
+		  value > 0 ? value : 0);
+}
+
+/**
+ * slog_notify_stats_flush
+ * @brief Add the counts of a dispatch to the notify_stats table
+ *
+ * @return 0 on success, -1 if they could not be written
+ */
+int
+slog_notify_stats_flush(struct slog_notify_stats *stats, sqlite3 *db)
+{
+	sqlite3_stmt *insert = NULL, *update = NULL;
+	struct slog_stat_count *c;
+	size_t i;
+	int rc = -1;
+
+	if (stats->n == 0)
+		goto out;
+
+	if (sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS notify_stats "
+			 "(source INTEGER, id INTEGER, metric INTEGER, "
+			 "bucket INTEGER, count INTEGER, PRIMARY KEY (source, "
+			 "id, metric, bucket))", NULL, NULL, NULL) != SQLITE_OK ||
+	    sqlite3_exec(db, "BEGIN IMMEDIATE", NULL, NULL,
+			 NULL) != SQLITE_OK)
+		goto out;
+
+	if (sqlite3_prepare_v2(db, "INSERT OR IGNORE INTO notify_stats "
+			       "VALUES (?, ?, ?, ?, 0)", -1, &insert,
+			       NULL) != SQLITE_OK ||
+	    sqlite3_prepare_v2(db, "UPDATE notify_stats SET count = count + ? "
+			       "WHERE source = ? AND id = ? AND metric = ? AND "
+			       "bucket = ?", -1, &update, NULL) != SQLITE_OK)
+		goto rollback;
+
+	for (i = 0; i < stats->n; i++) {
+		c = &stats->counts[i];
+		sqlite3_bind_int(insert, 1, c->source);
+		sqlite3_bind_int64(insert, 2, c->id);
+		sqlite3_bind_int(insert, 3, c->metric);
+		sqlite3_bind_int(insert, 4, c->bucket);
+		sqlite3_bind_int64(update, 1, c->count);
+		sqlite3_bind_int(update, 2, c->source);
+		sqlite3_bind_int64(update, 3, c->id);
+		sqlite3_bind_int(update, 4, c->metric);
+		sqlite3_bind_int(update, 5, c->bucket);
+		if (sqlite3_step(insert) != SQLITE_DONE ||
+		    sqlite3_step(update) != SQLITE_DONE)
+			goto rollback;
+		sqlite3_reset(insert);
+		sqlite3_reset(update);
+	}
+
+	if (sqlite3_exec(db, "COMMIT", NULL, NULL, NULL) == SQLITE_OK) {
+		rc = 0;
+		goto finalize;
+	}
+
+rollback:
+	sqlite3_exec(db, "ROLLBACK", NULL, NULL, NULL);
+finalize:
+	sqlite3_finalize(insert);
+	sqlite3_finalize(update);
+out:
+	free(stats->counts);
+	memset(stats, 0, sizeof(*stats));
+	return rc;
+}
+
+/*
+ * Microseconds since the epoch, so that they can be compared with the
+ * time a record was logged; a step of the clock only skews the one
+ * measurement it falls in.
+ */
+int64_t
+slog_notify_stats_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void
+format_value(char *buf, size_t len, int metric, uint64_t usec)
+{
+	if (metric == SLOG_STAT_DEPTH)
+		snprintf(buf, len, "%" PRIu64, usec);
+	else if (usec < 1000)
+		snprintf(buf, len, "%" PRIu64 "us", usec);
+	else if (usec < 1000000)
+		snprintf(buf, len, "%" PRIu64 "ms", usec / 1000);
+	else
+		snprintf(buf, len, "%" PRIu64 "s", usec / 1000000);
+}
+
+/* A histogram as read back from the table */
+struct histogram {
+	uint64_t count[SLOG_STAT_BUCKETS];
+	uint64_t total;
+	uint64_t sum;
+};
+
+static void
+print_histogram(FILE *fp, int metric, struct histogram *h)
+{
+	static const int pct[] = { 50, 90, 99, 100 };
+	static const char *pct_names[] = { "p50", "p90", "p99", "max" };
+	uint64_t seen;
+	char buf[32];
+	int b, i;
+
+	fprintf(fp, "  %-7s n=%-8" PRIu64, metric_names[metric], h->total);
+	format_value(buf, sizeof(buf), metric,
+		     h->total ? h->sum / h->total : 0);
+	fprintf(fp, " avg %-6s", buf);
+
+	for (i = 0, b = 0, seen = 0; i < 4; i++) {
+		/* the first bucket holding the pct[i]th percentile */
+		while (b < SLOG_STAT_BUCKETS &&
+		       (seen + h->count[b]) * 100 < h->total * pct[i])
+			seen += h->count[b++];
+		format_value(buf, sizeof(buf), metric,
+			     bucket_limit(b < SLOG_STAT_BUCKETS ? b :
+					  SLOG_STAT_BUCKETS - 1));
+		fprintf(fp, " %s<%-6s", pct_names[i], buf);
+	}
+	fprintf(fp, "\n");
+}
+
+/* The counts of one (source, id, metric) */
+struct group {
+	int source;
+	uint64_t id;
+	int metric;
+	int first;		/* the first group of this (source, id) */
+	struct histogram h;
+	uint64_t exits[SLOG_STAT_NOT_RUN + 1];
+};
+
+/*
+ * Walk the table one group at a time, for one metric or for all (-1);
+ * each group is passed to emit() once it is complete.
+ */
+typedef void (*emit_fn)(FILE *fp, struct group *g);
+
+static int
+walk_stats(FILE *fp, sqlite3 *db, int only, emit_fn emit)
+{
+	sqlite3_stmt *stmt;
+	struct group g;
+	uint64_t count;
+	int rc, s, m, b;
+	int64_t i;
+
+	if (sqlite3_prepare_v2(db, "SELECT source, id, metric, bucket, count "
+			       "FROM notify_stats WHERE ?1 < 0 OR metric = ?1 "
+			       /* the exit line ends the group in the text */
+			       "ORDER BY source, id, metric = 3, metric, bucket",
+			       -1, &stmt, NULL) != SQLITE_OK)
+		/* nothing has been delivered yet */
+		return 0;
+	sqlite3_bind_int(stmt, 1, only);
+
+	memset(&g, 0, sizeof(g));
+	g.metric = -1;
+	g.first = 1;
+	for (;;) {
+		rc = sqlite3_step(stmt);
+		if (rc == SQLITE_ROW) {
+			s = sqlite3_column_int(stmt, 0);
+			i = sqlite3_column_int64(stmt, 1);
+			m = sqlite3_column_int(stmt, 2);
+			b = sqlite3_column_int(stmt, 3);
+			count = sqlite3_column_int64(stmt, 4);
+		}
+
+		if (g.metric >= 0 && (rc != SQLITE_ROW || s != g.source ||
+				      (uint64_t)i != g.id || m != g.metric)) {
+			emit(fp, &g);
+			g.first = (rc != SQLITE_ROW || s != g.source ||
+				   (uint64_t)i != g.id);
+			memset(&g.h, 0, sizeof(g.h));
+			memset(g.exits, 0, sizeof(g.exits));
+		}
+		if (rc != SQLITE_ROW)
+			break;
+
+		g.source = s;
+		g.id = i;
+		g.metric = m;
+		if (m == SLOG_STAT_EXIT) {
+			if (b >= 0 && b <= SLOG_STAT_NOT_RUN)
+				g.exits[b] += count;
+		}
+		else if (b == SLOG_STAT_SUM)
+			g.h.sum += count;
+		else if (b >= 0 && b < SLOG_STAT_BUCKETS) {
+			g.h.count[b] += count;
+			g.h.total += count;
+		}
+	}
+	sqlite3_finalize(stmt);
+
+	return rc == SQLITE_DONE ? 0 : -1;
+}
+
+static void
+emit_text(FILE *fp, struct group *g)
+{
+	int i;
+
+	if (g->first && g->source == SLOG_STAT_LANE)
+		fprintf(fp, "Lane %s:\n", g->id < SLOG_LANES ?
+			lane_names[g->id] : "unknown");
+	else if (g->first)
+		fprintf(fp, "%s %" PRIu64 ":\n", g->source == SLOG_STAT_TOOL ?
+			"Notification Tool" : "Subscriber", g->id);
+
+	if (g->metric != SLOG_STAT_EXIT) {
+		print_histogram(fp, g->metric, &g->h);
+		/* lanes have no exit line to end them */
+		if (g->source == SLOG_STAT_LANE &&
+		    g->metric == SLOG_STAT_DEPTH)
+			fprintf(fp, "\n");
+		return;
+	}
+
+	fprintf(fp, "  exit   ");
+	for (i = 0; i <= SLOG_STAT_NOT_RUN; i++) {
+		if (!g->exits[i])
+			continue;
+		if (i == SLOG_STAT_NOT_RUN)
+			fprintf(fp, " not-run:%" PRIu64, g->exits[i]);
+		else if (i >= SLOG_STAT_SIGNALED)
+			fprintf(fp, " signal-%d:%" PRIu64,
+				i - SLOG_STAT_SIGNALED, g->exits[i]);
+		else
+			fprintf(fp, " %d:%" PRIu64, i, g->exits[i]);
+	}
+	fprintf(fp, "\n\n");
+}
+
+/**
+ * slog_notify_stats_print
+ * @brief Print the delivery statistics of every tool and subscriber
+ *
+ * @return 0 on success, -1 on a database error
+ */
+int
+slog_notify_stats_print(FILE *fp, sqlite3 *db)
+{
+	return walk_stats(fp, db, -1, emit_text);
+}
+
+static void
+emit_prometheus(FILE *fp, struct group *g)
+{
+	struct histogram *h = &g->h;
+	const char *name = metric_names[g->metric];
+	const char *unit = (g->metric == SLOG_STAT_DEPTH) ? "" : "_seconds";
+	double scale = (g->metric == SLOG_STAT_DEPTH) ? 1 : 1e6;
+	char labels[96];
+	uint64_t seen = 0;
+	int i;
+
+	if (g->source == SLOG_STAT_LANE)
+		snprintf(labels, sizeof(labels), "source=\"lane\",id=\"%s\"",
+			 g->id < SLOG_LANES ? lane_names[g->id] : "unknown");
+	else
+		snprintf(labels, sizeof(labels), "source=\"%s\",id=\"%" PRIu64
+			 "\"", source_names[g->source & 1], g->id);
+
+	if (g->metric == SLOG_STAT_EXIT) {
+		for (i = 0; i <= SLOG_STAT_NOT_RUN; i++)
+			if (g->exits[i])
+				fprintf(fp, "servicelog_notify_exit_total{%s,"
+					"status=\"%d\"} %" PRIu64 "\n", labels,
+					i, g->exits[i]);
+		return;
+	}
+
+	for (i = 0; i < SLOG_STAT_BUCKETS; i++) {
+		seen += h->count[i];
+		fprintf(fp, "servicelog_notify_%s%s_bucket{%s,le=\"%g\"} "
+			"%" PRIu64 "\n", name, unit, labels,
+			(double)(i ? bucket_limit(i) : 0) / scale, seen);
+	}
+	fprintf(fp, "servicelog_notify_%s%s_bucket{%s,le=\"+Inf\"} %" PRIu64
+		"\n", name, unit, labels, h->total);
+	fprintf(fp, "servicelog_notify_%s%s_sum{%s} %g\n", name, unit, labels,
+		(double)h->sum / scale);
+	fprintf(fp, "servicelog_notify_%s%s_count{%s} %" PRIu64 "\n", name,
+		unit, labels, h->total);
+}
+
+/**
+ * slog_notify_stats_write
+ * @brief Write the delivery statistics as a Prometheus text file
+ *
+ * The file is written next to path and renamed into place, so a
+ * collector never reads half of it.
+ *
+ * @param path file to write
+ * @param db servicelog database
+ * @param error buffer for an error message
+ * @param error_len size of error
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_notify_stats_write(const char *path, sqlite3 *db, char *error,
+			size_t error_len)
+{
+	char tmp[4096];
+	FILE *fp;
+	int m, rc = 0;
+
+	if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) {
+		snprintf(error, error_len, "%s: Path too long", path);
+		return -1;
+	}
+
+	fp = fopen(tmp, "w");
+	if (fp == NULL) {
+		snprintf(error, error_len, "%s: %s", tmp, strerror(errno));
+		return -1;
+	}
+
+	/* each metric's lines must be together, after its HELP and TYPE */
+	for (m = 0; m < SLOG_STAT_N_METRICS && rc == 0; m++) {
+		if (m == SLOG_STAT_EXIT)
+			fprintf(fp, "# HELP servicelog_notify_exit_total %s\n"
+				"# TYPE servicelog_notify_exit_total counter\n",
+				metric_help[m]);
+		else
+			fprintf(fp, "# HELP servicelog_notify_%s%s %s\n"
+				"# TYPE servicelog_notify_%s%s histogram\n",
+				metric_names[m], m == SLOG_STAT_DEPTH ? "" :
+				"_seconds", metric_help[m], metric_names[m],
+				m == SLOG_STAT_DEPTH ? "" : "_seconds");
+		rc = walk_stats(fp, db, m, emit_prometheus);
+	}
+
+	if ((fclose(fp) != 0) | (rc != 0)) {
+		snprintf(error, error_len, "%s: %s", tmp, rc ?
+			 sqlite3_errmsg(db) : strerror(errno));
+		unlink(tmp);
+		return -1;
+	}
+	if (rename(tmp, path) != 0) {
+		snprintf(error, error_len, "%s: %s", path, strerror(errno));
+		unlink(tmp);
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,74 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_NOTIFY_STATS_H
+#define SLOG_NOTIFY_STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <servicelog-1/servicelog.h>
+
+/*
+ * Delivery histograms, per notification tool, per subscriber and per
+ * priority lane.  Times are counted in power-of-two buckets of
+ * microseconds: bucket 0 holds 0us, bucket b holds [2^(b-1), 2^b) us;
+ * queue depths in the same buckets of records.  The queue and latency
+ * of a tool or subscriber count from the commit of the record; for a
+ * lane, the queue is the time spent in the lane.  Exit statuses are
+ * counted as they are: 0-255 for an exit, SLOG_STAT_SIGNALED + n for
+ * signal n, and SLOG_STAT_NOT_RUN when the tool could not be started
+ * (or, for a subscriber, 0 for an acknowledged delivery and 1 for a
+ * failed one).
+ */
+#define SLOG_STAT_QUEUE		0	/* commit -> delivery start */
+#define SLOG_STAT_SPAWN		1	/* starting the tool */
+#define SLOG_STAT_RUN		2	/* tool started -> tool finished */
+#define SLOG_STAT_EXIT		3	/* exit status */
+#define SLOG_STAT_DEPTH		4	/* records waiting in a lane */
+#define SLOG_STAT_LATENCY	5	/* commit -> delivery finished */
+#define SLOG_STAT_N_METRICS	6
+
+#define SLOG_STAT_TOOL		0
+#define SLOG_STAT_SUBSCRIBER	1
+#define SLOG_STAT_LANE		2	/* id is a SLOG_LANE_* */
+
+#define SLOG_STAT_BUCKETS	40
+#define SLOG_STAT_SIGNALED	256
+#define SLOG_STAT_NOT_RUN	512
+
+/* Bucket holding the sum of the values of a time metric */
+#define SLOG_STAT_SUM		(-1)
+
+struct slog_stat_count {
+	int source;		/* SLOG_STAT_TOOL, _SUBSCRIBER or _LANE */
+	uint64_t id;		/* notification tool, subscriber or lane */
+	int metric;
+	int bucket;
+	uint64_t count;
+};
+
+/*
+ * Counts gathered during a dispatch, written out together by
+ * slog_notify_stats_flush() so that no write lock is held while the
+ * tools run.
+ */
+struct slog_notify_stats {
+	struct slog_stat_count *counts;
+	size_t n;
+	size_t max;
+};
+
+extern void slog_notify_stats_add(struct slog_notify_stats *stats,
+				  int source, uint64_t id, int metric,
+				  int64_t value);
+extern int slog_notify_stats_flush(struct slog_notify_stats *stats,
+				   sqlite3 *db);
+extern int64_t slog_notify_stats_usec(void);
+extern int slog_notify_stats_print(FILE *fp, sqlite3 *db);
+extern int slog_notify_stats_write(const char *path, sqlite3 *db,
+				   char *error, size_t error_len);
+
+#endif
@@ -0,0 +1,342 @@
+/**
+ * @file slog_output.c
+ * @brief Command output with optional compression on a separate thread
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "config.h"
+#if defined(HAVE_LIBZ) && defined(HAVE_ZLIB_H)
+#define SLOG_WITH_GZIP
+#include <zlib.h>
+#endif
+#if defined(HAVE_LIBZSTD) && defined(HAVE_ZSTD_H)
+#define SLOG_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include "slog_output.h"
+
+#define CHUNK_SIZE	(128 * 1024)
+#define PIPE_SIZE	(1024 * 1024)
+#define ZSTD_LEVEL	3
+
+/**
+ * slog_output_method
+ * @brief Convert the argument of --compress to a SLOG_COMPRESS_* value
+ *
+ * @param name compression method name
+ * @return the method, or -1 if it is unknown or not built in
+ */
+int
+slog_output_method(const char *name)
+{
+#ifdef SLOG_WITH_GZIP
+	if (!strcmp(name, "gzip"))
+		return SLOG_COMPRESS_GZIP;
+#endif
+#ifdef SLOG_WITH_ZSTD
+	if (!strcmp(name, "zstd"))
+		return SLOG_COMPRESS_ZSTD;
+#endif
+	if (!strcmp(name, "none"))
+		return SLOG_COMPRESS_NONE;
+
+	return -1;
+}
+
+static int
+write_all(int fd, const void *buf, size_t len)
+{
+	const char *p = buf;
+	ssize_t n;
+
+	while (len > 0) {
+		n = write(fd, p, len);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		p += n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+static ssize_t
+read_chunk(int fd, void *buf, size_t len)
+{
+	ssize_t n;
+
+	do {
+		n = read(fd, buf, len);
+	} while (n < 0 && errno == EINTR);
+
+	return n;
+}
+
+#ifdef SLOG_WITH_GZIP
+static int
+compress_gzip(struct slog_output *out, char *in, char *obuf)
+{
+	z_stream zs;
+	ssize_t n;
+	int flush, zrc;
+
+	memset(&zs, 0, sizeof(zs));
+	/* 15 bits of window, +16 for a gzip rather than zlib wrapper */
+	if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+			 Z_DEFAULT_STRATEGY) != Z_OK) {
+		snprintf(out->error, sizeof(out->error),
+			 "Could not initialize gzip compression");
+		return -1;
+	}
+
+	do {
+		n = read_chunk(out->pipe_fd, in, CHUNK_SIZE);
+		if (n < 0)
+			goto err_io;
+		flush = (n == 0) ? Z_FINISH : Z_NO_FLUSH;
+
+		zs.next_in = (Bytef *)in;
+		zs.avail_in = n;
+		do {
+			zs.next_out = (Bytef *)obuf;
+			zs.avail_out = CHUNK_SIZE;
+			zrc = deflate(&zs, flush);
+			if (zrc == Z_STREAM_ERROR) {
+				snprintf(out->error, sizeof(out->error),
+					 "gzip compression failed");
+				deflateEnd(&zs);
+				return -1;
+			}
+			if (write_all(out->out_fd, obuf,
+				      CHUNK_SIZE - zs.avail_out))
+				goto err_io;
+		} while (zs.avail_out == 0);
+	} while (flush != Z_FINISH);
+
+	deflateEnd(&zs);
+	return 0;
+
+err_io:
+	snprintf(out->error, sizeof(out->error), "%s", strerror(errno));
+	deflateEnd(&zs);
+	return -1;
+}
+#endif
+
+#ifdef SLOG_WITH_ZSTD
+static int
+compress_zstd(struct slog_output *out, char *in, char *obuf)
+{
+	ZSTD_CCtx *cctx;
+	ZSTD_inBuffer zin;
+	ZSTD_outBuffer zout;
+	ZSTD_EndDirective mode;
+	size_t remaining;
+	ssize_t n;
+	int done;
+
+	cctx = ZSTD_createCCtx();
+	if (cctx == NULL) {
+		snprintf(out->error, sizeof(out->error),
+			 "Could not initialize zstd compression");
+		return -1;
+	}
+	ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, ZSTD_LEVEL);
+	ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 1);
+
+	do {
+		n = read_chunk(out->pipe_fd, in, CHUNK_SIZE);
+		if (n < 0)
+			goto err_io;
+		mode = (n == 0) ? ZSTD_e_end : ZSTD_e_continue;
+
+		zin.src = in;
+		zin.size = n;
+		zin.pos = 0;
+		do {
+			zout.dst = obuf;
+			zout.size = CHUNK_SIZE;
+			zout.pos = 0;
+			remaining = ZSTD_compressStream2(cctx, &zout, &zin,
+							 mode);
+			if (ZSTD_isError(remaining)) {
+				snprintf(out->error, sizeof(out->error),
+					 "zstd compression failed: %s",
+					 ZSTD_getErrorName(remaining));
+				ZSTD_freeCCtx(cctx);
+				return -1;
+			}
+			if (write_all(out->out_fd, obuf, zout.pos))
+				goto err_io;
+			done = (mode == ZSTD_e_end) ? (remaining == 0)
+						    : (zin.pos == zin.size);
+		} while (!done);
+	} while (mode != ZSTD_e_end);
+
+	ZSTD_freeCCtx(cctx);
+	return 0;
+
+err_io:
+	snprintf(out->error, sizeof(out->error), "%s", strerror(errno));
+	ZSTD_freeCCtx(cctx);
+	return -1;
+}
+#endif
+
+static void *
+compress_thread(void *arg)
+{
+	struct slog_output *out = arg;
+	char *in, *obuf;
+
+	in = malloc(CHUNK_SIZE);
+	obuf = malloc(CHUNK_SIZE);
+	if (in == NULL || obuf == NULL) {
+		snprintf(out->error, sizeof(out->error), "Out of memory");
+		out->rc = -1;
+		goto out;
+	}
+
+	switch (out->method) {
+#ifdef SLOG_WITH_GZIP
+	case SLOG_COMPRESS_GZIP:
+		out->rc = compress_gzip(out, in, obuf);
+		break;
+#endif
+#ifdef SLOG_WITH_ZSTD
+	case SLOG_COMPRESS_ZSTD:
+		out->rc = compress_zstd(out, in, obuf);
+		break;
+#endif
+	default:
+		snprintf(out->error, sizeof(out->error),
+			 "Unsupported compression method");
+		out->rc = -1;
+	}
+
+out:
+	/*
+	 * Drain the pipe after an error, so that the writer sees an EOF
+	 * on its side rather than blocking forever on a full pipe.
+	 */
+	if (out->rc && in)
+		while (read_chunk(out->pipe_fd, in, CHUNK_SIZE) > 0)
+			;
+	close(out->pipe_fd);
+	free(in);
+	free(obuf);
+	return NULL;
+}
+
+/**
+ * slog_output_open
+ * @brief Set up the output stream of a command
+ *
+ * @param out output stream to set up; out->error is set on failure
+ * @param method SLOG_COMPRESS_* value
+ * @param out_fd file descriptor to write the (compressed) output to
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_output_open(struct slog_output *out, int method, int out_fd)
+{
+	int pipefd[2], rc;
+
+	memset(out, 0, sizeof(*out));
+	out->method = method;
+	out->out_fd = out_fd;
+
+	if (method == SLOG_COMPRESS_NONE) {
+		out->fp = stdout;
+		return 0;
+	}
+
+	if (pipe(pipefd) == -1) {
+		snprintf(out->error, sizeof(out->error), "%s",
+			 strerror(errno));
+		return -1;
+	}
+#ifdef F_SETPIPE_SZ
+	/* fewer, larger handoffs between the two threads; best effort */
+	fcntl(pipefd[1], F_SETPIPE_SZ, PIPE_SIZE);
+#endif
+
+	out->fp = fdopen(pipefd[1], "w");
+	if (out->fp == NULL) {
+		snprintf(out->error, sizeof(out->error), "%s",
+			 strerror(errno));
+		close(pipefd[0]);
+		close(pipefd[1]);
+		return -1;
+	}
+	out->buf = malloc(CHUNK_SIZE);
+	if (out->buf)
+		setvbuf(out->fp, out->buf, _IOFBF, CHUNK_SIZE);
+	out->pipe_fd = pipefd[0];
+
+	rc = pthread_create(&out->thread, NULL, compress_thread, out);
+	if (rc != 0) {
+		snprintf(out->error, sizeof(out->error), "%s", strerror(rc));
+		fclose(out->fp);
+		close(pipefd[0]);
+		free(out->buf);
+		out->fp = NULL;
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * slog_output_close
+ * @brief Flush the output stream and wait for compression to finish
+ *
+ * @param out output stream; out->error is set on failure
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_output_close(struct slog_output *out)
+{
+	int rc = 0;
+
+	if (out->fp == NULL)
+		return 0;
+
+	if (out->method == SLOG_COMPRESS_NONE) {
+		if (fflush(out->fp) != 0) {
+			snprintf(out->error, sizeof(out->error), "%s",
+				 strerror(errno));
+			rc = -1;
+		}
+		out->fp = NULL;
+		return rc;
+	}
+
+	if (fclose(out->fp) != 0) {
+		snprintf(out->error, sizeof(out->error), "%s",
+			 strerror(errno));
+		rc = -1;
+	}
+	out->fp = NULL;
+	free(out->buf);
+	out->buf = NULL;
+
+	pthread_join(out->thread, NULL);
+	if (out->rc)
+		rc = -1;
+
+	return rc;
+}
@@ -0,0 +1,39 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_OUTPUT_H
+#define SLOG_OUTPUT_H
+
+#include <stdio.h>
+#include <pthread.h>
+
+enum {
+	SLOG_COMPRESS_NONE = 0,
+	SLOG_COMPRESS_GZIP,
+	SLOG_COMPRESS_ZSTD,
+};
+
+/*
+ * Command output, optionally compressed.  Text is printed to fp; when
+ * compressing, fp is the write end of a pipe that a separate thread
+ * drains, compresses and writes to the real output, so compression
+ * overlaps with reading and formatting records.
+ */
+struct slog_output {
+	FILE *fp;
+	char *buf;		/* stdio buffer of fp */
+	int method;		/* SLOG_COMPRESS_* */
+	int out_fd;
+	int pipe_fd;		/* read end, owned by the thread */
+	pthread_t thread;
+	int rc;			/* set by the thread */
+	char error[256];
+};
+
+extern int slog_output_method(const char *name);
+extern int slog_output_open(struct slog_output *out, int method, int out_fd);
+extern int slog_output_close(struct slog_output *out);
+
+#endif
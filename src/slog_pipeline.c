@@ -0,0 +1,517 @@
+/**
+ * @file slog_pipeline.c
+ * @brief Fetch and format events on several workers, write them in order
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+#include "config.h"
+#include "slog_pipeline.h"
+
+/* ids per block; bounds the memory each worker holds at once */
+#define BLOCK_IDS	1024
+#define COPY_SIZE	(64 * 1024)
+
+static int
+write_all(int fd, const void *buf, size_t len)
+{
+	const char *p = buf;
+	ssize_t n;
+
+	while (len > 0) {
+		n = write(fd, p, len);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		p += n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+static int
+read_all(int fd, void *buf, size_t len)
+{
+	char *p = buf;
+	ssize_t n;
+
+	while (len > 0) {
+		n = read(fd, p, len);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		if (n == 0)
+			return -1;	/* worker exited early */
+		p += n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+/**
+ * get_max_id
+ * @brief Find the highest event id, which bounds the dump
+ *
+ * Events logged after the dump has started are not included, so all
+ * of the workers see the same range.
+ */
+static int
+get_max_id(servicelog *slog, uint64_t *max_id)
+{
+	sqlite3_stmt *stmt;
+	int rc;
+
+	*max_id = 0;
+	rc = sqlite3_prepare_v2(slog->db, "SELECT max(id) FROM events", -1,
+				&stmt, NULL);
+	if (rc != SQLITE_OK)
+		return -1;
+
+	rc = sqlite3_step(stmt);
+	if (rc == SQLITE_ROW)
+		*max_id = sqlite3_column_int64(stmt, 0);
+	sqlite3_finalize(stmt);
+
+	return (rc == SQLITE_ROW) ? 0 : -1;
+}
+
+/* What the parent sends each worker, once it has read the id bound */
+struct plan {
+	uint64_t max_id;
+	uint64_t nblocks;
+	int32_t have_snapshot;
+	int32_t reserved;
+#ifdef HAVE_SQLITE3_SNAPSHOT
+	sqlite3_snapshot snapshot;	/* opaque, 48 bytes */
+#endif
+};
+
+#ifdef HAVE_SQLITE3_SNAPSHOT
+/**
+ * is_wal
+ * @brief Check whether the database is in write-ahead log mode
+ */
+static int
+is_wal(servicelog *slog)
+{
+	sqlite3_stmt *stmt;
+	int wal = 0;
+
+	if (sqlite3_prepare_v2(slog->db, "PRAGMA journal_mode", -1, &stmt,
+			       NULL) != SQLITE_OK)
+		return 0;
+	if (sqlite3_step(stmt) == SQLITE_ROW &&
+	    sqlite3_column_text(stmt, 0) &&
+	    strcasecmp((const char *)sqlite3_column_text(stmt, 0),
+		       "wal") == 0)
+		wal = 1;
+	sqlite3_finalize(stmt);
+
+	return wal;
+}
+#endif
+
+/**
+ * begin_read
+ * @brief Start the read transaction that the workers will share
+ *
+ * Only a snapshot of a database in WAL mode can be opened by another
+ * connection.  In rollback-journal mode, a read transaction held for
+ * the whole dump would keep writers (e.g., rtas_errd) out, so none is
+ * started and the workers share only the id bound.
+ *
+ * @param p pipeline
+ * @param slog open servicelog
+ */
+static void
+begin_read(struct slog_pipeline *p, servicelog *slog)
+{
+#ifdef HAVE_SQLITE3_SNAPSHOT
+	if (is_wal(slog) &&
+	    sqlite3_exec(slog->db, "BEGIN", NULL, NULL, NULL) == SQLITE_OK) {
+		p->slog = slog;
+		p->reading = 1;
+	}
+#endif
+}
+
+/**
+ * share_snapshot
+ * @brief Copy the snapshot of the read transaction, once it has read
+ */
+static void
+share_snapshot(struct slog_pipeline *p, struct plan *plan)
+{
+#ifdef HAVE_SQLITE3_SNAPSHOT
+	sqlite3_snapshot *snapshot;
+
+	if (p->reading &&
+	    sqlite3_snapshot_get(p->slog->db, "main",
+				 &snapshot) == SQLITE_OK) {
+		plan->snapshot = *snapshot;
+		plan->have_snapshot = 1;
+		sqlite3_snapshot_free(snapshot);
+	}
+#endif
+}
+
+static void
+end_read(struct slog_pipeline *p)
+{
+	if (p->reading)
+		sqlite3_exec(p->slog->db, "COMMIT", NULL, NULL, NULL);
+	p->reading = 0;
+}
+
+/**
+ * open_snapshot
+ * @brief Make a worker's connection read the snapshot of the dump
+ *
+ * @param plan plan received from the parent
+ * @param slog the worker's servicelog
+ * @return 0 on success, -1 on failure
+ */
+static int
+open_snapshot(struct plan *plan, servicelog *slog)
+{
+#ifdef HAVE_SQLITE3_SNAPSHOT
+	if (!plan->have_snapshot)
+		return 0;
+	if (sqlite3_exec(slog->db, "BEGIN", NULL, NULL, NULL) != SQLITE_OK ||
+	    sqlite3_snapshot_open(slog->db, "main",
+				  &plan->snapshot) != SQLITE_OK) {
+		fprintf(stderr, "Cannot read the snapshot of the dump: %s\n",
+			sqlite3_errmsg(slog->db));
+		return -1;
+	}
+#endif
+	return 0;
+}
+
+/**
+ * run_worker
+ * @brief Body of a worker process
+ *
+ * The worker opens its own database connection, in a process that has
+ * never had one, and waits for the plan of the dump.  Each block is
+ * then sent as its length followed by its text.
+ *
+ * @param p pipeline
+ * @param idx index of this worker
+ * @param query user query string, or NULL
+ * @param ctl read end of the plan pipe from the parent
+ * @param fd write end of the pipe to the parent
+ * @return exit status of the worker
+ */
+static int
+run_worker(struct slog_pipeline *p, int idx, char *query, int ctl, int fd)
+{
+	servicelog *slog;
+	struct sl_event *events;
+	struct plan plan;
+	char *where, *buf;
+	size_t where_len, len;
+	uint64_t block, first, last, hdr;
+	FILE *fp;
+	int rc;
+
+	rc = servicelog_open(&slog, 0);
+	if (rc) {
+		fprintf(stderr, "Error opening servicelog: %s\n", strerror(rc));
+		return 2;
+	}
+	if (read_all(ctl, &plan, sizeof(plan)) != 0) {
+		/* the parent gave up before the dump started */
+		servicelog_close(slog);
+		return 0;
+	}
+	close(ctl);
+	if (open_snapshot(&plan, slog) != 0) {
+		servicelog_close(slog);
+		return 2;
+	}
+
+	where_len = (query ? strlen(query) : 0) + 128;
+	where = malloc(where_len);
+	if (where == NULL) {
+		fprintf(stderr, "Out of memory\n");
+		servicelog_close(slog);
+		return 2;
+	}
+
+	for (block = idx; block < plan.nblocks; block += p->jobs) {
+		first = block * BLOCK_IDS + 1;
+		last = first + BLOCK_IDS - 1;
+		if (query)
+			snprintf(where, where_len, "(%s) AND id BETWEEN "
+				 "%" PRIu64 " AND %" PRIu64, query, first, last);
+		else
+			snprintf(where, where_len, "id BETWEEN %" PRIu64
+				 " AND %" PRIu64, first, last);
+
+		rc = servicelog_event_query(slog, where, &events);
+		if (rc != 0) {
+			fprintf(stderr, "%s\n", servicelog_error(slog));
+			goto err_out;
+		}
+
+		buf = NULL;
+		len = 0;
+		fp = open_memstream(&buf, &len);
+		if (fp == NULL) {
+			fprintf(stderr, "%s\n", strerror(errno));
+			if (events)
+				servicelog_event_free(events);
+			goto err_out;
+		}
+		if (events) {
+			servicelog_event_print(fp, events, 1);
+			servicelog_event_free(events);
+		}
+		if (fclose(fp) != 0) {
+			free(buf);
+			goto err_out;
+		}
+
+		hdr = len;
+		if (write_all(fd, &hdr, sizeof(hdr)) ||
+		    write_all(fd, buf, len)) {
+			free(buf);
+			goto err_out;
+		}
+		free(buf);
+	}
+
+	free(where);
+	servicelog_close(slog);
+	return 0;
+
+err_out:
+	free(where);
+	servicelog_close(slog);
+	return 2;
+}
+
+/**
+ * slog_pipeline_start
+ * @brief Start the worker processes of a parallel dump
+ *
+ * Workers are processes rather than threads because the libservicelog
+ * formatting routines are not guaranteed to be reentrant.  This must
+ * be called before the database is opened, before any other thread is
+ * started, and before output pipes (e.g. for compression) are created,
+ * so the workers do not inherit any of them.
+ *
+ * @param p pipeline to start; p->error is set on failure
+ * @param query user query string, or NULL for all events
+ * @param jobs number of worker processes
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_pipeline_start(struct slog_pipeline *p, char *query, int jobs)
+{
+	int ctlfd[2], pipefd[2], i, j;
+
+	memset(p, 0, sizeof(*p));
+	p->jobs = jobs;
+
+	/* don't let the workers inherit (and flush) buffered output */
+	fflush(stdout);
+	fflush(stderr);
+
+	for (i = 0; i < jobs; i++) {
+		if (pipe(ctlfd) == -1) {
+			snprintf(p->error, SL_MAX_ERR, "%s", strerror(errno));
+			goto err_out;
+		}
+		if (pipe(pipefd) == -1) {
+			snprintf(p->error, SL_MAX_ERR, "%s", strerror(errno));
+			close(ctlfd[0]);
+			close(ctlfd[1]);
+			goto err_out;
+		}
+
+		p->pid[i] = fork();
+		if (p->pid[i] == -1) {
+			snprintf(p->error, SL_MAX_ERR, "%s", strerror(errno));
+			close(ctlfd[0]);
+			close(ctlfd[1]);
+			close(pipefd[0]);
+			close(pipefd[1]);
+			goto err_out;
+		}
+
+		if (p->pid[i] == 0) {
+			/* I'm the worker. */
+			for (j = 0; j < i; j++) {
+				close(p->ctl[j]);
+				close(p->fd[j]);
+			}
+			close(ctlfd[1]);
+			close(pipefd[0]);
+			_exit(run_worker(p, i, query, ctlfd[0], pipefd[1]));
+		}
+
+		close(ctlfd[0]);
+		close(pipefd[1]);
+		p->ctl[i] = ctlfd[1];
+		p->fd[i] = pipefd[0];
+	}
+
+	return 0;
+
+err_out:
+	p->jobs = i;
+	slog_pipeline_finish(p);
+	return -1;
+}
+
+/**
+ * slog_pipeline_plan
+ * @brief Read the id bound, and send it and the snapshot to the workers
+ *
+ * @param p started pipeline; p->error is set on failure
+ * @param slog servicelog opened after slog_pipeline_start()
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_pipeline_plan(struct slog_pipeline *p, servicelog *slog)
+{
+	struct sigaction ign, old;
+	struct plan plan;
+	int i, rc = 0;
+
+	memset(&plan, 0, sizeof(plan));
+
+	/* the id bound is read within the snapshot that is shared */
+	begin_read(p, slog);
+	if (get_max_id(slog, &p->max_id) != 0) {
+		snprintf(p->error, SL_MAX_ERR, "%s", sqlite3_errmsg(slog->db));
+		end_read(p);
+		return -1;
+	}
+	p->nblocks = (p->max_id + BLOCK_IDS - 1) / BLOCK_IDS;
+	plan.max_id = p->max_id;
+	plan.nblocks = p->nblocks;
+	share_snapshot(p, &plan);
+
+	/* a worker that has already failed must not take us with it */
+	memset(&ign, 0, sizeof(ign));
+	ign.sa_handler = SIG_IGN;
+	sigaction(SIGPIPE, &ign, &old);
+	for (i = 0; i < p->jobs; i++) {
+		/* smaller than PIPE_BUF, so written at once */
+		if (write_all(p->ctl[i], &plan, sizeof(plan)) != 0 &&
+		    rc == 0) {
+			snprintf(p->error, SL_MAX_ERR, "A dump worker failed");
+			rc = -1;
+		}
+		close(p->ctl[i]);
+		p->ctl[i] = -1;
+	}
+	sigaction(SIGPIPE, &old, NULL);
+
+	return rc;
+}
+
+/**
+ * slog_pipeline_run
+ * @brief Copy the formatted blocks to the output, in id order
+ *
+ * @param p started pipeline; p->error is set on failure
+ * @param fp output stream
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_pipeline_run(struct slog_pipeline *p, FILE *fp)
+{
+	uint64_t block, hdr;
+	size_t n;
+	char *buf;
+	int fd;
+
+	buf = malloc(COPY_SIZE);
+	if (buf == NULL) {
+		snprintf(p->error, SL_MAX_ERR, "Out of memory");
+		return -1;
+	}
+
+	for (block = 0; block < p->nblocks; block++) {
+		fd = p->fd[block % p->jobs];
+
+		if (read_all(fd, &hdr, sizeof(hdr)) != 0)
+			goto err_worker;
+
+		while (hdr > 0) {
+			n = (hdr < COPY_SIZE) ? hdr : COPY_SIZE;
+			if (read_all(fd, buf, n) != 0)
+				goto err_worker;
+			if (fwrite(buf, 1, n, fp) != n) {
+				snprintf(p->error, SL_MAX_ERR, "%s",
+					 strerror(errno));
+				free(buf);
+				return -1;
+			}
+			hdr -= n;
+		}
+	}
+
+	free(buf);
+	return 0;
+
+err_worker:
+	snprintf(p->error, SL_MAX_ERR, "A dump worker failed");
+	free(buf);
+	return -1;
+}
+
+/**
+ * slog_pipeline_finish
+ * @brief Stop the workers and collect their exit status
+ *
+ * @param p pipeline; p->error is set if a worker failed
+ * @return 0 if every worker succeeded, -1 otherwise
+ */
+int
+slog_pipeline_finish(struct slog_pipeline *p)
+{
+	int i, status, rc = 0;
+
+	for (i = 0; i < p->jobs; i++) {
+		/* a worker still waiting for the plan exits */
+		if (p->ctl[i] >= 0)
+			close(p->ctl[i]);
+		/* a worker still writing gets EPIPE/SIGPIPE and exits */
+		close(p->fd[i]);
+
+		if (waitpid(p->pid[i], &status, 0) == -1 ||
+		    !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			if (rc == 0 && p->error[0] == '\0')
+				snprintf(p->error, SL_MAX_ERR,
+					 "A dump worker failed");
+			rc = -1;
+		}
+	}
+	p->jobs = 0;
+	end_read(p);
+
+	return rc;
+}
@@ -0,0 +1,47 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_PIPELINE_H
+#define SLOG_PIPELINE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <servicelog-1/servicelog.h>
+
+/* Upper bound on the number of worker processes */
+#define SLOG_PIPELINE_MAX_JOBS	64
+
+/*
+ * Parallel dump of the events table.  The id range is cut into blocks
+ * of consecutive ids; block k is fetched and formatted by worker
+ * k % jobs, and the blocks are copied to the output in id order.
+ *
+ * The workers are forked before the parent opens the database, so that
+ * none of them inherits SQLite state: each opens a connection of its
+ * own, then waits for the plan of the dump on a pipe from the parent.
+ * On a database in WAL mode, the parent holds a read transaction for
+ * the whole dump, and the plan carries its snapshot, which every
+ * worker opens.
+ */
+struct slog_pipeline {
+	int jobs;
+	uint64_t max_id;
+	uint64_t nblocks;
+	servicelog *slog;		/* holding the read transaction */
+	int reading;			/* 1 while it is held */
+	pid_t pid[SLOG_PIPELINE_MAX_JOBS];
+	int ctl[SLOG_PIPELINE_MAX_JOBS];	/* write end of each plan pipe */
+	int fd[SLOG_PIPELINE_MAX_JOBS];	/* read end of each worker's pipe */
+	char error[SL_MAX_ERR];
+};
+
+extern int slog_pipeline_start(struct slog_pipeline *p, char *query,
+			       int jobs);
+extern int slog_pipeline_plan(struct slog_pipeline *p, servicelog *slog);
+extern int slog_pipeline_run(struct slog_pipeline *p, FILE *fp);
+extern int slog_pipeline_finish(struct slog_pipeline *p);
+
+#endif
@@ -0,0 +1,177 @@
+/**
+ * @file slog_pipeline_bench.c
+ * @brief Time a dump of the servicelog by number of workers
+ *
+ * Dumps every event of the system servicelog to /dev/null (or to a
+ * file given with -o) the way "servicelog --dump" does: with one job
+ * through servicelog_event_query() and servicelog_event_print(), and
+ * with more through the worker processes of slog_pipeline.c.  Each
+ * dump is timed and printed with its rate in events per second.
+ *
+ * It only reads the servicelog, but the times only say something on a
+ * large one (a million events or more), so it is built with --with-test
+ * and run by hand rather than by "make check".
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <servicelog-1/servicelog.h>
+
+#include "slog_pipeline.h"
+
+static double
+elapsed_s(struct timespec *start)
+{
+	struct timespec end;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) +
+		(end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int64_t
+count_events(servicelog *slog)
+{
+	sqlite3_stmt *stmt;
+	int64_t n = -1;
+
+	if (sqlite3_prepare_v2(slog->db, "SELECT count(*) FROM events", -1,
+			       &stmt, NULL) != SQLITE_OK)
+		return -1;
+	if (sqlite3_step(stmt) == SQLITE_ROW)
+		n = sqlite3_column_int64(stmt, 0);
+	sqlite3_finalize(stmt);
+	return n;
+}
+
+/* The single-job path of --dump */
+static int
+dump_serial(FILE *fp, int64_t *count)
+{
+	struct sl_event *events = NULL;
+	servicelog *slog;
+	int rc;
+
+	if (servicelog_open(&slog, 0) != 0) {
+		fprintf(stderr, "Error opening servicelog\n");
+		return -1;
+	}
+	*count = count_events(slog);
+
+	rc = servicelog_event_query(slog, "", &events);
+	if (rc == 0 && servicelog_event_print(fp, events, 1) < 0)
+		rc = -1;
+	if (rc != 0)
+		fprintf(stderr, "%s\n", servicelog_error(slog));
+	if (events)
+		servicelog_event_free(events);
+	servicelog_close(slog);
+	return rc;
+}
+
+/* The --jobs path of --dump */
+static int
+dump_pipeline(FILE *fp, int jobs, int64_t *count)
+{
+	struct slog_pipeline p;
+	servicelog *slog;
+	int rc;
+
+	/* the workers are forked before the database is opened */
+	if (slog_pipeline_start(&p, NULL, jobs) != 0) {
+		fprintf(stderr, "%s\n", p.error);
+		return -1;
+	}
+	if (servicelog_open(&slog, 0) != 0) {
+		fprintf(stderr, "Error opening servicelog\n");
+		slog_pipeline_finish(&p);
+		return -1;
+	}
+	*count = count_events(slog);
+
+	rc = slog_pipeline_plan(&p, slog);
+	if (rc == 0)
+		rc = slog_pipeline_run(&p, fp);
+	if (slog_pipeline_finish(&p) != 0)
+		rc = -1;
+	if (rc != 0)
+		fprintf(stderr, "%s\n", p.error);
+	servicelog_close(slog);
+	return rc;
+}
+
+static void
+print_usage(const char *cmd)
+{
+	printf("Usage: %s [-o file] [jobs ...]\n", cmd);
+	printf("  -o: file to dump to (default /dev/null)\n");
+	printf("  jobs: numbers of jobs to dump with (default 1 2 4 8)\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+	static const char *default_jobs[] = { "1", "2", "4", "8" };
+	const char *const *jobs = default_jobs;
+	const char *path = "/dev/null";
+	int c, i, n_jobs = 4, j, rc;
+	struct timespec start;
+	int64_t count = 0;
+	double s;
+	FILE *fp;
+
+	while ((c = getopt(argc, argv, "o:h")) != -1) {
+		switch (c) {
+		case 'o':
+			path = optarg;
+			break;
+		case 'h':
+			print_usage(argv[0]);
+			exit(0);
+		default:
+			print_usage(argv[0]);
+			exit(1);
+		}
+	}
+	if (optind < argc) {
+		jobs = (const char *const *)&argv[optind];
+		n_jobs = argc - optind;
+	}
+
+	printf("%5s %10s %10s %12s\n", "jobs", "events", "seconds",
+	       "events/s");
+	for (i = 0; i < n_jobs; i++) {
+		j = atoi(jobs[i]);
+		if (j <= 0 || j > SLOG_PIPELINE_MAX_JOBS) {
+			fprintf(stderr, "%s: jobs must be 1 to %d\n", argv[0],
+				SLOG_PIPELINE_MAX_JOBS);
+			exit(1);
+		}
+
+		fp = fopen(path, "w");
+		if (fp == NULL) {
+			perror(path);
+			exit(1);
+		}
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		rc = (j == 1) ? dump_serial(fp, &count) :
+			dump_pipeline(fp, j, &count);
+		if (fclose(fp) != 0)
+			rc = -1;
+		s = elapsed_s(&start);
+		if (rc != 0)
+			exit(2);
+
+		printf("%5d %10lld %10.2f %12.0f\n", j, (long long)count, s,
+		       s > 0 ? count / s : 0);
+	}
+
+	return 0;
+}
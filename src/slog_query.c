@@ -0,0 +1,356 @@
+/**
+ * @file slog_query.c
+ * @brief Relative-time predicates in --query strings
+ *
+ * Lets a query say "time_event > now-1h" or "time_logged within 7d"
+ * instead of computing a date in the shell.  Each relative predicate is
+ * rewritten, before the query reaches libservicelog, into a comparison
+ * of the column with a constant epoch bound, in local time as
+ * libservicelog stores the columns:
+ *
+ *   time_event > now-1h   ->
+ *	time_event > datetime(1792234800, 'unixepoch', 'localtime')
+ *   time_logged within 7d ->
+ *	time_logged >= datetime(1791633600, 'unixepoch', 'localtime')
+ *
+ * The right-hand side is evaluated once per statement, so SQLite can
+ * answer the predicate with a range scan of an index on the column.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <strings.h>
+
+#include "slog_query.h"
+
+static const char *time_columns[] = { "time_logged", "time_event",
+				      "time_last_update" };
+
+#define N_TIME_COLUMNS	(sizeof(time_columns) / sizeof(time_columns[0]))
+
+static const char *operators[] = { ">=", "<=", "<>", "!=", "==", ">", "<",
+				   "=" };
+
+#define N_OPERATORS	(sizeof(operators) / sizeof(operators[0]))
+
+static int
+is_ident(char c)
+{
+	return isalnum((unsigned char)c) || c == '_';
+}
+
+static const char *
+skip_space(const char *p)
+{
+	while (isspace((unsigned char)*p))
+		p++;
+	return p;
+}
+
+/* Match a keyword, not followed by more identifier characters */
+static const char *
+match_word(const char *p, const char *word)
+{
+	size_t len = strlen(word);
+
+	if (strncasecmp(p, word, len) != 0 || is_ident(p[len]))
+		return NULL;
+	return p + len;
+}
+
+/**
+ * parse_duration
+ * @brief Parse a duration such as "90s", "15m", "1h", "7d" or "2w"
+ *
+ * @param p start of the duration
+ * @param seconds returned length of the duration
+ * @return end of the duration, or NULL if it is not valid
+ */
+static const char *
+parse_duration(const char *p, long long *seconds)
+{
+	char *end;
+	long long n;
+
+	if (!isdigit((unsigned char)*p))
+		return NULL;
+	n = strtoll(p, &end, 10);
+
+	switch (tolower((unsigned char)*end)) {
+	case 's':
+		break;
+	case 'm':
+		n *= 60;
+		break;
+	case 'h':
+		n *= 60 * 60;
+		break;
+	case 'd':
+		n *= 24 * 60 * 60;
+		break;
+	case 'w':
+		n *= 7 * 24 * 60 * 60;
+		break;
+	default:
+		return NULL;
+	}
+	if (is_ident(end[1]))
+		return NULL;
+
+	*seconds = n;
+	return end + 1;
+}
+
+/**
+ * slog_query_duration
+ * @brief Parse a whole string as a duration, e.g., "15m"
+ *
+ * @param text duration, in the form used by relative predicates
+ * @param seconds returned length of the duration
+ * @return 0 on success, -1 if text is not a duration
+ */
+int
+slog_query_duration(const char *text, long long *seconds)
+{
+	const char *end = parse_duration(text, seconds);
+
+	return (end != NULL && *end == '\0') ? 0 : -1;
+}
+
+/**
+ * parse_predicate
+ * @brief Parse what follows a time column name, if it is relative
+ *
+ * @param p text following the column name
+ * @param now current time
+ * @param op returned comparison operator
+ * @param bound returned epoch bound
+ * @param end returned end of the predicate
+ * @return 1 if a relative predicate was parsed, 0 if the text is not a
+ *	   relative predicate, -1 if it is one but is malformed
+ */
+static int
+parse_predicate(const char *p, time_t now, const char **op,
+		long long *bound, const char **end)
+{
+	const char *q;
+	long long secs;
+	size_t i;
+
+	p = skip_space(p);
+
+	q = match_word(p, "within");
+	if (q) {
+		q = parse_duration(skip_space(q), &secs);
+		if (q == NULL)
+			return -1;
+		*op = ">=";
+		*bound = (long long)now - secs;
+		*end = q;
+		return 1;
+	}
+
+	for (i = 0; i < N_OPERATORS; i++)
+		if (strncmp(p, operators[i], strlen(operators[i])) == 0)
+			break;
+	if (i == N_OPERATORS)
+		return 0;
+
+	q = match_word(skip_space(p + strlen(operators[i])), "now");
+	if (q == NULL)
+		return 0;
+
+	*op = operators[i];
+	*bound = now;
+
+	p = skip_space(q);
+	if (*p == '-' || *p == '+') {
+		q = parse_duration(skip_space(p + 1), &secs);
+		if (q == NULL)
+			return -1;
+		*bound += (*p == '-') ? -secs : secs;
+	}
+	*end = q;
+	return 1;
+}
+
+/**
+ * slog_query_rewrite
+ * @brief Replace the relative-time predicates of a query string
+ *
+ * Text inside quotes is copied unchanged.
+ *
+ * @param query query string from the command line
+ * @param now time that "now" refers to
+ * @param out returned query string; free() it when done
+ * @param error buffer for an error message
+ * @param error_len size of error
+ * @return 0 on success, -1 on a malformed predicate or out of memory
+ */
+int
+slog_query_rewrite(const char *query, time_t now, char **out,
+		   char *error, size_t error_len)
+{
+	const char *p = query, *end, *op;
+	long long bound;
+	size_t len, i;
+	FILE *fp;
+	char quote;
+	int rc;
+
+	*out = NULL;
+
+	fp = open_memstream(out, &len);
+	if (fp == NULL) {
+		snprintf(error, error_len, "Out of memory");
+		return -1;
+	}
+
+	while (*p) {
+		if (*p == '\'' || *p == '"') {
+			quote = *p;
+			fputc(*p++, fp);
+			while (*p && *p != quote)
+				fputc(*p++, fp);
+			if (*p)
+				fputc(*p++, fp);
+			continue;
+		}
+
+		if (!is_ident(*p) || (p > query && is_ident(p[-1]))) {
+			fputc(*p++, fp);
+			continue;
+		}
+
+		for (i = 0; i < N_TIME_COLUMNS; i++)
+			if (match_word(p, time_columns[i]))
+				break;
+		if (i == N_TIME_COLUMNS) {
+			fputc(*p++, fp);
+			continue;
+		}
+
+		end = p + strlen(time_columns[i]);
+		rc = parse_predicate(end, now, &op, &bound, &end);
+		if (rc < 0) {
+			snprintf(error, error_len, "Invalid relative time after "
+				 "\"%s\"; use now[-+]<n>{s|m|h|d|w} or "
+				 "within <n>{s|m|h|d|w}", time_columns[i]);
+			fclose(fp);
+			free(*out);
+			*out = NULL;
+			return -1;
+		}
+		if (rc == 0) {
+			fputs(time_columns[i], fp);
+			p = end;
+			continue;
+		}
+
+		fprintf(fp, "%s %s datetime(%lld, 'unixepoch', 'localtime')",
+			time_columns[i], op, bound);
+		p = end;
+	}
+
+	if (fclose(fp) != 0) {
+		snprintf(error, error_len, "Out of memory");
+		free(*out);
+		*out = NULL;
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * slog_query_location
+ * @brief Build a predicate matching a location code and everything under it
+ *
+ * Location codes are hierarchical, with segments separated by '-'
+ * (unit U78D2.001.XXXX, drawer -P1, slot -C7, ...).  Every code under
+ * "<prefix>" sorts between "<prefix>-" and "<prefix>." ('.' follows
+ * '-' in ASCII), so the lookup is one equality and one range scan of an
+ * index on the column: O(log n + k), and "-P1" does not match "-P10".
+ *
+ * @param column column holding location codes
+ * @param prefix location code prefix, on a segment boundary
+ * @param buf buffer for the predicate
+ * @param len size of buf
+ * @return 0 on success, -1 if prefix is empty or buf is too small
+ */
+int
+slog_query_location(const char *column, const char *prefix, char *buf,
+		    size_t len)
+{
+	char quoted[256], *q = quoted;	/* codes are at most 80 chars */
+	size_t n;
+	int rc;
+
+	n = strlen(prefix);
+	while (n > 0 && prefix[n - 1] == '-')
+		n--;
+	/* an empty prefix would match every location */
+	if (n == 0 || 2 * n + 1 > sizeof(quoted))
+		return -1;
+
+	for (; n > 0; n--, prefix++) {
+		if (*prefix == '\'')
+			*q++ = '\'';
+		*q++ = *prefix;
+	}
+	*q = '\0';
+
+	rc = snprintf(buf, len, "%s = '%s' OR (%s >= '%s-' AND %s < '%s.')",
+		      column, quoted, column, quoted, column, quoted);
+	return (rc < 0 || (size_t)rc >= len) ? -1 : 0;
+}
+
+/**
+ * slog_query_ids
+ * @brief Load a set of ids into a temporary table for SLOG_QUERY_IDS
+ *
+ * The table lives in the connection's temporary database, so this
+ * works on a read-only servicelog and never locks it; the events are
+ * then fetched by one query rather than one lookup per id.
+ *
+ * @param slog open servicelog
+ * @param ids ids to load; duplicates are ignored
+ * @return 0 on success, -1 on a database error
+ */
+int
+slog_query_ids(servicelog *slog, struct slog_ids *ids)
+{
+	sqlite3_stmt *stmt;
+	size_t i;
+	int rc;
+
+	if (sqlite3_exec(slog->db, "CREATE TEMP TABLE IF NOT EXISTS slog_ids "
+			 "(id INTEGER PRIMARY KEY)", NULL, NULL,
+			 NULL) != SQLITE_OK ||
+	    sqlite3_exec(slog->db, "DELETE FROM temp.slog_ids; BEGIN", NULL,
+			 NULL, NULL) != SQLITE_OK)
+		return -1;
+
+	rc = sqlite3_prepare_v2(slog->db, "INSERT OR IGNORE INTO "
+				"temp.slog_ids (id) VALUES (?)", -1, &stmt,
+				NULL);
+	for (i = 0; rc == SQLITE_OK && i < ids->n; i++) {
+		sqlite3_bind_int64(stmt, 1, ids->id[i]);
+		rc = sqlite3_step(stmt);
+		rc = (rc == SQLITE_DONE) ? sqlite3_reset(stmt) : rc;
+	}
+	sqlite3_finalize(stmt);
+
+	if (rc == SQLITE_OK &&
+	    sqlite3_exec(slog->db, "COMMIT", NULL, NULL, NULL) == SQLITE_OK)
+		return 0;
+
+	sqlite3_exec(slog->db, "ROLLBACK", NULL, NULL, NULL);
+	return -1;
+}
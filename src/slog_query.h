@@ -0,0 +1,27 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_QUERY_H
+#define SLOG_QUERY_H
+
+#include <stddef.h>
+#include <time.h>
+#include <servicelog-1/servicelog.h>
+#include "slog_ids.h"
+
+/* Events that need action; answered from the events_open index */
+#define SLOG_QUERY_OPEN			"serviceable=1 AND closed=0"
+
+/* Events whose ids were loaded by slog_query_ids() */
+#define SLOG_QUERY_IDS			"id IN (SELECT id FROM temp.slog_ids)"
+
+extern int slog_query_rewrite(const char *query, time_t now, char **out,
+			      char *error, size_t error_len);
+extern int slog_query_duration(const char *text, long long *seconds);
+extern int slog_query_location(const char *column, const char *prefix,
+			       char *buf, size_t len);
+extern int slog_query_ids(servicelog *slog, struct slog_ids *ids);
+
+#endif
@@ -0,0 +1,419 @@
+/**
+ * @file slog_recent.c
+ * @brief Publish and read the shared-memory ring of recent events
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "slog_recent.h"
+
+#define RING_SIZE	(sizeof(struct slog_recent_header) + \
+			 SLOG_RECENT_SLOTS * sizeof(struct slog_recent_slot))
+
+/**
+ * trusted
+ * @brief Check that a ring belongs to uid, and that no one else can write it
+ *
+ * Anyone may create a shared memory object of this name first, so a
+ * ring made by another user is never read nor published to.
+ */
+static int
+trusted(const struct stat *sbuf, uid_t uid)
+{
+	return sbuf->st_uid == uid &&
+	       (sbuf->st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+static void
+copy_string(char *to, size_t len, const char *from)
+{
+	/* pads with NULs, so no stale bytes are left in the slot */
+	strncpy(to, from ? from : "", len - 1);
+	to[len - 1] = '\0';
+}
+
+/**
+ * fill_slot
+ * @brief Write record n to its slot, as a seqlock write
+ */
+static void
+fill_slot(struct slog_recent_slot *slot, uint64_t n, time_t now,
+	  struct sl_event *e)
+{
+	__atomic_store_n(&slot->seq, 2 * n + 1, __ATOMIC_RELAXED);
+	/* readers must see the odd seq before any of the new values */
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	slot->published = now;
+	slot->id = e->id;
+	slot->time_logged = e->time_logged ? e->time_logged : now;
+	slot->time_event = e->time_event;
+	slot->repair = e->repair;
+	slot->type = e->type;
+	slot->severity = e->severity;
+	slot->serviceable = e->serviceable != 0;
+	slot->closed = e->closed != 0;
+	slot->reserved = 0;
+	copy_string(slot->refcode, sizeof(slot->refcode), e->refcode);
+	copy_string(slot->description, sizeof(slot->description),
+		    e->description);
+
+	__atomic_store_n(&slot->seq, 2 * n + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * create_ring
+ * @brief Create the ring, if no one else has, and set it up
+ *
+ * The magic is written last, so no one uses the ring before its mutex
+ * is initialized.
+ *
+ * @return 0 on success, -1 on failure (EEXIST if another writer made
+ *	   it first)
+ */
+static int
+create_ring(void)
+{
+	struct slog_recent_header *hdr;
+	pthread_mutexattr_t attr;
+	void *map;
+	int fd, rc;
+
+	fd = shm_open(SLOG_RECENT_NAME, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC,
+		      0644);
+	if (fd < 0)
+		return -1;
+
+	/* readers need not share our umask */
+	if (fchmod(fd, 0644) != 0 || ftruncate(fd, RING_SIZE) != 0)
+		goto err_out;
+	map = mmap(NULL, RING_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+		   0);
+	if (map == MAP_FAILED)
+		goto err_out;
+
+	hdr = map;
+	hdr->version = SLOG_RECENT_VERSION;
+	hdr->slots = SLOG_RECENT_SLOTS;
+	hdr->slot_size = sizeof(struct slog_recent_slot);
+	hdr->head = 0;
+	hdr->dropped = 0;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+	pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+	rc = pthread_mutex_init(&hdr->lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+	if (rc != 0) {
+		munmap(map, RING_SIZE);
+		goto err_out;
+	}
+
+	/* readers and writers check the magic first */
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	memcpy(hdr->magic, SLOG_RECENT_MAGIC, sizeof(hdr->magic));
+	munmap(map, RING_SIZE);
+	close(fd);
+	return 0;
+
+err_out:
+	shm_unlink(SLOG_RECENT_NAME);
+	close(fd);
+	return -1;
+}
+
+/**
+ * open_ring
+ * @brief Map the ring for writing, creating it if there is none
+ *
+ * A ring of an older layout that we own is removed, to be created
+ * again on the next try.
+ *
+ * @param ring returned mapping of RING_SIZE bytes
+ * @return 0 on success, EAGAIN to try again, -1 on failure
+ */
+static int
+open_ring(struct slog_recent_header **ring)
+{
+	struct slog_recent_header *hdr;
+	struct stat sbuf;
+	void *map;
+	int fd, rc = -1;
+
+	fd = shm_open(SLOG_RECENT_NAME, O_RDWR | O_CLOEXEC, 0);
+	if (fd < 0) {
+		if (errno != ENOENT)
+			return -1;
+		return (create_ring() == 0 || errno == EEXIST) ? EAGAIN : -1;
+	}
+
+	if (fstat(fd, &sbuf) != 0 || !trusted(&sbuf, geteuid()))
+		goto out_close;
+	if (sbuf.st_size == 0)
+		goto out_close;		/* still being created */
+	if ((size_t)sbuf.st_size != RING_SIZE) {
+		shm_unlink(SLOG_RECENT_NAME);
+		rc = EAGAIN;
+		goto out_close;
+	}
+
+	map = mmap(NULL, RING_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+		   0);
+	if (map == MAP_FAILED)
+		goto out_close;
+
+	hdr = map;
+	if (memcmp(hdr->magic, SLOG_RECENT_MAGIC, sizeof(hdr->magic)) != 0) {
+		/* still being created */
+		munmap(map, RING_SIZE);
+		goto out_close;
+	}
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	if (hdr->version != SLOG_RECENT_VERSION ||
+	    hdr->slots != SLOG_RECENT_SLOTS ||
+	    hdr->slot_size != sizeof(struct slog_recent_slot)) {
+		munmap(map, RING_SIZE);
+		shm_unlink(SLOG_RECENT_NAME);
+		rc = EAGAIN;
+		goto out_close;
+	}
+
+	*ring = hdr;
+	rc = 0;
+
+out_close:
+	close(fd);
+	return rc;
+}
+
+/**
+ * slog_recent_publish
+ * @brief Add events to the ring of recent events
+ *
+ * Creates the ring if it does not exist yet.  Call it only after the
+ * events have been logged, so that every id in the ring is in the
+ * database.  Failures are not reported; the ring is a cache.  The
+ * events are added to the dropped count of the ring when another
+ * writer holds it for longer than SLOG_RECENT_LOCK_WAIT_MS, and are
+ * not published at all when the ring belongs to another user.
+ *
+ * @param events list of events, with their ids assigned
+ * @return 0 on success, -1 if the events were not published
+ */
+int
+slog_recent_publish(struct sl_event *events)
+{
+	struct slog_recent_header *hdr;
+	struct slog_recent_slot *slots;
+	struct sl_event *e;
+	struct timespec deadline;
+	time_t now = time(NULL);
+	uint64_t n, count = 0;
+	int tries, rc;
+
+	for (tries = 0; tries < 3; tries++) {
+		rc = open_ring(&hdr);
+		if (rc != EAGAIN)
+			break;
+	}
+	if (rc != 0)
+		return -1;
+	slots = (struct slog_recent_slot *)(hdr + 1);
+
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_nsec += SLOG_RECENT_LOCK_WAIT_MS * 1000000L;
+	deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+	deadline.tv_nsec %= 1000000000L;
+
+	rc = pthread_mutex_timedlock(&hdr->lock, &deadline);
+	if (rc == EOWNERDEAD) {
+		/* its half-written slot has an odd seq, and is reused */
+		pthread_mutex_consistent(&hdr->lock);
+		rc = 0;
+	}
+	if (rc != 0) {
+		for (e = events; e; e = e->next)
+			count++;
+		__atomic_add_fetch(&hdr->dropped, count, __ATOMIC_RELAXED);
+		munmap(hdr, RING_SIZE);
+		return -1;
+	}
+
+	for (e = events; e; e = e->next) {
+		n = hdr->head;
+		fill_slot(&slots[n % SLOG_RECENT_SLOTS], n, now, e);
+		__atomic_store_n(&hdr->head, n + 1, __ATOMIC_RELEASE);
+	}
+
+	pthread_mutex_unlock(&hdr->lock);
+	munmap(hdr, RING_SIZE);
+	return 0;
+}
+
+/**
+ * read_slot
+ * @brief Copy record n, if its slot still holds all of it
+ *
+ * @return 0 on success, -1 if the slot is being written or was reused
+ */
+static int
+read_slot(const struct slog_recent_slot *slot, uint64_t n,
+	  struct slog_recent_event *out)
+{
+	struct slog_recent_slot copy;
+	uint64_t seq;
+
+	seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+	if (seq != 2 * n + 2)
+		return -1;
+	memcpy(&copy, (const void *)slot, sizeof(copy));
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq)
+		return -1;
+
+	out->seq = n;
+	out->published = copy.published;
+	out->id = copy.id;
+	out->time_logged = copy.time_logged;
+	out->time_event = copy.time_event;
+	out->repair = copy.repair;
+	out->type = copy.type;
+	out->severity = copy.severity;
+	out->serviceable = copy.serviceable;
+	out->closed = copy.closed;
+	memcpy(out->refcode, copy.refcode, sizeof(out->refcode));
+	out->refcode[sizeof(out->refcode) - 1] = '\0';
+	memcpy(out->description, copy.description, sizeof(out->description));
+	out->description[sizeof(out->description) - 1] = '\0';
+	return 0;
+}
+
+/**
+ * slog_recent_read
+ * @brief Copy the events in the ring, without opening the database
+ *
+ * Takes no lock, so it never waits for a writer; a record that is
+ * overwritten while it is being copied is left out, and shows as a gap
+ * in the seq of the copies.  Finding no ring is not an error: nothing
+ * has been logged since it was last reset.
+ *
+ * @param since oldest publication time to return, or 0 for all
+ * @param events returned copies, oldest first; free() them
+ * @param n_events returned number of events
+ * @param dropped returned number of events that writers could not
+ *		  publish since the ring was created
+ * @param error buffer for an error message
+ * @param error_len size of error
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_recent_read(int64_t since, struct slog_recent_event **events,
+		 size_t *n_events, uint64_t *dropped, char *error,
+		 size_t error_len)
+{
+	const struct slog_recent_header *hdr;
+	const struct slog_recent_slot *slots;
+	struct stat sbuf;
+	uint64_t head, n;
+	size_t count = 0;
+	void *map;
+	int fd;
+
+	*events = NULL;
+	*n_events = 0;
+	*dropped = 0;
+
+	fd = shm_open(SLOG_RECENT_NAME, O_RDONLY | O_CLOEXEC, 0);
+	if (fd < 0) {
+		if (errno == ENOENT)
+			return 0;
+		snprintf(error, error_len, "%s: %s", SLOG_RECENT_NAME,
+			 strerror(errno));
+		return -1;
+	}
+	if (fstat(fd, &sbuf) != 0) {
+		snprintf(error, error_len, "%s: %s", SLOG_RECENT_NAME,
+			 strerror(errno));
+		close(fd);
+		return -1;
+	}
+	/* the ring is published by root, or by this user on a test system */
+	if (!trusted(&sbuf, 0) && !trusted(&sbuf, geteuid())) {
+		snprintf(error, error_len, "%s: Not created by servicelog; "
+			 "remove /dev/shm%s", SLOG_RECENT_NAME,
+			 SLOG_RECENT_NAME);
+		close(fd);
+		return -1;
+	}
+	if (sbuf.st_size == 0) {
+		/* created, but not yet sized by its first writer */
+		close(fd);
+		return 0;
+	}
+	if ((size_t)sbuf.st_size != RING_SIZE) {
+		snprintf(error, error_len, "%s: Unsupported ring size",
+			 SLOG_RECENT_NAME);
+		close(fd);
+		return -1;
+	}
+
+	map = mmap(NULL, RING_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		snprintf(error, error_len, "%s: %s", SLOG_RECENT_NAME,
+			 strerror(errno));
+		return -1;
+	}
+
+	hdr = map;
+	slots = (const struct slog_recent_slot *)(hdr + 1);
+	if (memcmp(hdr->magic, SLOG_RECENT_MAGIC, sizeof(hdr->magic)) != 0) {
+		munmap(map, RING_SIZE);
+		return 0;
+	}
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	if (hdr->version != SLOG_RECENT_VERSION ||
+	    hdr->slots != SLOG_RECENT_SLOTS ||
+	    hdr->slot_size != sizeof(struct slog_recent_slot)) {
+		snprintf(error, error_len, "%s: Unsupported ring version %u",
+			 SLOG_RECENT_NAME, hdr->version);
+		munmap(map, RING_SIZE);
+		return -1;
+	}
+
+	*dropped = __atomic_load_n(&hdr->dropped, __ATOMIC_RELAXED);
+	head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+	n = head > SLOG_RECENT_SLOTS ? head - SLOG_RECENT_SLOTS : 0;
+	if (head > n) {
+		*events = malloc((head - n) * sizeof(**events));
+		if (*events == NULL) {
+			snprintf(error, error_len, "Out of memory");
+			munmap(map, RING_SIZE);
+			return -1;
+		}
+	}
+
+	for (; n < head; n++) {
+		if (read_slot(&slots[n % SLOG_RECENT_SLOTS], n,
+			      &(*events)[count]) != 0)
+			continue;
+		if ((*events)[count].published >= since)
+			count++;
+	}
+	munmap(map, RING_SIZE);
+
+	*n_events = count;
+	return 0;
+}
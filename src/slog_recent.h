@@ -0,0 +1,98 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_RECENT_H
+#define SLOG_RECENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <servicelog-1/servicelog.h>
+
+/*
+ * Ring of recent events in POSIX shared memory
+ *
+ * The commands that log events or close them publish a fixed-size
+ * header of each one here, after the database has accepted it:
+ *
+ *   struct slog_recent_header
+ *   struct slog_recent_slot[slots]
+ *
+ * Record n (counting from 0) goes in slot n % slots.  Writers are
+ * serialized by a robust, process-shared mutex in the header.  Readers
+ * map the ring read-only, so they cannot take it, and take no lock at
+ * all: each slot is a seqlock instead.  Its seq is 2n+1 while record n
+ * is being written and 2n+2 once it is complete, and a reader keeps
+ * its copy of record n only if seq was 2n+2 both before and after
+ * copying the slot.  A writer that cannot get the mutex within
+ * SLOG_RECENT_LOCK_WAIT_MS adds its events to the dropped count
+ * instead.  The writer whose O_EXCL create made the ring sets it up
+ * (and the mutex) before the magic is written.  Writers only use a
+ * ring that they own and that no one else can write; readers also
+ * accept one owned by root.
+ *
+ * Publishing is best effort: the database remains the record, and the
+ * ring is lost on reboot.  Events closed by a repair action are
+ * published again, with closed set, so the ring reads as a log of
+ * what happened to events rather than of when they occurred.
+ */
+#define SLOG_RECENT_NAME	"/servicelog-recent"
+#define SLOG_RECENT_MAGIC	"SLRECENT"
+#define SLOG_RECENT_VERSION	2
+#define SLOG_RECENT_SLOTS	4096
+
+/* How long a writer waits for another one before dropping its events */
+#define SLOG_RECENT_LOCK_WAIT_MS	100
+
+struct slog_recent_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t slots;
+	uint32_t slot_size;	/* sizeof(struct slog_recent_slot) */
+	uint32_t reserved;
+	uint64_t head;		/* records published so far */
+	uint64_t dropped;	/* records not published for the lock */
+	uint64_t pad[3];
+	pthread_mutex_t lock;	/* held by the writer */
+};
+
+struct slog_recent_slot {
+	uint64_t seq;
+	int64_t published;	/* seconds since Epoch */
+	uint64_t id;
+	int64_t time_logged;
+	int64_t time_event;
+	uint64_t repair;	/* repair action that closed it, or 0 */
+	uint8_t type;
+	uint8_t severity;
+	uint8_t serviceable;
+	uint8_t closed;
+	uint32_t reserved;
+	char refcode[16];
+	char description[56];	/* truncated */
+};
+
+/* A copy of one complete slot, as returned by slog_recent_read() */
+struct slog_recent_event {
+	uint64_t seq;		/* record number */
+	int64_t published;
+	uint64_t id;
+	int64_t time_logged;
+	int64_t time_event;
+	uint64_t repair;
+	uint8_t type;
+	uint8_t severity;
+	uint8_t serviceable;
+	uint8_t closed;
+	char refcode[16];
+	char description[56];
+};
+
+extern int slog_recent_publish(struct sl_event *events);
+extern int slog_recent_read(int64_t since, struct slog_recent_event **events,
+			    size_t *n_events, uint64_t *dropped, char *error,
+			    size_t error_len);
+
+#endif
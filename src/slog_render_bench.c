@@ -0,0 +1,237 @@
+/**
+ * @file slog_render_bench.c
+ * @brief Time rendering a record once per method against once per tool
+ *
+ * Delivers a synthetic event with a large raw data section, as RTAS
+ * events have, to a number of simulated tools in the two ways that
+ * slog_notify.c can: rendered with servicelog_event_print() into a
+ * sealed memfd once, then read by each tool through its own
+ * /proc/self/fd descriptor; or rendered again into a pipe for each
+ * tool.  Each tool reads its copy to the end in this process, so no
+ * tool is started and only the cost of the payload is measured.
+ *
+ * It is a benchmark rather than a check, so it is built with
+ * --with-test but not run by "make check".
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <servicelog-1/servicelog.h>
+
+#define DEFAULT_TOOLS	10
+#define DEFAULT_RUNS	500
+#define DEFAULT_RAW_KB	32
+
+static double
+elapsed_us(struct timespec *start)
+{
+	struct timespec end;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) * 1e6 +
+		(end.tv_nsec - start->tv_nsec) / 1e3;
+}
+
+/* Read a tool's copy to the end; return its length, or -1 */
+static long
+consume(int fd)
+{
+	char buf[65536];
+	long total = 0;
+	ssize_t n;
+
+	while ((n = read(fd, buf, sizeof(buf))) > 0)
+		total += n;
+	return n < 0 ? -1 : total;
+}
+
+/* Once per tool: render into a pipe, as the fallback path does */
+static long
+per_tool(struct sl_event *event, int verbosity, int tools, int pipe_size)
+{
+	long total = 0, n;
+	int fd[2], i;
+	FILE *fp;
+
+	for (i = 0; i < tools; i++) {
+		if (pipe2(fd, O_CLOEXEC) != 0)
+			return -1;
+		/* large enough for the whole record, so no reader thread */
+		if (fcntl(fd[1], F_SETPIPE_SZ, pipe_size) < pipe_size) {
+			close(fd[0]);
+			close(fd[1]);
+			return -1;
+		}
+		fp = fdopen(fd[1], "w");
+		if (fp == NULL || servicelog_event_print(fp, event,
+							 verbosity) < 0) {
+			if (fp)
+				fclose(fp);
+			else
+				close(fd[1]);
+			close(fd[0]);
+			return -1;
+		}
+		fclose(fp);
+		n = consume(fd[0]);
+		close(fd[0]);
+		if (n < 0)
+			return -1;
+		total += n;
+	}
+	return total;
+}
+
+/* Once per record: render into a sealed memfd shared by every tool */
+static long
+shared(struct sl_event *event, int verbosity, int tools)
+{
+	char path[64];
+	long total = 0, n;
+	int memfd, fd, i;
+	FILE *fp;
+
+	memfd = memfd_create("slog-render-bench", MFD_CLOEXEC |
+			     MFD_ALLOW_SEALING);
+	if (memfd < 0)
+		return -1;
+	fp = fdopen(dup(memfd), "w");
+	if (fp == NULL || servicelog_event_print(fp, event, verbosity) < 0 ||
+	    fclose(fp) != 0 ||
+	    fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW |
+		  F_SEAL_WRITE | F_SEAL_SEAL) != 0) {
+		close(memfd);
+		return -1;
+	}
+
+	snprintf(path, sizeof(path), "/proc/self/fd/%d", memfd);
+	for (i = 0; i < tools; i++) {
+		fd = open(path, O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+			break;
+		n = consume(fd);
+		close(fd);
+		if (n < 0)
+			break;
+		total += n;
+	}
+	close(memfd);
+	return i == tools ? total : -1;
+}
+
+static void
+print_usage(const char *cmd)
+{
+	printf("Usage: %s [-t tools] [-n runs] [-r KiB]\n", cmd);
+	printf("  -t: tools each record is delivered to (default %d)\n",
+	       DEFAULT_TOOLS);
+	printf("  -n: records delivered per method (default %d)\n",
+	       DEFAULT_RUNS);
+	printf("  -r: size of the raw data of the event (default %d)\n",
+	       DEFAULT_RAW_KB);
+}
+
+int
+main(int argc, char *argv[])
+{
+	static const char *method_names[] = { "pretty", "simple" };
+	static const int verbosities[] = { 1, -1 };
+	int c, m, i, tools = DEFAULT_TOOLS, runs = DEFAULT_RUNS;
+	int raw_kb = DEFAULT_RAW_KB;
+	struct sl_event event;
+	struct timespec start;
+	double once_us, each_us;
+	long bytes = 0;
+
+	while ((c = getopt(argc, argv, "t:n:r:h")) != -1) {
+		switch (c) {
+		case 't':
+			tools = atoi(optarg);
+			break;
+		case 'n':
+			runs = atoi(optarg);
+			break;
+		case 'r':
+			raw_kb = atoi(optarg);
+			break;
+		case 'h':
+			print_usage(argv[0]);
+			exit(0);
+		default:
+			print_usage(argv[0]);
+			exit(1);
+		}
+	}
+	if (tools <= 0 || runs <= 0 || raw_kb < 0) {
+		print_usage(argv[0]);
+		exit(1);
+	}
+
+	memset(&event, 0, sizeof(event));
+	event.id = 1;
+	event.time_logged = event.time_event = event.time_last_update =
+		time(NULL);
+	event.type = SL_TYPE_BASIC;
+	event.severity = SL_SEV_ERROR;
+	event.serviceable = 1;
+	event.platform = "pSeries";
+	event.machine_serial = "1234567";
+	event.machine_model = "9119-MME";
+	event.nodename = "bench";
+	event.refcode = "B1F00000";
+	event.description = "Synthetic event for slog_render_bench";
+	event.raw_data_len = raw_kb * 1024;
+	event.raw_data = malloc(event.raw_data_len ? event.raw_data_len : 1);
+	if (event.raw_data == NULL) {
+		fprintf(stderr, "%s: out of memory\n", argv[0]);
+		exit(1);
+	}
+	for (i = 0; i < (int)event.raw_data_len; i++)
+		event.raw_data[i] = (unsigned char)(i * 131);
+
+	printf("%d tools, %d KiB of raw data\n", tools, raw_kb);
+	printf("%-8s %10s %14s %14s\n", "method", "bytes", "once us",
+	       "per tool us");
+	for (m = 0; m < 2; m++) {
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (i = 0; i < runs; i++) {
+			bytes = shared(&event, verbosities[m], tools);
+			if (bytes < 0)
+				break;
+		}
+		once_us = elapsed_us(&start) / runs;
+		if (bytes < 0) {
+			fprintf(stderr, "%s: memfd delivery failed\n",
+				argv[0]);
+			exit(1);
+		}
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (i = 0; i < runs; i++)
+			if (per_tool(&event, verbosities[m], tools,
+				     2 * bytes / tools + 65536) < 0)
+				break;
+		each_us = elapsed_us(&start) / runs;
+		if (i < runs) {
+			fprintf(stderr, "%s: pipe delivery failed (is the "
+				"record larger than a pipe can hold?)\n",
+				argv[0]);
+			exit(1);
+		}
+
+		printf("%-8s %10ld %14.1f %14.1f\n", method_names[m],
+		       bytes / tools, once_us, each_us);
+	}
+
+	free(event.raw_data);
+	return 0;
+}
@@ -0,0 +1,241 @@
+/**
+ * @file slog_select.c
+ * @brief Evaluate compiled filters over columnar batches of events
+ *
+ * The kernels use the GCC vector extensions, so they are compiled to
+ * VSX on POWER and to SSE on x86 without intrinsics of either; other
+ * compilers, or SLOG_SELECT_SCALAR, get the scalar loops alone.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "slog_select.h"
+
+#if defined(__GNUC__) && !defined(SLOG_SELECT_SCALAR)
+#define SLOG_SELECT_VECTOR
+
+typedef uint8_t v16u8 __attribute__((vector_size(16)));
+typedef int8_t v16i8 __attribute__((vector_size(16)));
+typedef int64_t v2i64 __attribute__((vector_size(16)));
+#endif
+
+/* A mask holds 0xff for each position that matches, and 0 otherwise */
+
+#ifdef SLOG_SELECT_VECTOR
+#define U8_KERNEL(cmp)						\
+	for (; i + 16 <= n; i += 16) {				\
+		memcpy(&a, col + i, 16);			\
+		m = (v16i8)(a cmp b);				\
+		memcpy(mask + i, &m, 16);			\
+	}
+
+#define I64_KERNEL(cmp)						\
+	for (; i + 2 <= n; i += 2) {				\
+		memcpy(&a, col + i, 16);			\
+		m = a cmp b;					\
+		mask[i] = (uint8_t)m[0];			\
+		mask[i + 1] = (uint8_t)m[1];			\
+	}
+#endif
+
+static void
+compare_u8(const uint8_t *col, int op, int64_t value, uint8_t *mask,
+	   size_t n)
+{
+	size_t i = 0;
+
+	/* outside the domain, every row compares the same way */
+	if (value < 0 || value > UINT8_MAX) {
+		memset(mask, slog_filter_compare(op, 0, value) ? 0xff : 0, n);
+		return;
+	}
+
+#ifdef SLOG_SELECT_VECTOR
+	{
+		v16u8 a, b = (v16u8){0} + (uint8_t)value;
+		v16i8 m;
+
+		switch (op) {
+		case SLOG_FILTER_EQ:
+			U8_KERNEL(==)
+			break;
+		case SLOG_FILTER_NE:
+			U8_KERNEL(!=)
+			break;
+		case SLOG_FILTER_LT:
+			U8_KERNEL(<)
+			break;
+		case SLOG_FILTER_LE:
+			U8_KERNEL(<=)
+			break;
+		case SLOG_FILTER_GT:
+			U8_KERNEL(>)
+			break;
+		case SLOG_FILTER_GE:
+			U8_KERNEL(>=)
+			break;
+		}
+	}
+#endif
+
+	for (; i < n; i++)
+		mask[i] = slog_filter_compare(op, col[i], value) ? 0xff : 0;
+}
+
+static void
+compare_i64(const int64_t *col, int op, int64_t value, uint8_t *mask,
+	    size_t n)
+{
+	size_t i = 0;
+
+#ifdef SLOG_SELECT_VECTOR
+	{
+		v2i64 a, b = (v2i64){0} + value, m;
+
+		switch (op) {
+		case SLOG_FILTER_EQ:
+			I64_KERNEL(==)
+			break;
+		case SLOG_FILTER_NE:
+			I64_KERNEL(!=)
+			break;
+		case SLOG_FILTER_LT:
+			I64_KERNEL(<)
+			break;
+		case SLOG_FILTER_LE:
+			I64_KERNEL(<=)
+			break;
+		case SLOG_FILTER_GT:
+			I64_KERNEL(>)
+			break;
+		case SLOG_FILTER_GE:
+			I64_KERNEL(>=)
+			break;
+		}
+	}
+#endif
+
+	for (; i < n; i++)
+		mask[i] = slog_filter_compare(op, col[i], value) ? 0xff : 0;
+}
+
+static void
+mask_combine(uint8_t *mask, const uint8_t *other, int kind, size_t n)
+{
+	size_t i = 0;
+
+#ifdef SLOG_SELECT_VECTOR
+	v16u8 a, b;
+
+	for (; i + 16 <= n; i += 16) {
+		memcpy(&a, mask + i, 16);
+		memcpy(&b, other + i, 16);
+		a = (kind == SLOG_FILTER_AND) ? (a & b) : (a | b);
+		memcpy(mask + i, &a, 16);
+	}
+#endif
+
+	for (; i < n; i++)
+		mask[i] = (kind == SLOG_FILTER_AND) ? (mask[i] & other[i]) :
+			  (mask[i] | other[i]);
+}
+
+/* Check whether a mask has all of its positions set to value */
+static int
+mask_all(const uint8_t *mask, uint8_t value, size_t n)
+{
+	uint64_t word, want;
+	size_t i = 0;
+
+	memset(&want, value, sizeof(want));
+	for (; i + 8 <= n; i += 8) {
+		memcpy(&word, mask + i, 8);
+		if (word != want)
+			return 0;
+	}
+	for (; i < n; i++)
+		if (mask[i] != value)
+			return 0;
+	return 1;
+}
+
+static void
+eval_node(const struct slog_filter *filter, int n,
+	  const struct slog_batch *batch, uint8_t *mask)
+{
+	const struct slog_filter_node *node = &filter->node[n];
+	uint8_t other[SLOG_SELECT_BATCH];
+
+	switch (node->kind) {
+	case SLOG_FILTER_CMP:
+		switch (node->column) {
+		case SLOG_FILTER_TYPE:
+			compare_u8(batch->type, node->op, node->value, mask,
+				   batch->n);
+			break;
+		case SLOG_FILTER_SEVERITY:
+			compare_u8(batch->severity, node->op, node->value,
+				   mask, batch->n);
+			break;
+		case SLOG_FILTER_SERVICEABLE:
+			compare_u8(batch->serviceable, node->op, node->value,
+				   mask, batch->n);
+			break;
+		case SLOG_FILTER_CLOSED:
+			compare_u8(batch->closed, node->op, node->value, mask,
+				   batch->n);
+			break;
+		case SLOG_FILTER_TIME_LOGGED:
+			compare_i64(batch->time_logged, node->op, node->value,
+				    mask, batch->n);
+			break;
+		case SLOG_FILTER_TIME_EVENT:
+			compare_i64(batch->time_event, node->op, node->value,
+				    mask, batch->n);
+			break;
+		}
+		return;
+
+	case SLOG_FILTER_AND:
+	case SLOG_FILTER_OR:
+		eval_node(filter, node->left, batch, mask);
+		/* the right side cannot change the result */
+		if (mask_all(mask, node->kind == SLOG_FILTER_AND ? 0 : 0xff,
+			     batch->n))
+			return;
+		eval_node(filter, node->right, batch, other);
+		mask_combine(mask, other, node->kind, batch->n);
+		return;
+	}
+}
+
+/**
+ * slog_select
+ * @brief Find the events of a batch that match a filter
+ *
+ * @param filter compiled filter
+ * @param batch columns of at most SLOG_SELECT_BATCH events
+ * @param sel returned positions of the matching events, ascending
+ * @return number of positions in sel
+ */
+size_t
+slog_select(const struct slog_filter *filter, const struct slog_batch *batch,
+	    uint16_t *sel)
+{
+	uint8_t mask[SLOG_SELECT_BATCH];
+	size_t i, k = 0;
+
+	eval_node(filter, filter->root, batch, mask);
+
+	/* branch-free, since matches are rarely predictable */
+	for (i = 0; i < batch->n; i++) {
+		sel[k] = (uint16_t)i;
+		k += mask[i] & 1;
+	}
+	return k;
+}
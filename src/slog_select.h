@@ -0,0 +1,35 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_SELECT_H
+#define SLOG_SELECT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "slog_filter.h"
+
+/*
+ * Evaluation of a compiled filter over a batch of events stored column
+ * by column, e.g., a slice of a mapped snapshot.  Each comparison is
+ * a compare-and-mask kernel over a whole column; AND and OR combine the
+ * masks, and the result is a selection vector of the matching
+ * positions.
+ */
+#define SLOG_SELECT_BATCH	1024
+
+struct slog_batch {
+	size_t n;			/* at most SLOG_SELECT_BATCH */
+	const uint8_t *type;
+	const uint8_t *severity;
+	const uint8_t *serviceable;
+	const uint8_t *closed;
+	const int64_t *time_logged;
+	const int64_t *time_event;
+};
+
+extern size_t slog_select(const struct slog_filter *filter,
+			  const struct slog_batch *batch, uint16_t *sel);
+
+#endif
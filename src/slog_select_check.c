@@ -0,0 +1,349 @@
+/**
+ * @file slog_select_check.c
+ * @brief Check slog_select() against row-at-a-time filter evaluation
+ *
+ * Compiles a fixed set of filters and a series of random ones with
+ * slog_filter_parse(), evaluates each over random batches of events
+ * with slog_select(), and compares the selection with the rows for
+ * which a plain recursive evaluation through slog_filter_compare()
+ * holds.  The batches have random lengths up to SLOG_SELECT_BATCH, so
+ * the scalar tails of the vector kernels are covered, and some have a
+ * single value per column, so that AND and OR skip their right side.
+ *
+ * With -b, it instead times both evaluations over full batches and
+ * prints the cost per event of each filter.
+ *
+ * It only uses memory, so it is run by "make check" when built with
+ * --with-test, once as is and once built with SLOG_SELECT_SCALAR.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "slog_filter.h"
+#include "slog_select.h"
+
+#define N_BATCHES	100	/* random batches per filter */
+#define N_RANDOM	300	/* random filters */
+#define BENCH_BATCHES	2000	/* full batches per filter with -b */
+
+static const char *filters[] = {
+	"severity>=$WARNING",
+	"severity<>4",
+	"type=$OS",
+	"type<1 OR type>6",
+	"serviceable=1 AND closed=0",
+	"closed!=1",
+	"severity>=$WARNING AND serviceable=1 AND (closed=0 OR type=$OS)",
+	"(type=1 OR severity=2) AND (closed=1 OR serviceable=0)",
+	"severity=300",
+	"severity<300",
+	"type>-1",
+	"type=-1 OR closed=1",
+	"time_event within 30d AND closed=0",
+	"time_logged>=now-2d AND time_logged<now-1d",
+	"time_event<=now-3d OR time_logged>now-12h",
+	"time_event==now-1d",
+	"time_event>0",
+};
+
+#define N_FILTERS	(sizeof(filters) / sizeof(filters[0]))
+
+static const char *column_names[SLOG_FILTER_N_COLUMNS] = {
+	"type", "severity", "serviceable", "closed", "time_logged",
+	"time_event"
+};
+
+static const char *op_names[] = { "=", "<>", "<", "<=", ">", ">=" };
+
+struct columns {
+	uint8_t type[SLOG_SELECT_BATCH];
+	uint8_t severity[SLOG_SELECT_BATCH];
+	uint8_t serviceable[SLOG_SELECT_BATCH];
+	uint8_t closed[SLOG_SELECT_BATCH];
+	int64_t time_logged[SLOG_SELECT_BATCH];
+	int64_t time_event[SLOG_SELECT_BATCH];
+};
+
+static uint64_t state = 0x9e3779b97f4a7c15ULL;
+
+/* xorshift64*, so that a failure can be reproduced from the seed */
+static uint64_t
+next_random(void)
+{
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 0x2545f4914f6cdd1dULL;
+}
+
+static int64_t
+random_range(int64_t lo, int64_t hi)
+{
+	return lo + (int64_t)(next_random() % (uint64_t)(hi - lo + 1));
+}
+
+/* Events over the last 4 days, some of them at the same second */
+static void
+fill_batch(struct columns *c, struct slog_batch *batch, size_t n,
+	   time_t now, int uniform)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		if (uniform && i > 0) {
+			c->type[i] = c->type[0];
+			c->severity[i] = c->severity[0];
+			c->serviceable[i] = c->serviceable[0];
+			c->closed[i] = c->closed[0];
+			c->time_logged[i] = c->time_logged[0];
+			c->time_event[i] = c->time_event[0];
+			continue;
+		}
+		c->type[i] = random_range(0, 7);
+		c->severity[i] = random_range(0, 7);
+		c->serviceable[i] = random_range(0, 1);
+		c->closed[i] = random_range(0, 1);
+		c->time_event[i] = now - random_range(0, 4 * 86400);
+		if (random_range(0, 7) == 0)
+			c->time_event[i] = now - 86400;
+		c->time_logged[i] = c->time_event[i] + random_range(0, 3600);
+	}
+
+	batch->n = n;
+	batch->type = c->type;
+	batch->severity = c->severity;
+	batch->serviceable = c->serviceable;
+	batch->closed = c->closed;
+	batch->time_logged = c->time_logged;
+	batch->time_event = c->time_event;
+}
+
+/* Write a random filter of up to about 8 comparisons */
+static void
+random_filter(char *buf, size_t len, int depth)
+{
+	size_t used;
+	int column;
+
+	if (depth < 3 && random_range(0, 2) != 0) {
+		used = snprintf(buf, len, "(");
+		random_filter(buf + used, len - used, depth + 1);
+		used = strlen(buf);
+		used += snprintf(buf + used, len - used, ") %s (",
+				 random_range(0, 1) ? "AND" : "OR");
+		random_filter(buf + used, len - used, depth + 1);
+		used = strlen(buf);
+		snprintf(buf + used, len - used, ")");
+		return;
+	}
+
+	column = random_range(0, SLOG_FILTER_N_COLUMNS - 1);
+	if (column < SLOG_FILTER_N_SMALL)
+		snprintf(buf, len, "%s%s%lld", column_names[column],
+			 op_names[random_range(0, 5)],
+			 (long long)random_range(-1, 9));
+	else if (random_range(0, 3) == 0)
+		snprintf(buf, len, "%s within %lldh", column_names[column],
+			 (long long)random_range(1, 96));
+	else
+		snprintf(buf, len, "%s%snow-%lldh", column_names[column],
+			 op_names[random_range(0, 5)],
+			 (long long)random_range(0, 96));
+}
+
+static int
+eval_row(const struct slog_filter *filter, int n,
+	 const struct slog_batch *batch, size_t i)
+{
+	const struct slog_filter_node *node = &filter->node[n];
+	int64_t value = 0;
+
+	switch (node->kind) {
+	case SLOG_FILTER_AND:
+		return eval_row(filter, node->left, batch, i) &&
+		       eval_row(filter, node->right, batch, i);
+	case SLOG_FILTER_OR:
+		return eval_row(filter, node->left, batch, i) ||
+		       eval_row(filter, node->right, batch, i);
+	}
+
+	switch (node->column) {
+	case SLOG_FILTER_TYPE:
+		value = batch->type[i];
+		break;
+	case SLOG_FILTER_SEVERITY:
+		value = batch->severity[i];
+		break;
+	case SLOG_FILTER_SERVICEABLE:
+		value = batch->serviceable[i];
+		break;
+	case SLOG_FILTER_CLOSED:
+		value = batch->closed[i];
+		break;
+	case SLOG_FILTER_TIME_LOGGED:
+		value = batch->time_logged[i];
+		break;
+	case SLOG_FILTER_TIME_EVENT:
+		value = batch->time_event[i];
+		break;
+	}
+	return slog_filter_compare(node->op, value, node->value);
+}
+
+static size_t
+select_rows(const struct slog_filter *filter, const struct slog_batch *batch,
+	    uint16_t *sel)
+{
+	size_t i, k = 0;
+
+	for (i = 0; i < batch->n; i++)
+		if (eval_row(filter, filter->root, batch, i))
+			sel[k++] = (uint16_t)i;
+	return k;
+}
+
+/**
+ * check_filter
+ * @brief Compare both evaluations of a filter over random batches
+ *
+ * @return 0 if they agree, 1 otherwise
+ */
+static int
+check_filter(const char *text, time_t now)
+{
+	static struct columns c;
+	struct slog_filter filter;
+	struct slog_batch batch;
+	uint16_t sel[SLOG_SELECT_BATCH], want[SLOG_SELECT_BATCH];
+	size_t b, n, k, n_want;
+	char err[256];
+
+	if (slog_filter_parse(text, &filter, err, sizeof(err)) != 0) {
+		printf("FAIL: %s: %s\n", text, err);
+		return 1;
+	}
+
+	for (b = 0; b < N_BATCHES; b++) {
+		n = (b < 20) ? b : random_range(0, SLOG_SELECT_BATCH);
+		fill_batch(&c, &batch, n, now, b % 5 == 0);
+
+		k = slog_select(&filter, &batch, sel);
+		n_want = select_rows(&filter, &batch, want);
+		if (k != n_want || memcmp(sel, want, k * sizeof(*sel))) {
+			printf("FAIL: %s: batch of %zu events, %zu selected "
+			       "instead of %zu\n", text, n, k, n_want);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static double
+elapsed_ns(struct timespec *start)
+{
+	struct timespec end;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) * 1e9 +
+		(end.tv_nsec - start->tv_nsec);
+}
+
+static void
+bench_filter(const char *text, time_t now)
+{
+	static struct columns c;
+	struct slog_filter filter;
+	struct slog_batch batch;
+	struct timespec start;
+	uint16_t sel[SLOG_SELECT_BATCH];
+	double batch_ns, row_ns;
+	size_t b, total = 0;
+	char err[256];
+
+	if (slog_filter_parse(text, &filter, err, sizeof(err)) != 0) {
+		printf("%s: %s\n", text, err);
+		return;
+	}
+	fill_batch(&c, &batch, SLOG_SELECT_BATCH, now, 0);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (b = 0; b < BENCH_BATCHES; b++)
+		total += slog_select(&filter, &batch, sel);
+	batch_ns = elapsed_ns(&start);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (b = 0; b < BENCH_BATCHES; b++)
+		total += select_rows(&filter, &batch, sel);
+	row_ns = elapsed_ns(&start);
+
+	printf("%8.2f %8.2f  %5.1f%%  %s\n",
+	       batch_ns / BENCH_BATCHES / SLOG_SELECT_BATCH,
+	       row_ns / BENCH_BATCHES / SLOG_SELECT_BATCH,
+	       100.0 * total / (2.0 * BENCH_BATCHES * SLOG_SELECT_BATCH),
+	       text);
+}
+
+static void
+print_usage(const char *cmd)
+{
+	printf("Usage: %s [-b] [-s seed]\n", cmd);
+	printf("  -b: time slog_select() against row-at-a-time evaluation\n");
+	printf("  -s: seed of the random batches and filters\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+	char text[1024];
+	time_t now = time(NULL);
+	int c, bench = 0, failed = 0;
+	size_t i;
+
+	while ((c = getopt(argc, argv, "bs:h")) != -1) {
+		switch (c) {
+		case 'b':
+			bench = 1;
+			break;
+		case 's':
+			state = strtoull(optarg, NULL, 0);
+			if (state == 0) {
+				fprintf(stderr, "%s: the seed must not be "
+					"0\n", argv[0]);
+				exit(1);
+			}
+			break;
+		case 'h':
+			print_usage(argv[0]);
+			exit(0);
+		default:
+			print_usage(argv[0]);
+			exit(1);
+		}
+	}
+
+	if (bench) {
+		printf("%8s %8s  %6s  %s\n", "batch ns", "row ns", "match",
+		       "filter (per event)");
+		for (i = 0; i < N_FILTERS; i++)
+			bench_filter(filters[i], now);
+		return 0;
+	}
+
+	for (i = 0; i < N_FILTERS; i++)
+		failed += check_filter(filters[i], now);
+	for (i = 0; i < N_RANDOM; i++) {
+		random_filter(text, sizeof(text), 0);
+		failed += check_filter(text, now);
+	}
+
+	printf("%s: %zu filters, %d failed\n", failed ? "FAIL" : "ok",
+	       N_FILTERS + N_RANDOM, failed);
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,546 @@
+/**
+ * @file slog_snapshot.c
+ * @brief Write and map columnar servicelog snapshot files
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "slog_snapshot.h"
+
+#define ALIGN8(x)	(((x) + 7) & ~((uint64_t)7))
+
+static const uint32_t col_width[SNAP_COL_MAX] = {
+	[SNAP_COL_ID]		= sizeof(uint64_t),
+	[SNAP_COL_TIME_LOGGED]	= sizeof(int64_t),
+	[SNAP_COL_TIME_EVENT]	= sizeof(int64_t),
+	[SNAP_COL_TYPE]		= sizeof(uint8_t),
+	[SNAP_COL_SEVERITY]	= sizeof(uint8_t),
+	[SNAP_COL_SERVICEABLE]	= sizeof(uint8_t),
+	[SNAP_COL_CLOSED]	= sizeof(uint8_t),
+	[SNAP_COL_REPAIR]	= sizeof(uint64_t),
+	[SNAP_COL_REFCODE]	= sizeof(uint32_t),
+	[SNAP_COL_DESCRIPTION]	= sizeof(uint32_t),
+};
+
+static const char *
+event_string(struct sl_event *e, int col)
+{
+	return (col == SNAP_COL_REFCODE) ? e->refcode : e->description;
+}
+
+/* The value of one of the uint8_t columns, which also have bitmaps */
+static uint8_t
+small_value(struct sl_event *e, int col)
+{
+	switch (col) {
+	case SNAP_COL_TYPE:
+		return e->type;
+	case SNAP_COL_SEVERITY:
+		return e->severity;
+	case SNAP_COL_SERVICEABLE:
+		return e->serviceable ? 1 : 0;
+	default:
+		return e->closed ? 1 : 0;
+	}
+}
+
+/**
+ * write_column
+ * @brief Write the values of one column for every event
+ *
+ * @param fp snapshot file, positioned at the start of the column
+ * @param events list of events
+ * @param col column to write (SNAP_COL_*)
+ * @param heap_next next free string heap offset, advanced for each string
+ * @return 0 on success, -1 on a write error
+ */
+static int
+write_column(FILE *fp, struct sl_event *events, int col, uint64_t *heap_next)
+{
+	struct sl_event *e;
+	uint64_t u64;
+	int64_t i64;
+	uint32_t u32;
+	uint8_t u8;
+	const char *str;
+	const void *val;
+
+	for (e = events; e; e = e->next) {
+		switch (col) {
+		case SNAP_COL_ID:
+			u64 = e->id;
+			val = &u64;
+			break;
+		case SNAP_COL_TIME_LOGGED:
+			i64 = e->time_logged;
+			val = &i64;
+			break;
+		case SNAP_COL_TIME_EVENT:
+			i64 = e->time_event;
+			val = &i64;
+			break;
+		case SNAP_COL_TYPE:
+		case SNAP_COL_SEVERITY:
+		case SNAP_COL_SERVICEABLE:
+		case SNAP_COL_CLOSED:
+			u8 = small_value(e, col);
+			val = &u8;
+			break;
+		case SNAP_COL_REPAIR:
+			u64 = e->repair;
+			val = &u64;
+			break;
+		default:
+			str = event_string(e, col);
+			if (str == NULL) {
+				u32 = SNAP_NO_STRING;
+			} else {
+				u32 = *heap_next;
+				*heap_next += strlen(str) + 1;
+			}
+			val = &u32;
+			break;
+		}
+
+		if (fwrite(val, col_width[col], 1, fp) != 1)
+			return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * write_bitmap
+ * @brief Write the bitmap of the events holding a value of a column
+ *
+ * @param fp snapshot file, positioned at the start of the bitmap
+ * @param events list of events
+ * @param col column of the value (SNAP_COL_TYPE ... SNAP_COL_CLOSED)
+ * @param value value whose rows are set
+ * @return 0 on success, -1 on a write error
+ */
+static int
+write_bitmap(FILE *fp, struct sl_event *events, int col, int value)
+{
+	struct sl_event *e;
+	uint64_t word = 0;
+	int bit = 0;
+
+	for (e = events; e; e = e->next) {
+		if (small_value(e, col) == value)
+			word |= (uint64_t)1 << bit;
+		if (++bit < 64)
+			continue;
+		if (fwrite(&word, sizeof(word), 1, fp) != 1)
+			return -1;
+		word = 0;
+		bit = 0;
+	}
+	if (bit && fwrite(&word, sizeof(word), 1, fp) != 1)
+		return -1;
+
+	return 0;
+}
+
+/**
+ * sort_by_id
+ * @brief Merge sort a list of events by id
+ *
+ * @param head list to sort
+ * @return the new head of the list
+ */
+static struct sl_event *
+sort_by_id(struct sl_event *head)
+{
+	struct sl_event *slow, *fast, *b, *merged, **tail;
+
+	if (head == NULL || head->next == NULL)
+		return head;
+
+	slow = head;
+	fast = head->next;
+	while (fast && fast->next) {
+		slow = slow->next;
+		fast = fast->next->next;
+	}
+	b = slow->next;
+	slow->next = NULL;
+
+	head = sort_by_id(head);
+	b = sort_by_id(b);
+
+	tail = &merged;
+	while (head && b) {
+		if (head->id <= b->id) {
+			*tail = head;
+			head = head->next;
+		} else {
+			*tail = b;
+			b = b->next;
+		}
+		tail = &(*tail)->next;
+	}
+	*tail = head ? head : b;
+
+	return merged;
+}
+
+static int
+write_padding(FILE *fp, uint64_t from, uint64_t to)
+{
+	static const char zero[8];
+
+	if (to > from && fwrite(zero, to - from, 1, fp) != 1)
+		return -1;
+
+	return 0;
+}
+
+/**
+ * slog_snapshot_write
+ * @brief Write a list of events to a snapshot file
+ *
+ * The snapshot is written to a temporary file which is renamed over
+ * path once complete, so readers never see a partial snapshot.
+ *
+ * @param path snapshot file to create
+ * @param list list of events to write; sorted by id on return
+ * @param error buffer for an error message
+ * @param error_len size of the error buffer
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_snapshot_write(const char *path, struct sl_event **list, char *error,
+		    size_t error_len)
+{
+	struct slog_snapshot_header hdr;
+	struct slog_snapshot_column dir[SNAP_COL_MAX +
+					SNAP_BITMAP_COLS * SNAP_BITMAP_VALUES];
+	uint8_t present[SNAP_BITMAP_COLS][SNAP_BITMAP_VALUES];
+	struct sl_event *events, *e;
+	char tmp_path[PATH_MAX];
+	uint64_t pos, nwords, heap_size = 0, heap_next = 0;
+	const char *str;
+	FILE *fp;
+	int col, value, fd;
+	uint32_t i;
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, SNAP_MAGIC, sizeof(hdr.magic));
+	hdr.version = SNAP_VERSION;
+	hdr.byte_order = SNAP_BYTE_ORDER;
+	memset(present, 0, sizeof(present));
+
+	*list = events = sort_by_id(*list);
+	for (e = events; e; e = e->next) {
+		hdr.nrows++;
+		if (e->refcode)
+			heap_size += strlen(e->refcode) + 1;
+		if (e->description)
+			heap_size += strlen(e->description) + 1;
+		for (col = SNAP_COL_TYPE; col <= SNAP_COL_CLOSED; col++)
+			present[SNAP_BITMAP_INDEX(col)][small_value(e, col)] = 1;
+	}
+	if (heap_size >= SNAP_NO_STRING) {
+		snprintf(error, error_len, "Too much text for a snapshot");
+		return -1;
+	}
+
+	/* the columns, then a bitmap for each value that occurs */
+	for (col = 0; col < SNAP_COL_MAX; col++) {
+		dir[col].id = col;
+		dir[col].width = col_width[col];
+	}
+	hdr.ncols = SNAP_COL_MAX;
+	for (col = SNAP_COL_TYPE; col <= SNAP_COL_CLOSED; col++) {
+		for (value = 0; value < SNAP_BITMAP_VALUES; value++) {
+			if (!present[SNAP_BITMAP_INDEX(col)][value])
+				continue;
+			dir[hdr.ncols].id = SNAP_BITMAP(col, value);
+			dir[hdr.ncols].width = sizeof(uint64_t);
+			hdr.ncols++;
+		}
+	}
+
+	/* lay out the columns and bitmaps */
+	nwords = (hdr.nrows + 63) / 64;
+	pos = ALIGN8(sizeof(hdr) + hdr.ncols * sizeof(dir[0]));
+	for (i = 0; i < hdr.ncols; i++) {
+		dir[i].offset = pos;
+		if (i < SNAP_COL_MAX)
+			pos = ALIGN8(pos + hdr.nrows * col_width[i]);
+		else
+			pos += nwords * sizeof(uint64_t);
+	}
+	hdr.heap_offset = pos;
+	hdr.heap_size = heap_size;
+
+	if (snprintf(tmp_path, PATH_MAX, "%s.XXXXXX", path) >= PATH_MAX) {
+		snprintf(error, error_len, "%s: %s", path,
+			 strerror(ENAMETOOLONG));
+		return -1;
+	}
+	fd = mkstemp(tmp_path);
+	if (fd < 0) {
+		snprintf(error, error_len, "%s: %s", path, strerror(errno));
+		return -1;
+	}
+	fp = fdopen(fd, "w");
+	if (fp == NULL) {
+		snprintf(error, error_len, "%s: %s", path, strerror(errno));
+		close(fd);
+		goto err_unlink;
+	}
+
+	if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1 ||
+	    fwrite(dir, sizeof(dir[0]), hdr.ncols, fp) != hdr.ncols ||
+	    write_padding(fp, sizeof(hdr) + hdr.ncols * sizeof(dir[0]),
+			  dir[0].offset))
+		goto err_write;
+
+	for (col = 0; col < SNAP_COL_MAX; col++) {
+		pos = dir[col].offset + hdr.nrows * col_width[col];
+		if (write_column(fp, events, col, &heap_next) ||
+		    write_padding(fp, pos, ALIGN8(pos)))
+			goto err_write;
+	}
+	for (i = SNAP_COL_MAX; i < hdr.ncols; i++)
+		if (write_bitmap(fp, events, (dir[i].id >> 8) & 0xff,
+				 dir[i].id & 0xff))
+			goto err_write;
+
+	/* strings are appended in the order their offsets were handed out */
+	for (col = SNAP_COL_REFCODE; col <= SNAP_COL_DESCRIPTION; col++) {
+		for (e = events; e; e = e->next) {
+			str = event_string(e, col);
+			if (str && fwrite(str, strlen(str) + 1, 1, fp) != 1)
+				goto err_write;
+		}
+	}
+
+	if (fflush(fp) != 0 || fsync(fileno(fp)) != 0)
+		goto err_write;
+	if (fclose(fp) != 0) {
+		snprintf(error, error_len, "%s: %s", path, strerror(errno));
+		goto err_unlink;
+	}
+	if (chmod(tmp_path, 0644) != 0 || rename(tmp_path, path) != 0) {
+		snprintf(error, error_len, "%s: %s", path, strerror(errno));
+		goto err_unlink;
+	}
+
+	return 0;
+
+err_write:
+	snprintf(error, error_len, "%s: %s", path, strerror(errno));
+	fclose(fp);
+err_unlink:
+	unlink(tmp_path);
+	return -1;
+}
+
+/**
+ * map_bitmap
+ * @brief Set up the pointer to a value bitmap listed in the directory
+ *
+ * @param snap snapshot being opened, with map, map_len and nwords set
+ * @param col directory entry of the bitmap
+ * @return 0 on success or if the column is unknown, -1 if it is corrupt
+ */
+static int
+map_bitmap(struct slog_snapshot *snap, const struct slog_snapshot_column *col)
+{
+	uint32_t id = col->id & ~SNAP_BITMAP_FLAG;
+	int column = id >> 8;
+
+	if (column < SNAP_COL_TYPE || column > SNAP_COL_CLOSED)
+		return 0;
+	if (col->width != sizeof(uint64_t) || (col->offset & 7) ||
+	    col->offset > snap->map_len ||
+	    snap->nwords > (snap->map_len - col->offset) / sizeof(uint64_t))
+		return -1;
+
+	snap->bitmap[SNAP_BITMAP_INDEX(column)][id & 0xff] =
+		(const uint64_t *)((const char *)snap->map + col->offset);
+	return 0;
+}
+
+/**
+ * slog_snapshot_open
+ * @brief Map a snapshot file and set up pointers to its columns
+ *
+ * @param path snapshot file to open
+ * @param snap returned snapshot; snap->error is set on failure
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_snapshot_open(const char *path, struct slog_snapshot *snap)
+{
+	const struct slog_snapshot_header *hdr;
+	const struct slog_snapshot_column *dir;
+	const void *cols[SNAP_COL_MAX];
+	struct stat sbuf;
+	uint64_t end;
+	uint32_t i;
+	int fd, col, value, n_bitmaps;
+
+	memset(snap, 0, sizeof(*snap));
+	memset(cols, 0, sizeof(cols));
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		snprintf(snap->error, SL_MAX_ERR, "%s: %s", path,
+			 strerror(errno));
+		return -1;
+	}
+	if (fstat(fd, &sbuf) != 0) {
+		snprintf(snap->error, SL_MAX_ERR, "%s: %s", path,
+			 strerror(errno));
+		close(fd);
+		return -1;
+	}
+	if ((size_t)sbuf.st_size < sizeof(*hdr)) {
+		snprintf(snap->error, SL_MAX_ERR, "%s: Not a servicelog "
+			 "snapshot", path);
+		close(fd);
+		return -1;
+	}
+
+	snap->map_len = sbuf.st_size;
+	snap->map = mmap(NULL, snap->map_len, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (snap->map == MAP_FAILED) {
+		snap->map = NULL;
+		snprintf(snap->error, SL_MAX_ERR, "%s: %s", path,
+			 strerror(errno));
+		return -1;
+	}
+
+	hdr = snap->map;
+	if (memcmp(hdr->magic, SNAP_MAGIC, sizeof(hdr->magic)) != 0) {
+		snprintf(snap->error, SL_MAX_ERR, "%s: Not a servicelog "
+			 "snapshot", path);
+		goto err_out;
+	}
+	if (hdr->byte_order != SNAP_BYTE_ORDER) {
+		snprintf(snap->error, SL_MAX_ERR, "%s: Snapshot was written "
+			 "with a different byte order", path);
+		goto err_out;
+	}
+	if (hdr->version != SNAP_VERSION) {
+		snprintf(snap->error, SL_MAX_ERR, "%s: Unsupported snapshot "
+			 "version %u", path, hdr->version);
+		goto err_out;
+	}
+	if (hdr->ncols > (snap->map_len - sizeof(*hdr)) / sizeof(*dir) ||
+	    hdr->heap_offset > snap->map_len ||
+	    hdr->heap_size > snap->map_len - hdr->heap_offset)
+		goto err_corrupt;
+
+	/* columns unknown to this reader are skipped */
+	snap->nrows = hdr->nrows;
+	snap->nwords = (hdr->nrows + 63) / 64;
+	dir = (const struct slog_snapshot_column *)(hdr + 1);
+	for (i = 0; i < hdr->ncols; i++) {
+		if (dir[i].id & SNAP_BITMAP_FLAG) {
+			if (map_bitmap(snap, &dir[i]) != 0)
+				goto err_corrupt;
+			continue;
+		}
+		if (dir[i].id >= SNAP_COL_MAX)
+			continue;
+		if (dir[i].width != col_width[dir[i].id] ||
+		    (dir[i].offset & 7) ||
+		    dir[i].offset > snap->map_len ||
+		    hdr->nrows > (snap->map_len - dir[i].offset) /
+								dir[i].width)
+			goto err_corrupt;
+		cols[dir[i].id] = (const char *)snap->map + dir[i].offset;
+	}
+	for (i = 0; i < SNAP_COL_MAX; i++)
+		if (cols[i] == NULL)
+			goto err_corrupt;
+
+	/*
+	 * Every row holds some value of each column, so the bitmaps are
+	 * usable only if each column has at least one; snapshots written
+	 * before the bitmaps have none.
+	 */
+	n_bitmaps = 0;
+	for (col = 0; col < SNAP_BITMAP_COLS; col++) {
+		for (value = 0; value < SNAP_BITMAP_VALUES; value++)
+			if (snap->bitmap[col][value])
+				break;
+		if (value < SNAP_BITMAP_VALUES)
+			n_bitmaps++;
+	}
+	if (n_bitmaps != 0 && n_bitmaps != SNAP_BITMAP_COLS)
+		goto err_corrupt;
+	snap->has_bitmaps = (n_bitmaps != 0 || hdr->nrows == 0);
+
+	/* the last string must be terminated within the heap */
+	end = hdr->heap_offset + hdr->heap_size;
+	if (hdr->heap_size && ((const char *)snap->map)[end - 1] != '\0')
+		goto err_corrupt;
+
+	snap->id = cols[SNAP_COL_ID];
+	snap->time_logged = cols[SNAP_COL_TIME_LOGGED];
+	snap->time_event = cols[SNAP_COL_TIME_EVENT];
+	snap->type = cols[SNAP_COL_TYPE];
+	snap->severity = cols[SNAP_COL_SEVERITY];
+	snap->serviceable = cols[SNAP_COL_SERVICEABLE];
+	snap->closed = cols[SNAP_COL_CLOSED];
+	snap->repair = cols[SNAP_COL_REPAIR];
+	snap->refcode = cols[SNAP_COL_REFCODE];
+	snap->description = cols[SNAP_COL_DESCRIPTION];
+	snap->heap = (const char *)snap->map + hdr->heap_offset;
+	snap->heap_size = hdr->heap_size;
+
+	/* columns are scanned front to back */
+	madvise(snap->map, snap->map_len, MADV_SEQUENTIAL);
+
+	return 0;
+
+err_corrupt:
+	snprintf(snap->error, SL_MAX_ERR, "%s: Snapshot is corrupt", path);
+err_out:
+	munmap(snap->map, snap->map_len);
+	snap->map = NULL;
+	return -1;
+}
+
+void
+slog_snapshot_close(struct slog_snapshot *snap)
+{
+	if (snap->map)
+		munmap(snap->map, snap->map_len);
+	snap->map = NULL;
+}
+
+/**
+ * slog_snapshot_string
+ * @brief Look up a value of a string column
+ *
+ * @param snap mapped snapshot
+ * @param offset value from the refcode or description column
+ * @return the string, or NULL if there is none or the offset is invalid
+ */
+const char *
+slog_snapshot_string(struct slog_snapshot *snap, uint32_t offset)
+{
+	if (offset == SNAP_NO_STRING || offset >= snap->heap_size)
+		return NULL;
+
+	return snap->heap + offset;
+}
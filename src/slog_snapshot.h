@@ -0,0 +1,111 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_SNAPSHOT_H
+#define SLOG_SNAPSHOT_H
+
+#include <stdint.h>
+#include <servicelog-1/servicelog.h>
+
+/*
+ * Servicelog snapshot file layout
+ *
+ * A snapshot is a columnar copy of the events table, meant to be
+ * mapped into memory and scanned in place:
+ *
+ *   struct slog_snapshot_header
+ *   struct slog_snapshot_column[ncols]   column directory
+ *   column data                          nrows fixed-width values each,
+ *                                        every column 8-byte aligned
+ *   value bitmaps                        (nrows + 63) / 64 words each
+ *   string heap                          NUL-terminated strings
+ *
+ * Rows are in ascending id order.  String columns hold 32-bit offsets
+ * into the string heap, or SNAP_NO_STRING.  All values are in the byte
+ * order of the system that wrote the snapshot; readers refuse a
+ * snapshot in foreign byte order.
+ *
+ * Each value that occurs in the type, severity, serviceable or closed
+ * column also has a bitmap of the rows that hold it, listed in the
+ * column directory as SNAP_BITMAP(column, value) with a width of 8.
+ * Bit (row % 64) of word (row / 64) is set for each of those rows, and
+ * the bits past the last row are clear.  Readers that predate the
+ * bitmaps skip them as unknown columns.
+ */
+#define SNAP_MAGIC		"SLSNAP\0\0"
+#define SNAP_VERSION		1
+#define SNAP_BYTE_ORDER		0x01020304
+#define SNAP_NO_STRING		0xffffffff
+
+enum {
+	SNAP_COL_ID = 0,	/* uint64_t */
+	SNAP_COL_TIME_LOGGED,	/* int64_t, seconds since Epoch */
+	SNAP_COL_TIME_EVENT,	/* int64_t, seconds since Epoch */
+	SNAP_COL_TYPE,		/* uint8_t */
+	SNAP_COL_SEVERITY,	/* uint8_t */
+	SNAP_COL_SERVICEABLE,	/* uint8_t */
+	SNAP_COL_CLOSED,	/* uint8_t */
+	SNAP_COL_REPAIR,	/* uint64_t */
+	SNAP_COL_REFCODE,	/* uint32_t string heap offset */
+	SNAP_COL_DESCRIPTION,	/* uint32_t string heap offset */
+	/* Add new columns here */
+	SNAP_COL_MAX,
+};
+
+#define SNAP_BITMAP_FLAG	0x10000
+#define SNAP_BITMAP(col, value)	(SNAP_BITMAP_FLAG | ((col) << 8) | (value))
+#define SNAP_BITMAP_COLS	4	/* SNAP_COL_TYPE ... SNAP_COL_CLOSED */
+#define SNAP_BITMAP_VALUES	256	/* the columns are uint8_t */
+#define SNAP_BITMAP_INDEX(col)	((col) - SNAP_COL_TYPE)
+
+struct slog_snapshot_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint64_t nrows;
+	uint32_t ncols;
+	uint32_t reserved;
+	uint64_t heap_offset;
+	uint64_t heap_size;
+};
+
+struct slog_snapshot_column {
+	uint32_t id;		/* SNAP_COL_* */
+	uint32_t width;		/* bytes per value */
+	uint64_t offset;	/* from the start of the file */
+};
+
+/* A snapshot mapped by slog_snapshot_open() */
+struct slog_snapshot {
+	void *map;
+	size_t map_len;
+	uint64_t nrows;
+	const uint64_t *id;
+	const int64_t *time_logged;
+	const int64_t *time_event;
+	const uint8_t *type;
+	const uint8_t *severity;
+	const uint8_t *serviceable;
+	const uint8_t *closed;
+	const uint64_t *repair;
+	const uint32_t *refcode;
+	const uint32_t *description;
+	const char *heap;
+	uint64_t heap_size;
+	/* bitmap[SNAP_BITMAP_INDEX(col)][value], NULL if no row holds it */
+	int has_bitmaps;
+	uint64_t nwords;
+	const uint64_t *bitmap[SNAP_BITMAP_COLS][SNAP_BITMAP_VALUES];
+	char error[SL_MAX_ERR];
+};
+
+extern int slog_snapshot_write(const char *path, struct sl_event **list,
+			       char *error, size_t error_len);
+extern int slog_snapshot_open(const char *path, struct slog_snapshot *snap);
+extern void slog_snapshot_close(struct slog_snapshot *snap);
+extern const char *slog_snapshot_string(struct slog_snapshot *snap,
+					uint32_t offset);
+
+#endif
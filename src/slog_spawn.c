@@ -0,0 +1,114 @@
+/**
+ * @file slog_spawn.c
+ * @brief Start commands without copying the caller's address space
+ *
+ * fork() duplicates the page tables of the whole process before the
+ * child can exec, so the cost of running a command grows with the
+ * caller's size -- a writer holding a large sqlite page cache pays for
+ * every page of it.  posix_spawn() creates the child sharing the
+ * parent's memory until the exec (glibc uses clone(CLONE_VM |
+ * CLONE_VFORK)), so starting a command costs the same whatever the
+ * size of the caller.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "slog_spawn.h"
+
+extern char **environ;
+
+/**
+ * slog_spawn
+ * @brief Start a command
+ *
+ * The child starts with every signal unblocked and at its default
+ * action, as if it had been started from a shell, even if the caller
+ * ignores SIGPIPE or blocks signals.  File descriptors opened with
+ * O_CLOEXEC (e.g., the database) are not inherited.
+ *
+ * @param argv program (a full path) and arguments, NULL terminated
+ * @param stdin_fd descriptor to become the child's stdin, or -1 to
+ *		   share the caller's
+ * @param pid returned process id of the child
+ * @param error buffer for an error message
+ * @param error_len size of error
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_spawn(char *const argv[], int stdin_fd, pid_t *pid, char *error,
+	   size_t error_len)
+{
+	posix_spawn_file_actions_t actions;
+	posix_spawnattr_t attr;
+	sigset_t none, all;
+	int rc;
+
+	sigemptyset(&none);
+	sigfillset(&all);
+
+	posix_spawn_file_actions_init(&actions);
+	posix_spawnattr_init(&attr);
+	posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK |
+				 POSIX_SPAWN_SETSIGDEF);
+	posix_spawnattr_setsigmask(&attr, &none);
+	posix_spawnattr_setsigdefault(&attr, &all);
+
+	if (stdin_fd >= 0 && stdin_fd != STDIN_FILENO)
+		posix_spawn_file_actions_adddup2(&actions, stdin_fd,
+						 STDIN_FILENO);
+
+	rc = posix_spawn(pid, argv[0], &actions, &attr, argv, environ);
+
+	posix_spawnattr_destroy(&attr);
+	posix_spawn_file_actions_destroy(&actions);
+
+	if (rc != 0) {
+		snprintf(error, error_len, "Could not run %s: %s", argv[0],
+			 strerror(rc));
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * slog_spawn_shell
+ * @brief Start a command line with /bin/sh, as popen() and system() do
+ */
+int
+slog_spawn_shell(const char *command, int stdin_fd, pid_t *pid,
+		 char *error, size_t error_len)
+{
+	char *argv[] = { "/bin/sh", "-c", (char *)command, NULL };
+
+	return slog_spawn(argv, stdin_fd, pid, error, error_len);
+}
+
+/**
+ * slog_spawn_wait
+ * @brief Wait for a command started by slog_spawn() to finish
+ *
+ * @param pid process id returned by slog_spawn()
+ * @param status returned wait status
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_spawn_wait(pid_t pid, int *status)
+{
+	while (waitpid(pid, status, 0) < 0) {
+		if (errno != EINTR)
+			return -1;
+	}
+
+	return 0;
+}
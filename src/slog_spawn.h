@@ -0,0 +1,18 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_SPAWN_H
+#define SLOG_SPAWN_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+extern int slog_spawn(char *const argv[], int stdin_fd, pid_t *pid,
+		      char *error, size_t error_len);
+extern int slog_spawn_shell(const char *command, int stdin_fd, pid_t *pid,
+			    char *error, size_t error_len);
+extern int slog_spawn_wait(pid_t pid, int *status);
+
+#endif
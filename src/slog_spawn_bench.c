@@ -0,0 +1,147 @@
+/**
+ * @file slog_spawn_bench.c
+ * @brief Time slog_spawn() against fork() and exec() by caller size
+ *
+ * Runs /bin/true a number of times with slog_spawn() and with fork(),
+ * execv() and waitpid(), from a process that has touched a ballast of
+ * each of the given sizes, and prints the average time to start and
+ * reap the command.  The fork() times grow with the ballast, since its
+ * page tables are copied before the exec; the slog_spawn() times do
+ * not.
+ *
+ * It is a benchmark rather than a check, so it is built with
+ * --with-test but not run by "make check".
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/wait.h>
+
+#include "slog_spawn.h"
+
+#define DEFAULT_RUNS	200
+
+static char *const true_argv[] = { "/bin/true", NULL };
+
+static double
+elapsed_us(struct timespec *start)
+{
+	struct timespec end;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) * 1e6 +
+		(end.tv_nsec - start->tv_nsec) / 1e3;
+}
+
+static int
+run_fork(void)
+{
+	pid_t pid;
+	int status;
+
+	pid = fork();
+	if (pid < 0)
+		return -1;
+	if (pid == 0) {
+		execv(true_argv[0], true_argv);
+		_exit(127);
+	}
+	return slog_spawn_wait(pid, &status);
+}
+
+static int
+run_spawn(void)
+{
+	char error[256];
+	pid_t pid;
+	int status;
+
+	if (slog_spawn(true_argv, -1, &pid, error, sizeof(error)) != 0) {
+		fprintf(stderr, "%s\n", error);
+		return -1;
+	}
+	return slog_spawn_wait(pid, &status);
+}
+
+/* Average microseconds per run, or -1 on failure */
+static double
+time_runs(int (*run)(void), int runs)
+{
+	struct timespec start;
+	int i;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < runs; i++)
+		if (run() != 0)
+			return -1;
+	return elapsed_us(&start) / runs;
+}
+
+static void
+print_usage(const char *cmd)
+{
+	printf("Usage: %s [-n runs] [MiB ...]\n", cmd);
+	printf("  -n: commands run per method and size (default %d)\n",
+	       DEFAULT_RUNS);
+	printf("  MiB: ballast sizes to run from (default 0 64 256 1024)\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+	static const char *sizes[] = { "0", "64", "256", "1024" };
+	const char *const *mib = sizes;
+	int c, i, n_sizes = 4, runs = DEFAULT_RUNS;
+	char *ballast = NULL, *tmp;
+	size_t len;
+
+	while ((c = getopt(argc, argv, "n:h")) != -1) {
+		switch (c) {
+		case 'n':
+			runs = atoi(optarg);
+			if (runs <= 0) {
+				fprintf(stderr, "%s: -n must be positive\n",
+					argv[0]);
+				exit(1);
+			}
+			break;
+		case 'h':
+			print_usage(argv[0]);
+			exit(0);
+		default:
+			print_usage(argv[0]);
+			exit(1);
+		}
+	}
+	if (optind < argc) {
+		mib = (const char *const *)&argv[optind];
+		n_sizes = argc - optind;
+	}
+
+	printf("%10s %12s %12s\n", "ballast", "fork us", "spawn us");
+	for (i = 0; i < n_sizes; i++) {
+		len = strtoul(mib[i], NULL, 10) << 20;
+		tmp = realloc(ballast, len ? len : 1);
+		if (tmp == NULL) {
+			fprintf(stderr, "%s: cannot allocate %s MiB\n",
+				argv[0], mib[i]);
+			free(ballast);
+			exit(1);
+		}
+		ballast = tmp;
+		/* touch every page, so that fork() has them to copy */
+		memset(ballast, 1, len);
+
+		printf("%7s MiB %12.1f %12.1f\n", mib[i],
+		       time_runs(run_fork, runs), time_runs(run_spawn, runs));
+	}
+
+	free(ballast);
+	return 0;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file slog_stats.c
+ * @brief Per-type summary of servicelog events
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "slog_stats.h"
+
+static const char *type_name[SLOG_STATS_NTYPES] = {
+	"Basic",
+	"OS",
+	"RTAS",
+	"Enclosure",
+	"BMC",
+};
+
+static const char *sev_name[SL_SEV_FATAL + 1] = {
+	"", "DEBUG", "INFO", "EVENT", "WARNING", "ERROR_LOCAL", "ERROR", "FATAL"
+};
+
+/**
+ * slog_stats_add
+ * @brief Account for one event in the summary
+ *
+ * @param stats summary to update
+ * @param type event type (SL_TYPE_*)
+ * @param serviceable non-zero if the event is serviceable
+ * @param closed non-zero if the event has been closed
+ * @return 0 on success, -1 if the type is unknown
+ */
+int
+slog_stats_add(struct slog_stats *stats, uint32_t type, int serviceable,
+	       int closed)
+{
+	struct slog_type_stats *t;
+
+	stats->n_events++;
+	if (serviceable && !closed)
+		stats->n_open++;
+
+	if (type >= SLOG_STATS_NTYPES)
+		return -1;
+
+	t = &stats->type[type];
+	t->total++;
+	if (serviceable) {
+		if (closed)
+			t->closed++;
+		else
+			t->open++;
+	}
+	else
+		t->info++;
+
+	return 0;
+}
+
+int
+slog_stats_add_event(struct slog_stats *stats, struct sl_event *e)
+{
+	if (slog_stats_add(stats, e->type, e->serviceable, e->closed) < 0) {
+		fprintf(stderr, "Event ""%" PRIu64 "has unknown type %d\n",
+			e->id, e->type);
+		return -1;
+	}
+
+	return 0;
+}
+
+void
+slog_stats_merge(struct slog_stats *to, struct slog_stats *from)
+{
+	int i;
+
+	to->n_events += from->n_events;
+	to->n_open += from->n_open;
+	for (i = 0; i < SLOG_STATS_NTYPES; i++) {
+		to->type[i].total += from->type[i].total;
+		to->type[i].open += from->type[i].open;
+		to->type[i].closed += from->type[i].closed;
+		to->type[i].info += from->type[i].info;
+	}
+}
+
+/**
+ * slog_stats_print
+ * @brief Print the open event count and the per-type summary table
+ *
+ * @param fp stream to print to
+ * @param stats summary to print
+ */
+void
+slog_stats_print(FILE *fp, struct slog_stats *stats)
+{
+	struct slog_type_stats sum;
+	int i;
+
+	if (stats->n_open == 0)
+		fprintf(fp, "There are no open events that require action."
+			"\n\n");
+	else if (stats->n_open == 1)
+		fprintf(fp, "There is 1 open event requiring action.\n\n");
+	else
+		fprintf(fp, "There are %d open events requiring action.\n\n",
+			stats->n_open);
+
+	fprintf(fp, "Summary of Logged Events:\n\n");
+
+	fprintf(fp, "  %10s %7s %7s %7s %7s\n\n", "Type", "Total", "Open",
+		"Closed", "Info");
+
+	memset(&sum, 0, sizeof(sum));
+	for (i = 0; i < SLOG_STATS_NTYPES; i++) {
+		struct slog_type_stats *t = &stats->type[i];
+
+		if (t->total)
+			fprintf(fp, "  %10s %7d %7d %7d %7d\n", type_name[i],
+				t->total, t->open, t->closed, t->info);
+
+		sum.total += t->total;
+		sum.open += t->open;
+		sum.closed += t->closed;
+		sum.info += t->info;
+	}
+
+	fprintf(fp, "  %10s -------------------------------\n", "");
+	fprintf(fp, "  %10s %7d %7d %7d %7d\n\n", "",
+		sum.total, sum.open, sum.closed, sum.info);
+}
+
+const char *
+slog_type_name(uint32_t type)
+{
+	if (type < SLOG_STATS_NTYPES)
+		return type_name[type];
+
+	return "Unknown";
+}
+
+const char *
+slog_sev_name(uint32_t severity)
+{
+	if (severity >= SL_SEV_DEBUG && severity <= SL_SEV_FATAL)
+		return sev_name[severity];
+
+	return "UNKNOWN";
+}
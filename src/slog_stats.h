@@ -0,0 +1,36 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_STATS_H
+#define SLOG_STATS_H
+
+#include <servicelog-1/servicelog.h>
+
+/* Event types are SL_TYPE_BASIC (0) through SL_TYPE_BMC (4) */
+#define SLOG_STATS_NTYPES	(SL_TYPE_BMC + 1)
+
+struct slog_type_stats {
+	int total;
+	int open;	/* serviceable, not yet closed */
+	int closed;	/* serviceable, closed */
+	int info;	/* not serviceable */
+};
+
+struct slog_stats {
+	int n_events;
+	int n_open;
+	struct slog_type_stats type[SLOG_STATS_NTYPES];
+};
+
+extern int slog_stats_add(struct slog_stats *stats, uint32_t type,
+			  int serviceable, int closed);
+extern int slog_stats_add_event(struct slog_stats *stats,
+				struct sl_event *e);
+extern void slog_stats_merge(struct slog_stats *to, struct slog_stats *from);
+extern void slog_stats_print(FILE *fp, struct slog_stats *stats);
+extern const char *slog_type_name(uint32_t type);
+extern const char *slog_sev_name(uint32_t severity);
+
+#endif
@@ -0,0 +1,632 @@
+/**
+ * @file slog_subscriber.c
+ * @brief Push events and repair actions to subscribers over Unix sockets
+ *
+ * A notification tool costs a process per record; a subscriber that is
+ * already running only costs a connection and a write.  Subscribers are
+ * kept next to the events, in
+ *
+ *   subscribers(id, time_logged, notify, path, match, acked)
+ *
+ * where acked is the id of the last record the subscriber acknowledged
+ * (or the newest record when it registered).  A delivery connects to
+ * the subscriber, sends every matching record past acked in id order,
+ * and moves acked up to what the subscriber acknowledges, so a
+ * subscriber that was down or did not answer gets the records again
+ * with the next delivery.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <endian.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "slog_subscriber.h"
+
+/* A record rendered for the socket */
+struct frame {
+	uint64_t id;
+	char *buf;		/* length prefix, then the payload */
+	size_t len;
+};
+
+struct subscriber {
+	uint64_t id;
+	char *path;
+	char *match;
+	uint64_t acked;
+};
+
+static int
+have_table(sqlite3 *db)
+{
+	sqlite3_stmt *stmt;
+	int rc;
+
+	if (sqlite3_prepare_v2(db, "SELECT 1 FROM sqlite_master WHERE "
+			       "type='table' AND name='subscribers'", -1,
+			       &stmt, NULL) != SQLITE_OK)
+		return 0;
+	rc = sqlite3_step(stmt);
+	sqlite3_finalize(stmt);
+
+	return rc == SQLITE_ROW;
+}
+
+static int64_t
+newest_id(sqlite3 *db, int notify)
+{
+	sqlite3_stmt *stmt;
+	int64_t id = 0;
+
+	if (sqlite3_prepare_v2(db, notify == SL_NOTIFY_EVENTS ?
+			       "SELECT max(id) FROM events" :
+			       "SELECT max(id) FROM repair_actions", -1,
+			       &stmt, NULL) != SQLITE_OK)
+		return 0;
+	if (sqlite3_step(stmt) == SQLITE_ROW)
+		id = sqlite3_column_int64(stmt, 0);
+	sqlite3_finalize(stmt);
+
+	return id;
+}
+
+/**
+ * slog_subscriber_add
+ * @brief Register a subscriber for the records logged from now on
+ *
+ * @param slog open servicelog; must be writable
+ * @param path absolute path of the subscriber's listening socket
+ * @param notify SL_NOTIFY_EVENTS or SL_NOTIFY_REPAIRS
+ * @param match query string selecting the records, or ""
+ * @param id returned id of the subscriber
+ * @param error buffer for an error message
+ * @param error_len size of error
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_subscriber_add(servicelog *slog, const char *path, int notify,
+		    const char *match, uint64_t *id, char *error,
+		    size_t error_len)
+{
+	struct sockaddr_un addr;
+	sqlite3_stmt *stmt;
+	int rc;
+
+	if (path[0] != '/' || strlen(path) >= sizeof(addr.sun_path)) {
+		snprintf(error, error_len, "'%s' is not a valid socket path",
+			 path);
+		return -1;
+	}
+
+	if (sqlite3_exec(slog->db, "CREATE TABLE IF NOT EXISTS subscribers "
+			 "(id INTEGER PRIMARY KEY, time_logged INTEGER, "
+			 "notify INTEGER, path TEXT, match TEXT, "
+			 "acked INTEGER, UNIQUE (notify, path))", NULL, NULL,
+			 NULL) != SQLITE_OK ||
+	    sqlite3_prepare_v2(slog->db, "INSERT INTO subscribers "
+			       "(time_logged, notify, path, match, acked) "
+			       "VALUES (?, ?, ?, ?, ?)", -1, &stmt,
+			       NULL) != SQLITE_OK) {
+		snprintf(error, error_len, "%s", sqlite3_errmsg(slog->db));
+		return -1;
+	}
+
+	sqlite3_bind_int64(stmt, 1, time(NULL));
+	sqlite3_bind_int(stmt, 2, notify);
+	sqlite3_bind_text(stmt, 3, path, -1, SQLITE_STATIC);
+	sqlite3_bind_text(stmt, 4, match, -1, SQLITE_STATIC);
+	sqlite3_bind_int64(stmt, 5, newest_id(slog->db, notify));
+	rc = sqlite3_step(stmt);
+	sqlite3_finalize(stmt);
+
+	if (rc == SQLITE_CONSTRAINT) {
+		snprintf(error, error_len, "A subscriber at '%s' is already "
+			 "registered", path);
+		return -1;
+	}
+	if (rc != SQLITE_DONE) {
+		snprintf(error, error_len, "%s", sqlite3_errmsg(slog->db));
+		return -1;
+	}
+
+	*id = sqlite3_last_insert_rowid(slog->db);
+	return 0;
+}
+
+/**
+ * slog_subscriber_remove
+ * @brief Remove the subscribers listening at a path
+ *
+ * @return the number removed, or -1 on failure
+ */
+int
+slog_subscriber_remove(servicelog *slog, const char *path)
+{
+	sqlite3_stmt *stmt;
+	int rc;
+
+	if (!have_table(slog->db))
+		return 0;
+
+	if (sqlite3_prepare_v2(slog->db, "DELETE FROM subscribers WHERE "
+			       "path = ?", -1, &stmt, NULL) != SQLITE_OK)
+		return -1;
+	sqlite3_bind_text(stmt, 1, path, -1, SQLITE_STATIC);
+	rc = sqlite3_step(stmt);
+	sqlite3_finalize(stmt);
+
+	return rc == SQLITE_DONE ? sqlite3_changes(slog->db) : -1;
+}
+
+/**
+ * slog_subscriber_print
+ * @brief Print the registered subscribers
+ *
+ * @return the number printed, or -1 on failure
+ */
+int
+slog_subscriber_print(FILE *fp, servicelog *slog)
+{
+	sqlite3_stmt *stmt;
+	time_t logged;
+	int n = 0, rc;
+
+	if (!have_table(slog->db))
+		return 0;
+
+	if (sqlite3_prepare_v2(slog->db, "SELECT id, time_logged, notify, "
+			       "path, match, acked FROM subscribers ORDER BY "
+			       "id", -1, &stmt, NULL) != SQLITE_OK)
+		return -1;
+
+	while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+		logged = sqlite3_column_int64(stmt, 1);
+		fprintf(fp, "Subscriber ID:           %" PRId64 "\n",
+			(int64_t)sqlite3_column_int64(stmt, 0));
+		fprintf(fp, "Logged:                  %s", ctime(&logged));
+		fprintf(fp, "Notify:                  %s\n",
+			sqlite3_column_int(stmt, 2) == SL_NOTIFY_EVENTS ?
+			"New Events" : "New Repair Actions");
+		fprintf(fp, "Socket:                  %s\n",
+			sqlite3_column_text(stmt, 3));
+		fprintf(fp, "Match:                   %s\n",
+			sqlite3_column_text(stmt, 4));
+		fprintf(fp, "Acknowledged:            %" PRId64 "\n\n",
+			(int64_t)sqlite3_column_int64(stmt, 5));
+		n++;
+	}
+	sqlite3_finalize(stmt);
+
+	return rc == SQLITE_DONE ? n : -1;
+}
+
+static int
+compare_frames(const void *a, const void *b)
+{
+	uint64_t x = ((const struct frame *)a)->id;
+	uint64_t y = ((const struct frame *)b)->id;
+
+	return (x > y) - (x < y);
+}
+
+static void
+free_frames(struct frame *frames, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		free(frames[i].buf);
+	free(frames);
+}
+
+/**
+ * render_frame
+ * @brief Format one record, behind its length prefix
+ */
+static int
+render_frame(struct frame *f, int notify, uint64_t id, void *record)
+{
+	uint32_t len;
+	FILE *fp;
+	int rc;
+
+	f->id = id;
+	fp = open_memstream(&f->buf, &f->len);
+	if (fp == NULL)
+		return -1;
+
+	fwrite("\0\0\0\0", 1, sizeof(len), fp);
+	if (notify == SL_NOTIFY_EVENTS) {
+		fprintf(fp, "EVENT %" PRIu64 "\n", id);
+		rc = servicelog_event_print(fp, record, -1);
+	}
+	else {
+		fprintf(fp, "REPAIR %" PRIu64 "\n", id);
+		rc = servicelog_repair_print(fp, record, -1);
+	}
+	if ((fclose(fp) != 0) | (rc < 0))
+		return -1;
+
+	len = htonl(f->len - sizeof(len));
+	memcpy(f->buf, &len, sizeof(len));
+	return 0;
+}
+
+/**
+ * render_frames
+ * @brief Format the matching records in (first, last], in id order
+ */
+static int
+render_frames(servicelog *slog, int notify, uint64_t first, uint64_t last,
+	      const char *match, struct frame **frames, size_t *n)
+{
+	struct sl_event *events = NULL, *e;
+	struct sl_repair_action *repairs = NULL, *r;
+	struct frame *f;
+	char *query;
+	size_t max = 0;
+	int rc = -1;
+
+	*frames = NULL;
+	*n = 0;
+
+	if (asprintf(&query, "id>%" PRIu64 " AND id<=%" PRIu64 "%s%s%s", first,
+		     last, match[0] ? " AND (" : "", match,
+		     match[0] ? ")" : "") < 0)
+		return -1;
+
+	if (notify == SL_NOTIFY_EVENTS) {
+		if (servicelog_event_query(slog, query, &events) != 0)
+			goto out;
+		for (e = events; e; e = e->next)
+			max++;
+	}
+	else {
+		if (servicelog_repair_query(slog, query, &repairs) != 0)
+			goto out;
+		for (r = repairs; r; r = r->next)
+			max++;
+	}
+
+	*frames = calloc(max ? max : 1, sizeof(**frames));
+	if (*frames == NULL)
+		goto out;
+
+	/* the print functions print a whole list, so unlink each record */
+	for (e = events; e; e = events) {
+		events = e->next;
+		e->next = NULL;
+		f = &(*frames)[(*n)++];
+		rc = render_frame(f, notify, e->id, e);
+		servicelog_event_free(e);
+		if (rc != 0)
+			goto out;
+	}
+	for (r = repairs; r; r = repairs) {
+		repairs = r->next;
+		r->next = NULL;
+		f = &(*frames)[(*n)++];
+		rc = render_frame(f, notify, r->id, r);
+		servicelog_repair_free(r);
+		if (rc != 0)
+			goto out;
+	}
+
+	qsort(*frames, *n, sizeof(**frames), compare_frames);
+	rc = 0;
+
+out:
+	if (rc != 0) {
+		free_frames(*frames, *n);
+		*frames = NULL;
+		*n = 0;
+	}
+	free(query);
+	if (events)
+		servicelog_event_free(events);
+	if (repairs)
+		servicelog_repair_free(repairs);
+	return rc;
+}
+
+static int
+connect_to(const char *path)
+{
+	struct sockaddr_un addr;
+	struct timeval tv = { SLOG_SUBSCRIBER_TIMEOUT, 0 };
+	int fd;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+	fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return -1;
+	if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) != 0 ||
+	    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv)) != 0 ||
+	    connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+static int
+send_all(int fd, const char *buf, size_t len)
+{
+	ssize_t n;
+
+	while (len > 0) {
+		n = send(fd, buf, len, MSG_NOSIGNAL);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		buf += n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+/**
+ * read_acks
+ * @brief Read acknowledgements until the last id or a timeout
+ *
+ * @return the highest id acknowledged, 0 if none
+ */
+static uint64_t
+read_acks(int fd, uint64_t last)
+{
+	uint64_t ack, acked = 0;
+	size_t have = 0;
+	ssize_t n;
+
+	while (acked < last) {
+		n = read(fd, (char *)&ack + have, sizeof(ack) - have);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			break;
+		have += n;
+		if (have < sizeof(ack))
+			continue;
+		have = 0;
+		ack = be64toh(ack);
+		if (ack > acked)
+			acked = ack;
+	}
+
+	return acked;
+}
+
+static void
+set_acked(servicelog *slog, uint64_t subscriber, uint64_t acked)
+{
+	sqlite3_stmt *stmt;
+
+	/* a read-only database just means the records are sent again */
+	if (sqlite3_prepare_v2(slog->db, "UPDATE subscribers SET acked = ? "
+			       "WHERE id = ? AND acked < ?", -1, &stmt,
+			       NULL) != SQLITE_OK)
+		return;
+	sqlite3_bind_int64(stmt, 1, acked);
+	sqlite3_bind_int64(stmt, 2, subscriber);
+	sqlite3_bind_int64(stmt, 3, acked);
+	sqlite3_step(stmt);
+	sqlite3_finalize(stmt);
+}
+
+static void
+deliver(servicelog *slog, int notify, struct subscriber *sub, uint64_t id,
+	int64_t committed, struct slog_notify_stats *stats,
+	struct slog_notify_result *result)
+{
+	struct frame *frames;
+	uint64_t first = sub->acked, acked;
+	int64_t start, finished;
+	size_t n, i;
+	int fd;
+
+	if (id - first > SLOG_SUBSCRIBER_REPLAY) {
+		first = id - SLOG_SUBSCRIBER_REPLAY;
+		snprintf(result->error, sizeof(result->error), "Subscriber "
+			 "%" PRIu64 ": records up to %" PRIu64 " were never "
+			 "acknowledged and are skipped", sub->id, first);
+		result->failed++;
+	}
+
+	if (render_frames(slog, notify, first, id, sub->match, &frames,
+			  &n) != 0) {
+		snprintf(result->error, sizeof(result->error), "Subscriber "
+			 "%" PRIu64 ": %s", sub->id, servicelog_error(slog));
+		result->failed++;
+		return;
+	}
+	if (n == 0) {
+		/* nothing matched; there is nothing to send again either */
+		set_acked(slog, sub->id, id);
+		free_frames(frames, n);
+		return;
+	}
+
+	result->matched++;
+	slog_notify_stats_add(stats, SLOG_STAT_SUBSCRIBER, sub->id,
+			      SLOG_STAT_QUEUE,
+			      slog_notify_stats_usec() - committed);
+	start = slog_notify_stats_usec();
+	fd = connect_to(sub->path);
+	if (fd < 0) {
+		snprintf(result->error, sizeof(result->error), "Subscriber "
+			 "%" PRIu64 ": %s: %s", sub->id, sub->path,
+			 strerror(errno));
+		result->failed++;
+		slog_notify_stats_add(stats, SLOG_STAT_SUBSCRIBER, sub->id,
+				      SLOG_STAT_EXIT, 1);
+		free_frames(frames, n);
+		return;
+	}
+
+	for (i = 0; i < n; i++)
+		if (send_all(fd, frames[i].buf, frames[i].len) != 0)
+			break;
+
+	acked = i ? read_acks(fd, frames[i - 1].id) : 0;
+	close(fd);
+	finished = slog_notify_stats_usec();
+	slog_notify_stats_add(stats, SLOG_STAT_SUBSCRIBER, sub->id,
+			      SLOG_STAT_RUN, finished - start);
+	slog_notify_stats_add(stats, SLOG_STAT_SUBSCRIBER, sub->id,
+			      SLOG_STAT_LATENCY, finished - committed);
+
+	if (i == n && acked >= frames[n - 1].id) {
+		set_acked(slog, sub->id, id);
+		slog_notify_stats_add(stats, SLOG_STAT_SUBSCRIBER, sub->id,
+				      SLOG_STAT_EXIT, 0);
+	}
+	else {
+		slog_notify_stats_add(stats, SLOG_STAT_SUBSCRIBER, sub->id,
+				      SLOG_STAT_EXIT, 1);
+		if (acked > sub->acked)
+			set_acked(slog, sub->id, acked);
+		snprintf(result->error, sizeof(result->error), "Subscriber "
+			 "%" PRIu64 ": %s did not acknowledge record %" PRIu64,
+			 sub->id, sub->path, frames[n - 1].id);
+		result->failed++;
+	}
+
+	free_frames(frames, n);
+}
+
+/**
+ * slog_subscriber_deliver
+ * @brief Push a record, and any unacknowledged ones, to the subscribers
+ *
+ * @param slog open servicelog
+ * @param notify SL_NOTIFY_EVENTS or SL_NOTIFY_REPAIRS
+ * @param id id of the record just logged
+ * @param committed slog_notify_stats_usec() when it was committed
+ * @param stats delivery histograms, added to
+ * @param result counts and last failure, added to
+ */
+void
+slog_subscriber_deliver(servicelog *slog, int notify, uint64_t id,
+			int64_t committed, struct slog_notify_stats *stats,
+			struct slog_notify_result *result)
+{
+	struct subscriber *subs = NULL, *tmp;
+	const char *path, *match;
+	sqlite3_stmt *stmt;
+	size_t n = 0, max = 0, i;
+	int rc;
+
+	if (!have_table(slog->db))
+		return;
+
+	if (sqlite3_prepare_v2(slog->db, "SELECT id, path, match, acked "
+			       "FROM subscribers WHERE notify = ? AND "
+			       "acked < ?", -1, &stmt, NULL) != SQLITE_OK) {
+		snprintf(result->error, sizeof(result->error), "%s",
+			 sqlite3_errmsg(slog->db));
+		result->failed++;
+		return;
+	}
+	sqlite3_bind_int(stmt, 1, notify);
+	sqlite3_bind_int64(stmt, 2, id);
+
+	/* read them all first; delivering updates the table */
+	while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+		path = (const char *)sqlite3_column_text(stmt, 1);
+		match = (const char *)sqlite3_column_text(stmt, 2);
+		if (path == NULL) {
+			snprintf(result->error, sizeof(result->error),
+				 "Subscriber %" PRId64 ": No socket path",
+				 (int64_t)sqlite3_column_int64(stmt, 0));
+			result->failed++;
+			continue;
+		}
+
+		if (n == max) {
+			max = max ? max * 2 : 8;
+			tmp = realloc(subs, max * sizeof(*tmp));
+			if (tmp == NULL)
+				break;
+			subs = tmp;
+		}
+		subs[n].id = sqlite3_column_int64(stmt, 0);
+		subs[n].path = strdup(path);
+		subs[n].match = strdup(match ? match : "");
+		subs[n].acked = sqlite3_column_int64(stmt, 3);
+		if (subs[n].path == NULL || subs[n].match == NULL) {
+			free(subs[n].path);
+			free(subs[n].match);
+			break;
+		}
+		n++;
+	}
+	if (rc == SQLITE_ROW) {
+		snprintf(result->error, sizeof(result->error), "Out of "
+			 "memory; not every subscriber was delivered to");
+		result->failed++;
+	}
+	else if (rc != SQLITE_DONE) {
+		snprintf(result->error, sizeof(result->error), "%s",
+			 sqlite3_errmsg(slog->db));
+		result->failed++;
+	}
+	sqlite3_finalize(stmt);
+
+	for (i = 0; i < n; i++) {
+		deliver(slog, notify, &subs[i], id, committed, stats, result);
+		free(subs[i].path);
+		free(subs[i].match);
+	}
+	free(subs);
+}
+
+/**
+ * slog_subscriber_logged
+ * @brief Push a record that a writer has just committed to the subscribers
+ *
+ * libservicelog runs the notification tools of a record itself, from
+ * servicelog_event_log() or servicelog_repair_log(), but does not know
+ * of the subscribers; the commands that log records call this once the
+ * record is committed.  The delivery histograms are written out too.
+ *
+ * @param slog open servicelog
+ * @param notify SL_NOTIFY_EVENTS or SL_NOTIFY_REPAIRS
+ * @param id id of the record
+ * @param committed slog_notify_stats_usec() when it was committed
+ * @param result returned counts, and the last failure
+ * @return 0 if every matching subscriber acknowledged it, -1 otherwise
+ */
+int
+slog_subscriber_logged(servicelog *slog, int notify, uint64_t id,
+		       int64_t committed, struct slog_notify_result *result)
+{
+	struct slog_notify_stats stats;
+
+	memset(result, 0, sizeof(*result));
+	memset(&stats, 0, sizeof(stats));
+
+	slog_subscriber_deliver(slog, notify, id, committed, &stats, result);
+	slog_notify_stats_flush(&stats, slog->db);
+
+	return result->failed ? -1 : 0;
+}
@@ -0,0 +1,46 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_SUBSCRIBER_H
+#define SLOG_SUBSCRIBER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <servicelog-1/servicelog.h>
+#include "slog_notify.h"
+#include "slog_notify_stats.h"
+
+/*
+ * A subscriber is a daemon listening on a Unix stream socket, registered
+ * with servicelog_notify --method=socket:<path>.  Each record is pushed
+ * to it as a frame: a 4-byte length in network byte order, followed by
+ * "EVENT <id>\n" or "REPAIR <id>\n" and the record as name=value pairs.
+ * The subscriber acknowledges by writing back the id of the last record
+ * it has processed, as 8 bytes in network byte order.  Ids increase, so
+ * they serve as sequence numbers: each delivery first replays whatever
+ * the subscriber has not acknowledged.
+ */
+#define SLOG_METHOD_SOCKET		"socket:"
+
+/* Most records pushed by one delivery; older unacknowledged ones are lost */
+#define SLOG_SUBSCRIBER_REPLAY		1000
+
+/* Seconds to wait for an acknowledgement */
+#define SLOG_SUBSCRIBER_TIMEOUT		5
+
+extern int slog_subscriber_add(servicelog *slog, const char *path,
+			       int notify, const char *match, uint64_t *id,
+			       char *error, size_t error_len);
+extern int slog_subscriber_remove(servicelog *slog, const char *path);
+extern int slog_subscriber_print(FILE *fp, servicelog *slog);
+extern void slog_subscriber_deliver(servicelog *slog, int notify,
+				    uint64_t id, int64_t committed,
+				    struct slog_notify_stats *stats,
+				    struct slog_notify_result *result);
+extern int slog_subscriber_logged(servicelog *slog, int notify, uint64_t id,
+				  int64_t committed,
+				  struct slog_notify_result *result);
+
+#endif
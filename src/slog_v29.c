@@ -0,0 +1,151 @@
+/**
+ * @file slog_v29.c
+ * @brief Run the event filters of a v0.2.9 query as one SQL statement
+ *
+ * The compatibility servicelog_query() emulates the v0.2.9 filters on
+ * top of the v1 library.  Here the same filters become a single
+ * parameterized statement on the events table -- an IN-list for the
+ * types and epoch bounds on time_event -- so the query gets the same
+ * index-backed plan as a native v1 query.  libservicelog stores
+ * time_event as local time text, so the bounds are converted likewise.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <servicelog-1/servicelog.h>
+
+#include "slog_v29.h"
+
+#if SLOG_V29_TYPE_OS != SL_TYPE_OS || SLOG_V29_TYPE_RTAS != SL_TYPE_RTAS || \
+    SLOG_V29_TYPE_ENCLOSURE != SL_TYPE_ENCLOSURE
+#error "SLOG_V29_TYPE_* do not match the libservicelog event types"
+#endif
+
+/**
+ * build_sql
+ * @brief Build the statement for a filter; values are bound later
+ */
+static void
+build_sql(const struct slog_v29_filter *filter, char *sql, size_t len)
+{
+	size_t n;
+	uint32_t i;
+
+	n = snprintf(sql, len, "SELECT id FROM events WHERE 1");
+
+	if (filter->num_types) {
+		n += snprintf(sql + n, len - n, " AND type IN (?");
+		for (i = 1; i < filter->num_types; i++)
+			n += snprintf(sql + n, len - n, ", ?");
+		n += snprintf(sql + n, len - n, ")");
+	}
+	if (filter->start_time)
+		n += snprintf(sql + n, len - n,
+			      " AND time_event >= "
+			      "datetime(?, 'unixepoch', 'localtime')");
+	if (filter->end_time)
+		n += snprintf(sql + n, len - n,
+			      " AND time_event <= "
+			      "datetime(?, 'unixepoch', 'localtime')");
+	if (filter->serviceable)
+		n += snprintf(sql + n, len - n, " AND serviceable = ?");
+	if (filter->repaired)
+		n += snprintf(sql + n, len - n, " AND closed = ?");
+
+	snprintf(sql + n, len - n, " ORDER BY id");
+}
+
+static void
+bind_values(const struct slog_v29_filter *filter, sqlite3_stmt *stmt)
+{
+	uint32_t i;
+	int col = 1;
+
+	for (i = 0; i < filter->num_types; i++)
+		sqlite3_bind_int(stmt, col++, filter->types[i]);
+	if (filter->start_time)
+		sqlite3_bind_int64(stmt, col++, filter->start_time);
+	if (filter->end_time)
+		sqlite3_bind_int64(stmt, col++, filter->end_time);
+	if (filter->serviceable)
+		sqlite3_bind_int(stmt, col++, filter->serviceable > 0);
+	if (filter->repaired)
+		sqlite3_bind_int(stmt, col++, filter->repaired > 0);
+}
+
+/**
+ * slog_v29_event_ids
+ * @brief Find the ids of the events matching a v0.2.9 filter
+ *
+ * @param filter event filters
+ * @param ids returned array of ids, in ascending order; free() it
+ * @param n_ids returned number of ids
+ * @param error buffer for an error message
+ * @param error_len size of error
+ * @return 0 on success, -1 on failure
+ */
+int
+slog_v29_event_ids(const struct slog_v29_filter *filter, uint64_t **ids,
+		   size_t *n_ids, char *error, size_t error_len)
+{
+	servicelog *slog;
+	sqlite3_stmt *stmt;
+	uint64_t *tmp;
+	size_t max = 0;
+	char sql[512];
+	int rc;
+
+	*ids = NULL;
+	*n_ids = 0;
+
+	if (filter->num_types > sizeof(filter->types) / sizeof(uint32_t)) {
+		snprintf(error, error_len, "Too many event types");
+		return -1;
+	}
+
+	rc = servicelog_open(&slog, 0);
+	if (rc) {
+		snprintf(error, error_len, "Error opening servicelog: %s",
+			 strerror(rc));
+		return -1;
+	}
+
+	build_sql(filter, sql, sizeof(sql));
+	rc = sqlite3_prepare_v2(slog->db, sql, -1, &stmt, NULL);
+	if (rc != SQLITE_OK)
+		goto err_out;
+	bind_values(filter, stmt);
+
+	while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+		if (*n_ids == max) {
+			max = max ? max * 2 : 256;
+			tmp = realloc(*ids, max * sizeof(*tmp));
+			if (tmp == NULL) {
+				sqlite3_finalize(stmt);
+				snprintf(error, error_len, "Out of memory");
+				goto err_free;
+			}
+			*ids = tmp;
+		}
+		(*ids)[(*n_ids)++] = sqlite3_column_int64(stmt, 0);
+	}
+	sqlite3_finalize(stmt);
+	if (rc != SQLITE_DONE)
+		goto err_out;
+
+	servicelog_close(slog);
+	return 0;
+
+err_out:
+	snprintf(error, error_len, "%s", sqlite3_errmsg(slog->db));
+err_free:
+	servicelog_close(slog);
+	free(*ids);
+	*ids = NULL;
+	*n_ids = 0;
+	return -1;
+}
@@ -0,0 +1,42 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef SLOG_V29_H
+#define SLOG_V29_H
+
+/*
+ * Native queries for v29_servicelog.  This header is included next to
+ * <servicelog-1/libservicelog.h>, so it must not depend on the v1
+ * <servicelog-1/servicelog.h>; the event types below are the v1 values,
+ * checked against it in slog_v29.c.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#define SLOG_V29_TYPE_OS	1
+#define SLOG_V29_TYPE_RTAS	2
+#define SLOG_V29_TYPE_ENCLOSURE	3
+
+/* The event filters of a struct sl_query; 0 leaves a field unset */
+struct slog_v29_filter {
+	uint32_t num_types;
+	uint32_t types[8];	/* SLOG_V29_TYPE_* */
+	time_t start_time;
+	time_t end_time;
+	int serviceable;	/* 1 for yes, -1 for no, 0 for all */
+	int repaired;		/* 1 for yes, -1 for no, 0 for all */
+};
+
+struct sl_query;
+
+extern int slog_v29_query_filter(const struct sl_query *query,
+				 struct slog_v29_filter *filter);
+extern int slog_v29_event_ids(const struct slog_v29_filter *filter,
+			      uint64_t **ids, size_t *n_ids, char *error,
+			      size_t error_len);
+
+#endif
@@ -0,0 +1,74 @@
+/**
+ * @file slog_v29_compat.c
+ * @brief Translate a v0.2.9 struct sl_query for slog_v29_event_ids()
+ *
+ * This file sees the compatibility <servicelog-1/libservicelog.h>, as
+ * v29_servicelog.c does; slog_v29.c sees the v1 header instead.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <servicelog-1/libservicelog.h>
+
+#include "slog_v29.h"
+
+/* Convert SL_QUERY_{YES,NO,ALL} for struct slog_v29_filter */
+static int
+yna_filter(int yna)
+{
+	if (yna == SL_QUERY_YES)
+		return 1;
+	if (yna == SL_QUERY_NO)
+		return -1;
+	return 0;
+}
+
+/**
+ * slog_v29_query_filter
+ * @brief Translate a query whose filters mean the same in a native statement
+ *
+ * Queries that may return repair actions are not translated, since
+ * repair actions are not rows of the v1 events table; nor are those on
+ * "app" events, which have no v1 type, or on a severity, whose v0.2.9
+ * meaning is the compatibility library's.
+ *
+ * @param query v0.2.9 query
+ * @param filter returned native filter
+ * @return 1 if the query was translated, 0 otherwise
+ */
+int
+slog_v29_query_filter(const struct sl_query *query,
+		      struct slog_v29_filter *filter)
+{
+	uint32_t i;
+
+	if (query->is_repair_action != SL_QUERY_NO || query->severity ||
+	    query->num_types > sizeof(filter->types) / sizeof(uint32_t))
+		return 0;
+
+	memset(filter, 0, sizeof(*filter));
+	for (i = 0; i < query->num_types; i++) {
+		switch (query->event_types[i]) {
+		case SL_TYPE_OS:
+			filter->types[i] = SLOG_V29_TYPE_OS;
+			break;
+		case SL_TYPE_PPC64_RTAS:
+			filter->types[i] = SLOG_V29_TYPE_RTAS;
+			break;
+		case SL_TYPE_PPC64_ENCL:
+			filter->types[i] = SLOG_V29_TYPE_ENCLOSURE;
+			break;
+		default:
+			return 0;
+		}
+	}
+	filter->num_types = query->num_types;
+	filter->start_time = query->start_time;
+	filter->end_time = query->end_time;
+	filter->serviceable = yna_filter(query->is_serviceable);
+	filter->repaired = yna_filter(query->is_repaired);
+	return 1;
+}
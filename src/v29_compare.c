@@ -0,0 +1,342 @@
+/**
+ * @file v29_compare.c
+ * @brief Check the native v0.2.9 filters against servicelog_query()
+ *
+ * Seeds the servicelog with events of every severity, serviceable and
+ * closed state, runs a set of v0.2.9 queries both through the
+ * compatibility servicelog_query() and through slog_v29_event_ids(),
+ * and reports the queries whose events differ, or whose events print
+ * differently when read by id as v29_servicelog reads them.  The
+ * seeded events are deleted afterwards, but the queries also see the
+ * events already in the servicelog.
+ *
+ * It writes to the system servicelog, so it is only built with
+ * --with-test, and should be run as root on a test system.
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <servicelog-1/libservicelog.h>
+
+#include "slog_v29.h"
+#include "v29_compare.h"
+
+#define STEP	V29_COMPARE_STEP
+
+struct compare_case {
+	const char *name;
+	uint32_t types[SL_MAX_EVENT_TYPE];
+	uint32_t num_types;
+	uint32_t severity;
+	long start;		/* steps from the first seeded event, or 0 */
+	long end;
+	int serviceable;	/* SL_QUERY_* */
+	int repaired;
+	int repair_action;
+	int translated;		/* expected from slog_v29_query_filter() */
+};
+
+/*
+ * Times are in seconds past the first seeded event (never 0 itself,
+ * since 0 leaves a bound unset); the events are STEP seconds apart, so
+ * some bounds fall on an event and others between two.
+ */
+static const struct compare_case cases[] = {
+	{ "no filter", {0}, 0, 0, 0, 0,
+	  SL_QUERY_ALL, SL_QUERY_ALL, SL_QUERY_NO, 1 },
+	{ "start on an event", {0}, 0, 0, 5 * STEP, 0,
+	  SL_QUERY_ALL, SL_QUERY_ALL, SL_QUERY_NO, 1 },
+	{ "end on an event", {0}, 0, 0, 0, 10 * STEP,
+	  SL_QUERY_ALL, SL_QUERY_ALL, SL_QUERY_NO, 1 },
+	{ "window between events", {0}, 0, 0, 5 * STEP + STEP / 2,
+	  20 * STEP - 1, SL_QUERY_ALL, SL_QUERY_ALL, SL_QUERY_NO, 1 },
+	{ "serviceable", {0}, 0, 0, 0, 0,
+	  SL_QUERY_YES, SL_QUERY_ALL, SL_QUERY_NO, 1 },
+	{ "not serviceable", {0}, 0, 0, 0, 0,
+	  SL_QUERY_NO, SL_QUERY_ALL, SL_QUERY_NO, 1 },
+	{ "repaired", {0}, 0, 0, 0, 0,
+	  SL_QUERY_ALL, SL_QUERY_YES, SL_QUERY_NO, 1 },
+	{ "not repaired", {0}, 0, 0, 0, 0,
+	  SL_QUERY_ALL, SL_QUERY_NO, SL_QUERY_NO, 1 },
+	{ "os", { SL_TYPE_OS }, 1, 0, 0, 0,
+	  SL_QUERY_ALL, SL_QUERY_ALL, SL_QUERY_NO, 1 },
+	{ "os, rtas and enclosure",
+	  { SL_TYPE_OS, SL_TYPE_PPC64_RTAS, SL_TYPE_PPC64_ENCL }, 3, 0, 0, 0,
+	  SL_QUERY_ALL, SL_QUERY_ALL, SL_QUERY_NO, 1 },
+	{ "open serviceable since", {0}, 0, 0, 3 * STEP, 0,
+	  SL_QUERY_YES, SL_QUERY_NO, SL_QUERY_NO, 1 },
+	/* left to servicelog_query() */
+	{ "app", { SL_TYPE_APP }, 1, 0, 0, 0,
+	  SL_QUERY_ALL, SL_QUERY_ALL, SL_QUERY_NO, 0 },
+	{ "severity", {0}, 0, 4, 0, 0,
+	  SL_QUERY_ALL, SL_QUERY_ALL, SL_QUERY_NO, 0 },
+	{ "with repair actions", {0}, 0, 0, 0, 0,
+	  SL_QUERY_ALL, SL_QUERY_ALL, SL_QUERY_ALL, 0 },
+};
+
+static int
+compare_ids(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+/**
+ * query_ids
+ * @brief Run a query through the compatibility library
+ *
+ * @return 0 on success, -1 on failure
+ */
+static int
+query_ids(struct servicelog *slog, struct sl_query *query, uint64_t **ids,
+	  size_t *n_ids)
+{
+	struct sl_header *hdr;
+	size_t n = 0;
+
+	*ids = NULL;
+	*n_ids = 0;
+	if (servicelog_query(slog, query) != 0) {
+		fprintf(stderr, "servicelog_query: %s\n",
+			servicelog_error(slog));
+		return -1;
+	}
+	for (hdr = query->result; hdr; hdr = hdr->next)
+		n++;
+	*ids = malloc((n ? n : 1) * sizeof(**ids));
+	if (*ids == NULL) {
+		servicelog_query_close(slog, query);
+		return -1;
+	}
+	for (hdr = query->result; hdr; hdr = hdr->next)
+		(*ids)[(*n_ids)++] = hdr->db_key;
+	servicelog_query_close(slog, query);
+
+	qsort(*ids, *n_ids, sizeof(**ids), compare_ids);
+	return 0;
+}
+
+static int
+compare_headers(const void *a, const void *b)
+{
+	uint32_t x = (*(struct sl_header *const *)a)->db_key;
+	uint32_t y = (*(struct sl_header *const *)b)->db_key;
+
+	return (x > y) - (x < y);
+}
+
+/**
+ * compare_records
+ * @brief Check that the events read by id print as the query's do
+ *
+ * v29_servicelog prints a translated query by reading each event that
+ * the native statement found with servicelog_get_event(), in id order;
+ * both are printed here, verbosely, and compared.
+ *
+ * @return 0 if they print the same, 1 if not, -1 on failure
+ */
+static int
+compare_records(struct servicelog *slog, struct sl_query *query,
+		const uint64_t *ids, size_t n_ids)
+{
+	struct sl_header *hdr, **sorted = NULL;
+	char *old_text = NULL, *new_text = NULL;
+	size_t old_len, new_len, n = 0, i;
+	FILE *old_fp, *new_fp;
+	void *data;
+	size_t sz;
+	int rc = -1;
+
+	old_fp = open_memstream(&old_text, &old_len);
+	new_fp = open_memstream(&new_text, &new_len);
+	if (old_fp == NULL || new_fp == NULL)
+		goto out;
+
+	if (servicelog_query(slog, query) != 0) {
+		fprintf(stderr, "servicelog_query: %s\n",
+			servicelog_error(slog));
+		goto out;
+	}
+	for (hdr = query->result; hdr; hdr = hdr->next)
+		n++;
+	sorted = malloc((n ? n : 1) * sizeof(*sorted));
+	if (sorted == NULL) {
+		servicelog_query_close(slog, query);
+		goto out;
+	}
+	for (i = 0, hdr = query->result; hdr; hdr = hdr->next)
+		sorted[i++] = hdr;
+	qsort(sorted, n, sizeof(*sorted), compare_headers);
+	for (i = 0; i < n; i++)
+		servicelog_print_event(old_fp, sorted[i], 1);
+	servicelog_query_close(slog, query);
+
+	for (i = 0; i < n_ids; i++) {
+		if (servicelog_get_event(slog, ids[i], &data, &sz) != 0) {
+			fprintf(stderr, "servicelog_get_event: %s\n",
+				servicelog_error(slog));
+			goto out;
+		}
+		for (hdr = data; hdr; hdr = hdr->next)
+			servicelog_print_event(new_fp, hdr, 1);
+		free(data);
+	}
+
+	fflush(old_fp);
+	fflush(new_fp);
+	rc = old_len != new_len || memcmp(old_text, new_text, old_len);
+
+out:
+	if (old_fp)
+		fclose(old_fp);
+	if (new_fp)
+		fclose(new_fp);
+	free(old_text);
+	free(new_text);
+	free(sorted);
+	return rc;
+}
+
+static void
+print_difference(const uint64_t *a, size_t na, const uint64_t *b, size_t nb)
+{
+	size_t i = 0, j = 0;
+
+	while (i < na || j < nb) {
+		if (j == nb || (i < na && a[i] < b[j]))
+			printf("    %llu only from servicelog_query()\n",
+			       (unsigned long long)a[i++]);
+		else if (i == na || b[j] < a[i])
+			printf("    %llu only from the native statement\n",
+			       (unsigned long long)b[j++]);
+		else {
+			i++;
+			j++;
+		}
+	}
+}
+
+/**
+ * run_case
+ * @brief Run one query both ways
+ *
+ * @return 0 if the results agree, 1 if they differ, -1 on failure
+ */
+static int
+run_case(struct servicelog *slog, const struct compare_case *c, time_t base)
+{
+	struct slog_v29_filter filter;
+	struct sl_query query;
+	uint32_t types[SL_MAX_EVENT_TYPE];
+	uint64_t *old_ids, *new_ids;
+	size_t n_old, n_new;
+	char err[256];
+	int rc;
+
+	memset(&query, 0, sizeof(query));
+	memcpy(types, c->types, sizeof(types));
+	query.num_types = c->num_types;
+	query.event_types = types;
+	query.severity = c->severity;
+	query.start_time = c->start ? base + c->start : 0;
+	query.end_time = c->end ? base + c->end : 0;
+	query.is_serviceable = c->serviceable;
+	query.is_repaired = c->repaired;
+	query.is_repair_action = c->repair_action;
+
+	if (!slog_v29_query_filter(&query, &filter)) {
+		rc = c->translated;
+		printf("%s: %s: left to servicelog_query()\n",
+		       rc ? "FAIL" : "ok", c->name);
+		return rc;
+	}
+	if (!c->translated) {
+		printf("FAIL: %s: translated, but should not be\n", c->name);
+		return 1;
+	}
+
+	if (query_ids(slog, &query, &old_ids, &n_old) != 0)
+		return -1;
+	if (slog_v29_event_ids(&filter, &new_ids, &n_new, err,
+			       sizeof(err)) != 0) {
+		fprintf(stderr, "slog_v29_event_ids: %s\n", err);
+		free(old_ids);
+		return -1;
+	}
+
+	rc = n_old != n_new ||
+	     (n_old && memcmp(old_ids, new_ids, n_old * sizeof(*old_ids)));
+	if (rc == 0) {
+		rc = compare_records(slog, &query, new_ids, n_new);
+		if (rc < 0) {
+			free(old_ids);
+			free(new_ids);
+			return -1;
+		}
+		if (rc)
+			printf("FAIL: %s: the events read by id print "
+			       "differently\n", c->name);
+		else
+			printf("ok: %s: %zu events\n", c->name, n_old);
+	}
+	else {
+		printf("FAIL: %s: %zu events\n", c->name, n_old);
+		print_difference(old_ids, n_old, new_ids, n_new);
+	}
+
+	free(old_ids);
+	free(new_ids);
+	return rc;
+}
+
+int
+main(int argc, char *argv[])
+{
+	struct servicelog slog;
+	uint64_t *seeded;
+	size_t n_seeded, i;
+	time_t base;
+	char err[256];
+	int rc, failed = 0;
+
+	/* a day ago, on the hour */
+	base = time(NULL) - 24 * 60 * 60;
+	base -= base % STEP;
+
+	if (v29_compare_seed(base, &seeded, &n_seeded, err,
+			     sizeof(err)) != 0) {
+		fprintf(stderr, "%s: %s\n", argv[0], err);
+		return 2;
+	}
+
+	memset(&slog, 0, sizeof(slog));
+	if (servicelog_open(&slog, NULL, 0) != 0) {
+		fprintf(stderr, "%s: %s\n", argv[0], servicelog_error(&slog));
+		v29_compare_unseed(seeded, n_seeded);
+		free(seeded);
+		return 2;
+	}
+
+	for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		rc = run_case(&slog, &cases[i], base);
+		if (rc < 0) {
+			failed = -1;
+			break;
+		}
+		failed += rc;
+	}
+
+	servicelog_close(&slog);
+	v29_compare_unseed(seeded, n_seeded);
+	free(seeded);
+
+	if (failed < 0)
+		return 2;
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,21 @@
+/**
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code.
+ */
+
+#ifndef V29_COMPARE_H
+#define V29_COMPARE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/* Seeding of the v1 database for v29_compare; see v29_compare_seed.c */
+#define V29_COMPARE_REFCODE	"#V29CMP"
+#define V29_COMPARE_STEP	3600	/* seconds between seeded events */
+
+extern int v29_compare_seed(time_t base, uint64_t **ids, size_t *n_ids,
+			    char *error, size_t error_len);
+extern void v29_compare_unseed(const uint64_t *ids, size_t n_ids);
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @file v29_compare_seed.c
+ * @brief Log the events that v29_compare queries, through the v1 library
+ *
+ * Copyright (C) 2026 IBM Corporation
+ * See 'COPYING' for License of this code
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <servicelog-1/servicelog.h>
+
+#include "v29_compare.h"
+
+/**
+ * v29_compare_seed
+ * @brief Log one event for each severity, serviceable and closed state
+ *
+ * The events are V29_COMPARE_STEP seconds apart from base, so that time
+ * bounds can fall on and between them.
+ *
+ * @param base time_event of the first event
+ * @param ids returned ids of the events logged; free() them
+ * @param n_ids returned number of ids
+ * @param error buffer for an error message
+ * @param error_len size of error
+ * @return 0 on success, -1 on failure
+ */
+int
+v29_compare_seed(time_t base, uint64_t **ids, size_t *n_ids, char *error,
+		 size_t error_len)
+{
+	struct sl_event event;
+	servicelog *slog;
+	int sev, serviceable, closed, rc;
+
+	*n_ids = 0;
+	*ids = calloc(SL_SEV_FATAL * 4, sizeof(**ids));
+	if (*ids == NULL) {
+		snprintf(error, error_len, "Out of memory");
+		return -1;
+	}
+
+	rc = servicelog_open(&slog, 0);
+	if (rc) {
+		snprintf(error, error_len, "Error opening servicelog: %s",
+			 strerror(rc));
+		free(*ids);
+		*ids = NULL;
+		return -1;
+	}
+
+	for (sev = SL_SEV_DEBUG; sev <= SL_SEV_FATAL; sev++)
+	for (serviceable = 0; serviceable <= 1; serviceable++)
+	for (closed = 0; closed <= 1; closed++) {
+		memset(&event, 0, sizeof(event));
+		event.time_event = base + *n_ids * V29_COMPARE_STEP;
+		event.type = SL_TYPE_BASIC;
+		event.severity = sev;
+		event.serviceable = serviceable;
+		event.refcode = V29_COMPARE_REFCODE;
+		event.description = "Logged by v29_compare";
+
+		if (servicelog_event_log(slog, &event, &(*ids)[*n_ids]) != 0 ||
+		    (closed && servicelog_event_close(slog,
+						      (*ids)[*n_ids]) != 0)) {
+			snprintf(error, error_len, "%s",
+				 servicelog_error(slog));
+			servicelog_close(slog);
+			v29_compare_unseed(*ids, *n_ids + 1);
+			free(*ids);
+			*ids = NULL;
+			*n_ids = 0;
+			return -1;
+		}
+		(*n_ids)++;
+	}
+
+	servicelog_close(slog);
+	return 0;
+}
+
+/**
+ * v29_compare_unseed
+ * @brief Delete the events logged by v29_compare_seed()
+ */
+void
+v29_compare_unseed(const uint64_t *ids, size_t n_ids)
+{
+	servicelog *slog;
+	size_t i;
+
+	if (servicelog_open(&slog, SL_FLAG_ADMIN) != 0)
+		return;
+	for (i = 0; i < n_ids; i++)
+		if (ids[i])
+			servicelog_event_delete(slog, ids[i]);
+	servicelog_close(slog);
+}
@@ -11,21 +11,33 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <limits.h>
+#include <inttypes.h>
+#include <sys/time.h>
 #define _GNU_SOURCE
 #include <getopt.h>
 #include <servicelog-1/libservicelog.h>
 #include "config.h"
 #include "platform.h"
+#include "slog_budget.h"
+#include "slog_v29.h"
+#include "slog_ids.h"
 
-#define ARG_LIST	"i:t:s:e:E:S:R:r:l:hvV"
+#define ARG_LIST	"i:F:t:s:e:E:S:R:r:l:T:M:hvV"
 
 static char *cmd;
 
+static struct slog_budget budget;
+static volatile unsigned long n_printed;
+
 static uint32_t types[SL_MAX_EVENT_TYPE];
 static int type_indx = 0;
 
 static struct option long_options[] = {
 	{"id",		    required_argument,  NULL, 'i'},
+	{"ids-from",	    required_argument,  NULL, 'F'},
 	{"type",	    required_argument,  NULL, 't'},
 	{"start_time",	    required_argument,  NULL, 's'},
 	{"end_time",	    required_argument,  NULL, 'e'},
@@ -34,6 +46,8 @@ static struct option long_options[] = {
 	{"repair_action",   required_argument,  NULL, 'R'},
 	{"event_repaired",  required_argument,  NULL, 'r'},
 	{"location",        required_argument,  NULL, 'l'},
+	{"timeout",	    required_argument,  NULL, 'T'},
+	{"max-rows",	    required_argument,  NULL, 'M'},
 	{"help",	    no_argument,        NULL, 'h'},
 	{"verbose",	    no_argument,	NULL, 'v'},
 	{"Version",	    no_argument,	NULL, 'V'},
@@ -52,6 +66,9 @@ print_usage()
 	printf("Usage: %s {query_flags} {other_flags}\n", cmd);
 	printf("  Query Flags:\n");
 	printf("    --id=<id>          find servicelog event with key <id>\n");
+	printf("                       <id> may be a list, e.g., 12,15,40-49\n");
+	printf("    --ids-from=<file>  find the events whose ids are listed in\n");
+	printf("                       <file> (- for stdin)\n");
 	printf("    --type=<type>      event type(s) to query on\n");
 	printf("                       types are os, app, ppc64_rtas, ppc64_encl\n");
 	printf("                       (this option may be specified more than once)\n");
@@ -66,6 +83,9 @@ print_usage()
 	printf("    --severity=<sev>   search for events of particular sev\n");
 	printf("  Other Flags:\n");
 //	printf("    --location=<path>  servicelog location (if not default)\n");
+	printf("    --timeout=<ms>     stop if the command runs longer than\n");
+	printf("                       <ms> milliseconds\n");
+	printf("    --max-rows=<n>     stop if more than <n> events match\n");
 	printf("    --verbose | -v     verbose output\n");
 	printf("    --Version | -V     print version\n");
 	printf("    --help             print this menu and exit\n");
@@ -122,6 +142,10 @@ valid_yna_arg(const char *arg, const char *optarg)
 static int
 add_type(char *type)
 {
+	if (type_indx >= SL_MAX_EVENT_TYPE &&
+	    strncmp(type, "all", 3) != 0)
+		return 0;
+
 	if (strncmp(type, "app", 3) == 0) 
 		types[type_indx++] = SL_TYPE_APP;
 	else if (strncmp(type, "os", 2) == 0)
@@ -138,6 +162,219 @@ add_type(char *type)
 	return 1;
 }
 
+/**
+ * print_record
+ * @brief Read one event or repair action by id and print it
+ *
+ * @param slog open servicelog
+ * @param id id of the record
+ * @param verbose verbosity of servicelog_print_event()
+ * @param headers print only the header of each record if verbose is 0
+ * @return 0 on success, -1 on failure
+ */
+static int
+print_record(struct servicelog *slog, uint32_t id, int verbose, int headers)
+{
+	struct sl_header *hdr;
+	void *data;
+	size_t sz;
+
+	if (servicelog_get_event(slog, id, &data, &sz) != 0) {
+		fprintf(stderr, "%s\n", servicelog_error(slog));
+		return -1;
+	}
+
+	for (hdr = (struct sl_header *)data; hdr; hdr = hdr->next) {
+		if (headers && !verbose)
+			servicelog_print_header(stdout, hdr, 0);
+		else
+			servicelog_print_event(stdout, hdr, verbose);
+		printf("\n");
+		n_printed++;
+	}
+	free(data);
+	return 0;
+}
+
+/**
+ * print_native
+ * @brief Run a query as a native statement and print its events
+ *
+ * The statement (see slog_v29_event_ids()) takes the index on
+ * time_event and returns ids only, so --max-rows is enforced before
+ * any event is read; each event is then read by its id, since only the
+ * compatibility library can build v0.2.9 records.
+ *
+ * @param filter the query, as translated by slog_v29_query_filter()
+ * @param verbose verbosity of servicelog_print_event()
+ * @return 0 on success, 2 on failure, SLOG_EXIT_BUDGET if --max-rows
+ *	   was exceeded
+ */
+static int
+print_native(struct servicelog *slog, struct slog_v29_filter *filter,
+	     int verbose)
+{
+	uint64_t *ids;
+	size_t n_ids, i;
+	char err[256];
+	int rc = 0;
+
+	if (slog_v29_event_ids(filter, &ids, &n_ids, err, sizeof(err)) != 0) {
+		fprintf(stderr, "%s\n", err);
+		return 2;
+	}
+	if (budget.max_rows && n_ids > budget.max_rows) {
+		budget.exceeded = SLOG_BUDGET_ROWS;
+		budget.rows = budget.max_rows;
+		budget.last_id = ids[budget.max_rows - 1];
+		slog_budget_report(stderr, cmd, &budget);
+		free(ids);
+		return SLOG_EXIT_BUDGET;
+	}
+
+	for (i = 0; i < n_ids && rc == 0; i++) {
+		/* the v0.2.9 library takes 32-bit event ids */
+		if (ids[i] > UINT32_MAX) {
+			fprintf(stderr, "%s: Event %" PRIu64 " is out of "
+				"range for the v0.2.9 library\n", cmd, ids[i]);
+			rc = 2;
+		}
+		else if (print_record(slog, ids[i], verbose, 0) != 0)
+			rc = 2;
+	}
+
+	free(ids);
+	return rc;
+}
+
+/**
+ * print_query
+ * @brief Run a query and print its events
+ *
+ * A query whose filters mean the same in a native statement (see
+ * slog_v29_query_filter()) is run as one; the others, and any query
+ * on a --location, go through the compatibility servicelog_query().
+ *
+ * @param slog open servicelog
+ * @param query query to run
+ * @param native run it as a native statement, if it can be
+ * @param verbose verbosity of servicelog_print_event()
+ * @return 0 on success, 2 on failure, SLOG_EXIT_BUDGET if --max-rows
+ *	   was exceeded
+ */
+static int
+print_query(struct servicelog *slog, struct sl_query *query, int native,
+	    int verbose)
+{
+	struct slog_v29_filter filter;
+	struct sl_header *hdr;
+	int rc;
+
+	if (native && slog_v29_query_filter(query, &filter))
+		return print_native(slog, &filter, verbose);
+
+	rc = servicelog_query(slog, query);
+	if (rc != 0) {
+		fprintf(stderr, "%s\n", servicelog_error(slog));
+		return 2;
+	}
+
+	/*
+	 * The whole result has been read by now; --max-rows only keeps an
+	 * unexpectedly large result off the terminal.
+	 */
+	for (hdr = query->result; hdr != NULL; hdr = hdr->next) {
+		if (budget.max_rows && budget.rows == budget.max_rows) {
+			budget.exceeded = SLOG_BUDGET_ROWS;
+			break;
+		}
+		budget.rows++;
+		budget.last_id = hdr->db_key;
+	}
+	if (budget.exceeded) {
+		slog_budget_report(stderr, cmd, &budget);
+		servicelog_query_close(slog, query);
+		return SLOG_EXIT_BUDGET;
+	}
+
+	for (hdr = query->result; hdr != NULL; hdr = hdr->next) {
+		servicelog_print_event(stdout, hdr, verbose);
+		printf("\n");
+		n_printed++;
+	}
+
+	return 0;
+}
+
+static char *
+format_num(char *p, unsigned long n)
+{
+	char digits[24];
+	int i = 0;
+
+	do {
+		digits[i++] = '0' + n % 10;
+		n /= 10;
+	} while (n);
+	while (i)
+		*p++ = digits[--i];
+	return p;
+}
+
+/**
+ * timeout_expired
+ * @brief SIGALRM handler enforcing --timeout
+ *
+ * The compatibility library does not expose its database connection,
+ * so the query cannot be interrupted from a progress callback as in
+ * v1_servicelog.  Exiting releases the shared lock just the same; the
+ * message is built by hand because stdio is not async-signal-safe.
+ */
+static void
+timeout_expired(int sig)
+{
+	char msg[256], *p = msg;
+	size_t len;
+
+	len = strlen(cmd);
+	if (len > 64)
+		len = 64;
+	memcpy(p, cmd, len);
+	p += len;
+	p = stpcpy(p, ": Query stopped: timeout of ");
+	p = format_num(p, budget.timeout_ms);
+	p = stpcpy(p, " ms expired\n");
+	memcpy(p, cmd, len);
+	p += len;
+	p = stpcpy(p, ": ");
+	p = format_num(p, n_printed);
+	p = stpcpy(p, " events were printed\n");
+
+	/* nothing more can be done if this fails */
+	(void)!write(STDERR_FILENO, msg, p - msg);
+	_exit(SLOG_EXIT_BUDGET);
+}
+
+/**
+ * start_timeout
+ * @brief Arm the --timeout timer, if one was requested
+ */
+static void
+start_timeout(void)
+{
+	struct itimerval timer;
+
+	slog_budget_start(&budget, NULL);
+	if (!budget.timeout_ms)
+		return;
+
+	memset(&timer, 0, sizeof(timer));
+	timer.it_value.tv_sec = budget.timeout_ms / 1000;
+	timer.it_value.tv_usec = (budget.timeout_ms % 1000) * 1000;
+	signal(SIGALRM, timeout_expired);
+	setitimer(ITIMER_REAL, &timer, NULL);
+}
+
 /**
  * main
  * @brief Parse command line args and execute diagnostics
@@ -145,16 +382,19 @@ add_type(char *type)
  * @param argc the number of command-line arguments
  * @param argv array of command-line arguments
  * @return exit status: 0 for normal exit, 1 for usage error, >1 for other error
+ *	   (SLOG_EXIT_BUDGET if a --timeout or --max-rows budget was exceeded)
  */
 int
 main(int argc, char *argv[]) 
 {
 	int option_index, rc;
 	int verbose = 0;
-	uint32_t id = 0;
+	struct slog_ids ids;
+	char err[256];
+	size_t i;
+	int id = 0;
 	int other_flag = 0;
-	size_t sz;
-	void *data; 
+	uint64_t value;
 	char *location = NULL;
 	struct servicelog slog;
 	struct sl_query query;
@@ -178,6 +418,7 @@ main(int argc, char *argv[])
 		
 	memset(&slog, 0, sizeof(slog));
 	memset(&query, 0, sizeof(query));
+	memset(&ids, 0, sizeof(ids));
 
 	for (;;) {
 		option_index = 0;
@@ -188,8 +429,20 @@ main(int argc, char *argv[])
 			break;
 
 		switch (rc) {
-		case 'i':	/* event ID */
-			id = atoi(optarg);
+		case 'i':	/* event ID, or list of IDs */
+			if (slog_ids_parse(&ids, optarg, err, sizeof(err)) != 0) {
+				fprintf(stderr, "The \"%s\" argument to the id "
+					"option is not valid: %s\n", optarg, err);
+				exit(-1);
+			}
+			id = 1;
+			break;
+		case 'F':
+			if (slog_ids_read(&ids, optarg, err, sizeof(err)) != 0) {
+				fprintf(stderr, "%s\n", err);
+				exit(-1);
+			}
+			id = 1;
 			break;
 		case 't':
 			if (! add_type(optarg))
@@ -241,6 +494,24 @@ main(int argc, char *argv[])
 		case 'l':
 			location = optarg;
 			break;
+		case 'T':
+			if (slog_budget_parse(optarg, &value) != 0 ||
+			    value > LONG_MAX) {
+				fprintf(stderr, "The \"%s\" argument to the "
+					"timeout option is not valid\n", optarg);
+				print_usage();
+				exit(1);
+			}
+			budget.timeout_ms = (long)value;
+			break;
+		case 'M':
+			if (slog_budget_parse(optarg, &budget.max_rows) != 0) {
+				fprintf(stderr, "The \"%s\" argument to the "
+					"max-rows option is not valid\n", optarg);
+				print_usage();
+				exit(1);
+			}
+			break;
 		case 'v':
 			verbose++;
 			break;
@@ -263,12 +534,22 @@ main(int argc, char *argv[])
 
 	/* Command-line validation */
 	if (id && other_flag) {
-		fprintf(stderr, "The --id flag is mutually exclusive with all "
-			"other query flags.\n");
+		fprintf(stderr, "The --id and --ids-from flags are mutually "
+			"exclusive with all other query flags.\n");
 		print_usage();
 		exit(-1);
 	}
 	
+	/* the v0.2.9 library takes 32-bit event ids */
+	for (i = 0; i < ids.n; i++) {
+		if (ids.id[i] > UINT32_MAX) {
+			fprintf(stderr, "Event id %" PRIu64 " is out of range "
+				"for the servicelog\n", ids.id[i]);
+			print_usage();
+			exit(-1);
+		}
+	}
+
 	if ((! id) && (! other_flag)) {
 		fprintf(stderr, "One of the query flags must be specified to "
 			"query the servicelog.\n");
@@ -276,6 +557,8 @@ main(int argc, char *argv[])
 		exit(-1);
 	}
 
+	start_timeout();
+
 	rc = servicelog_open(&slog, location, 0);
 	if (rc != 0) {
 		fprintf(stderr, "%s\n", servicelog_error(&slog));
@@ -283,37 +566,30 @@ main(int argc, char *argv[])
 	}
 
 	if (id) {
-		/* print the specified event and/or repair action */
-		struct sl_header *hdr;
-
-		rc = servicelog_get_event(&slog, id, &data, &sz);
-		if (rc != 0) {
-			fprintf(stderr, "%s\n", servicelog_error(&slog));
-			servicelog_close(&slog);
-			return 2;
-		}
-
-		for (hdr = (struct sl_header*) data; hdr; hdr = hdr->next) {
-			if (verbose) 
-				servicelog_print_event(stdout, hdr, verbose);
-			else
-				servicelog_print_header(stdout, hdr, 0);
-			printf("\n");
+		/*
+		 * print the specified events and/or repair actions, in the
+		 * order requested.  This is one servicelog_get_event() per
+		 * id: a v0.2.9 record can only be built by the compatibility
+		 * library, which has no call for a set of ids, and resolving
+		 * the set with a native statement first (as print_native()
+		 * does for a query) would only add a statement, since every
+		 * id still has to be read on its own.  They are all read
+		 * over one open database.
+		 */
+		for (i = 0; i < ids.n; i++) {
+			if (print_record(&slog, ids.id[i], verbose, 1) != 0) {
+				servicelog_close(&slog);
+				slog_ids_free(&ids);
+				return 2;
+			}
 		}
+		slog_ids_free(&ids);
 	} 
 	else {
-		struct sl_header *hdr;
-
-		rc = servicelog_query(&slog, &query);
+		rc = print_query(&slog, &query, location == NULL, verbose);
 		if (rc != 0) {
-			fprintf(stderr, "%s\n", servicelog_error(&slog));
 			servicelog_close(&slog);
-			return 2;
-		}
-
-		for (hdr = query.result; hdr != NULL; hdr = hdr->next) {
-			servicelog_print_event(stdout, hdr, verbose);
-			printf("\n");
+			return rc;
 		}
 	}
 	
@@ -16,10 +16,13 @@
 #include <string.h>
 #include <unistd.h>
 #include <time.h>
+#include <limits.h>
 #define _GNU_SOURCE
 #include <getopt.h>
 #include <servicelog-1/servicelog.h>
 #include "platform.h"
+#include "slog_budget.h"
+#include "slog_index.h"
 
 #define ACTION_TOOMANY		-1
 #define ACTION_UNSPECIFIED	0
@@ -29,20 +32,31 @@
 #define ACTION_TRUNCATE_EVENTS	4
 #define ACTION_TRUNCATE_NOTIFY	5
 #define ACTION_CLEAN		6
+#define ACTION_INDEX		7
 
-#define ARG_LIST	"a:cst:fh"
+#define ARG_LIST	"a:cist:T:fh"
 
 #define SECONDS_IN_DAY		24 * 60 * 60
 #define SECONDS_IN_YEAR		365 * SECONDS_IN_DAY
 
+/*
+ * --status and --clean are typically run unattended from cron; bound
+ * their scans so they never hold the database lock away from rtas_errd
+ * for long.
+ */
+#define DEFAULT_TIMEOUT_MS	60000
+
 static char *cmd;
+static struct slog_budget budget = { .timeout_ms = DEFAULT_TIMEOUT_MS };
 
 static struct option long_options[] = {
 	{"status",	no_argument,		NULL, 's'},
 	{"truncate",	required_argument,	NULL, 't'},
 	{"clean",	no_argument,		NULL, 'c'},
+	{"index",	no_argument,		NULL, 'i'},
 	{"force",	no_argument,		NULL, 'f'},
 	{"age",		required_argument,	NULL, 'a'},
+	{"timeout",	required_argument,	NULL, 'T'},
 	{"help",	no_argument,		NULL, 'h'},
 	{0, 0, 0, 0}
 };
@@ -59,11 +73,39 @@ print_usage()
 	printf("  %s --truncate events   delete all events and repair actions\n", cmd);
 	printf("  %s --truncate notify   delete all notification tools\n", cmd);
 	printf("  %s --clean [--age=<# days>]\n", cmd);
-	printf("                            clean out old/repaired events\n\n");
+	printf("                            clean out old/repaired events\n");
+	printf("  %s --index             create the indexes used by queries\n\n", cmd);
 
 	printf("  Other Flags:\n");
 	printf("    --help             print this help text and exit\n");
 	printf("    --force            do not prompt the user to verify\n");
+	printf("    --timeout=<ms>     stop --status or --clean if a query runs\n");
+	printf("                       longer than <ms> milliseconds (default\n");
+	printf("                       %d, 0 for no limit)\n", DEFAULT_TIMEOUT_MS);
+}
+
+/**
+ * query_done
+ * @brief Stop the budget of a query and exit if the query failed
+ *
+ * @param slog open servicelog
+ * @param rc return code of the query
+ */
+static void
+query_done(struct servicelog *slog, int rc)
+{
+	slog_budget_stop(&budget, slog->db);
+
+	if (budget.exceeded) {
+		slog_budget_report(stderr, cmd, &budget);
+		servicelog_close(slog);
+		exit(SLOG_EXIT_BUDGET);
+	}
+	if (rc != 0) {
+		fprintf(stderr, "%s\n", servicelog_error(slog));
+		servicelog_close(slog);
+		exit(2);
+	}
 }
 
 /**
@@ -88,6 +130,7 @@ main(int argc, char *argv[])
 	char buf[124];
 	char *tmp;
 	char *next_char;
+	uint64_t value;
 	uint32_t num=0, num_repaired=0, num_unrepaired=0, num_info=0, num_ra=0;
 	uint32_t span;
 	time_t now;
@@ -160,6 +203,12 @@ main(int argc, char *argv[])
 			if (action != ACTION_TOOMANY)
 				action = ACTION_CLEAN;
 			break;
+		case 'i':
+			if (action != ACTION_UNSPECIFIED)
+				action = ACTION_TOOMANY;
+			if (action != ACTION_TOOMANY)
+				action = ACTION_INDEX;
+			break;
 		case 'a':
 			age = (int)strtoul(optarg, &next_char, 10);
 			if (optarg[0] == '\0' || *next_char != '\0' ||
@@ -171,6 +220,14 @@ main(int argc, char *argv[])
 		case 'f':
 			flag_force = 1;
 			break;
+		case 'T':
+			if (slog_budget_parse(optarg, &value) != 0 ||
+			    value > LONG_MAX) {
+				print_usage();
+				exit(1);
+			}
+			budget.timeout_ms = (long)value;
+			break;
 		case 'h':	/* help */
 			print_usage();
 			exit(0);
@@ -215,12 +272,9 @@ main(int argc, char *argv[])
 			exit(2);
 		}
 
+		slog_budget_start(&budget, slog->db);
 		rc = servicelog_event_query(slog, "", &events);
-		if (rc != 0) {
-			fprintf(stderr, "%s\n", servicelog_error(slog));
-			servicelog_close(slog);
-			exit(2);
-		}
+		query_done(slog, rc);
 
 		for (event = events; event; event = event->next) {
 			num++; // total event count
@@ -235,12 +289,9 @@ main(int argc, char *argv[])
 		servicelog_event_free(events);
 
 		// Now need to query repair actions:
+		slog_budget_start(&budget, slog->db);
 		rc = servicelog_repair_query(slog, "", &repairs);
-		if (rc != 0) {
-			fprintf(stderr, "%s\n", servicelog_error(slog));
-			servicelog_close(slog);
-			exit(2);
-		}
+		query_done(slog, rc);
 
 		for (repair = repairs; repair; repair = repair->next)
 			num_ra++;
@@ -406,12 +457,9 @@ main(int argc, char *argv[])
 		now = time(NULL);
 		span = age * SECONDS_IN_DAY;
 
+		slog_budget_start(&budget, slog->db);
 		rc = servicelog_event_query(slog, "", &events);
-		if (rc != 0) {
-			fprintf(stderr, "%s\n", servicelog_error(slog));
-			servicelog_close(slog);
-			exit(2);
-		}
+		query_done(slog, rc);
 
 		for (event = events; event; event = event->next) {
 			if (event->serviceable && event->closed) {
@@ -431,12 +479,9 @@ main(int argc, char *argv[])
 		servicelog_event_free(events);
 
 		/* Delete repair actions which are older than age */
+		slog_budget_start(&budget, slog->db);
 		rc = servicelog_repair_query(slog, "", &repairs);
-		if (rc != 0) {
-			fprintf(stderr, "%s\n", servicelog_error(slog));
-			servicelog_close(slog);
-			exit(2);
-		}
+		query_done(slog, rc);
 		for (repair = repairs; repair; repair = repair->next) {
 			if ((repair->time_logged + span) < now ) {
 				num_ra++;
@@ -455,6 +500,24 @@ main(int argc, char *argv[])
 		printf("Removed %u other events older than one year.\n", num);
 		break;
 
+	case ACTION_INDEX:
+		rc = servicelog_open(&slog, 0);
+		if (rc != 0) {
+			fprintf(stderr, "%s: Could not open servicelog "
+					"database.\n%s\n",
+					argv[0], servicelog_error(slog));
+			exit(2);
+		}
+
+		if (slog_index_ensure(slog, buf, sizeof(buf)) != 0) {
+			fprintf(stderr, "%s: Could not create the indexes: "
+				"%s\n", argv[0], buf);
+			servicelog_close(slog);
+			exit(2);
+		}
+		servicelog_close(slog);
+		break;
+
 	default:
 		fprintf(stderr, "Internal error; unknown action %d\n", action);
 		exit(3);